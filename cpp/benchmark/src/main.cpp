@@ -0,0 +1,167 @@
+#include <vip/vip.hpp>
+#include <vip/jit/components/InternalFunction.hpp>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+struct Benchmark
+{
+    const char *name;
+    /// @brief code run once before timing starts.
+    std::string setup;
+    /// @brief code that is timed.
+    std::string code;
+};
+
+jit::Value discard(jit::Arguments)
+{
+    return jit::Value();
+}
+
+struct Measurement
+{
+    /// @brief best time in milliseconds.
+    double ms = 0;
+    /// @brief most memory the runtime had allocated at once, in kilobytes, see JustInTime::getMemoryStats.
+    double peak = 0;
+};
+
+/// @brief run a benchmark on a fresh runtime per repeat, so the peak is of this benchmark alone.
+Measurement measure(const Benchmark &benchmark, vip::Engine engine, int repeat)
+{
+    Measurement best;
+    for (int i = 0; i < repeat; i++)
+    {
+        auto jit = vip::JustInTime(false, engine);
+        jit.registerFn("println", discard);
+        jit.registerFn("plus", {{jit::consts::ID_NUMBER, jit::consts::ID_NUMBER}}, [](jit::Arguments args)
+                       { return jit::Value(args[0].asNumber() + args[1].asNumber()); });
+        jit.registerFn("times", [](double lhs, double rhs)
+                       { return lhs * rhs; });
+        if (!benchmark.setup.empty())
+            jit.execute(benchmark.setup);
+
+        auto start = std::chrono::steady_clock::now();
+        jit.execute(benchmark.code);
+        auto end = std::chrono::steady_clock::now();
+
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        if (i == 0 || ms < best.ms)
+            best.ms = ms;
+        best.peak = std::max(best.peak, jit.getMemoryStats().peak / 1024.0);
+    }
+    return best;
+}
+
+/// @brief a loop that runs body 50000 times, compare against "node: loop" for the cost of the nodes in body.
+Benchmark node(const char *name, std::string setup, std::string body)
+{
+    return {name, setup, "let i: number = 0; while (i < 50000) { " + body + " i = i + 1; }"};
+}
+
+/// @brief a function that routes on 16 codes, as an if else chain or as a match statement.
+std::string router(bool match)
+{
+    std::string body;
+    for (int i = 0; i < 16; i++)
+    {
+        auto code = std::to_string(i * 3);
+        if (match)
+            body += "case " + code + " { return " + code + "; } ";
+        else
+            body += (i == 0 ? "if (c == " : "else if (c == ") + code + ") { return " + code + "; } ";
+    }
+    if (match)
+        return "fn route(c: number) { match (c) { " + body + "} return 0; }";
+    return "fn route(c: number) { " + body + "return 0; }";
+}
+
+std::vector<Benchmark> benchmarks()
+{
+    return {
+        node("node: loop", "", ""),
+        node("node: literal", "", "1; 2; 3; 4;"),
+        node("node: identifier", "", "i; i; i; i;"),
+        node("node: binary", "", "i * 2; i * 2; i * 2; i * 2;"),
+        node("node: let", "", "let a: number = i; let b: number = i;"),
+        // a site that saw the shape before reads the slot directly, compare against "node: identifier".
+        node("node: field", "struct P { x: number, y: number } let p: P = P(1, 2);", "p.y; p.y; p.y; p.y;"),
+        node("node: if", "", "if (i < 0) { } if (i < 0) { } else { }"),
+        // string params keep the callee out of the interpreter's native tier.
+        node("node: call", "fn same(s: string) { return s; }", "same(\"x\"); same(\"x\");"),
+        // arguments are read where they were evaluated, compare against "node: call".
+        node("node: host call", "", "plus(i, 1); plus(i, 1);"),
+        // unpacked from the C++ signature, this should cost the same as the hand written one.
+        node("node: bound host call", "", "times(i, 2); times(i, 2);"),
+        // evaluated where they are called, compare against "node: host call".
+        node("node: intrinsic", "", "sqrt(i); abs(i); floor(i); min(i, 7);"),
+        node("node: string intrinsic", "let s: string = \"intrinsic\";", "len(s); charAt(s, 3); substr(s, 2, 4);"),
+        node("op: +", "", "i + 1; i + 1; i + 1; i + 1;"),
+        node("op: /", "", "i / 3; i / 3; i / 3; i / 3;"),
+        node("op: <", "", "i < 7; i < 7; i < 7; i < 7;"),
+        node("op: ==", "", "i == 7; i == 7; i == 7; i == 7;"),
+        node("op: !=", "", "i != 7; i != 7; i != 7; i != 7;"),
+        node("op: &&", "", "i && 1; i && 1; i && 1; i && 1;"),
+        // the rhs call is skipped, so this should cost about as much as a literal.
+        node("op: && short circuit", "fn slow(s: string) { return 1; }", "0 && slow(\"x\"); 0 && slow(\"x\");"),
+        node("op: string +", "let s: string = \"ab\";", "s + s; s + s; s + s; s + s;"),
+        node("op: string ==", "let s: string = \"abc\";", "s == \"abd\"; s == \"abd\"; s == \"abd\"; s == \"abd\";"),
+        node("op: string <", "let s: string = \"abc\";", "s < \"abd\"; s < \"abd\"; s < \"abd\"; s < \"abd\";"),
+        // numbers are held inline, so arithmetic in a loop allocates nothing.
+        {"arithmetic loop", "", "let s: number = 0; let i: number = 0; while (i < 200000) { s = s + i * 2 - 1; i = i + 1; }"},
+        // integers stay exact and inline, the mask keeps the hash under 48 bits.
+        {"integer hashing", "", "let h: number = 0; for i in 0..200000 { h = h * 31 + i & 16777215 ^ i % 7; }"},
+        {"count", "", "let idx: number = 0; while (idx < 200000) { println(\"Index\", idx); idx = idx + 1; }"},
+        {"recursive calls", "fn fib(n: number) { if (n < 2) { return n; } return fib(n - 1) + fib(n - 2); }", "fib(22);"},
+        // string params keep this one out of the interpreter's native tier.
+        {"recursive calls, boxed", "fn depth(n: number, tag: string) { if (n < 1) { return tag; } return depth(n - 1, tag); }", "let i: number = 0; while (i < 200) { depth(100, \"x\"); i = i + 1; }"},
+        // constant memory: the peak columns should stay small however many calls these make.
+        {"tail calls, 10^7", "fn loop(n: number, acc: number) { if (n < 1) { return acc; } return loop(n - 1, acc + 1); }", "loop(10000000, 0);"},
+        {"tail calls, boxed 10^6", "fn loop(n: number, tag: string) { if (n < 1) { return tag; } return loop(n - 1, tag); }", "loop(1000000, \"x\");"},
+        // every iteration enters a loop body, an if and a call, none of which may keep memory.
+        {"long running loop", "fn step(s: string) { if (s == \"x\") { let t: string = s; return t; } return s; }", "let i: number = 0; while (i < 1000000) { if (i > 0) { step(\"x\"); } i = i + 1; }"},
+        // the last code is the worst case for the chain, the match should not care.
+        node("dispatch: if chain", router(false), "route(45); route(45);"),
+        node("dispatch: match", router(true), "route(45); route(45);"),
+        {"counting loop, while", "", "let s: number = 0; let i: number = 0; while (i < 1000000) { s = s + i; i = i + 1; }"},
+        {"counting loop, for", "", "let s: number = 0; for i in 0..1000000 { s = s + i; }"},
+        {"counting loop, native", "fn sum(n: number) { let s: number = 0; for i in 0..n { s = s + i; } return s; }", "let k: number = 0; while (k < 1000) { sum(1000); k = k + 1; }"},
+        // the builtins run a vector kernel over the buffer, compare against walking it by index.
+        {"array sum, loop", "let a: number[] = array(100000, 1);", "let s: number = 0; for i in 0..100000 { s = s + a[i]; }"},
+        {"array sum, builtin", "let a: number[] = array(100000, 1);", "let s: number = 0; for i in 0..100 { s = s + sum(a); }"},
+        {"array dot, builtin", "let a: number[] = array(100000, 1); let b: number[] = array(100000, 2);", "let s: number = 0; for i in 0..100 { s = s + dot(a, b); }"},
+        // a lookup table held by the script, every read probes one group of control bytes.
+        {"map lookup", "let m: map = map(1000); for i in 0..1000 { m[i] = i * 2; }", "let s: number = 0; for j in 0..100 { for i in 0..1000 { s = s + m[i]; } }"},
+        {"map lookup, string keys", "let m: map = map(); m[\"alpha\"] = 1; m[\"beta\"] = 2; let k: string = \"beta\";", "let s: number = 0; for i in 0..100000 { s = s + m[k]; }"},
+        {"string building", "", "let s: string = \"\"; let i: number = 0; while (i < 20000) { s = s + \"x\"; i = i + 1; }"},
+        // concatenation builds a rope, so this should grow linearly too, flattening once at the end.
+        {"report building, 10x", "", "let s: string = \"\"; let i: number = 0; while (i < 200000) { s = s + \"x\"; i = i + 1; } s == \"\";"},
+        // appends in place, so this should grow linearly with the length.
+        {"string building, +=", "", "let s: string = \"\"; for i in 0..20000 { s += \"x\"; }"},
+        {"string building, +=, 10x", "", "let s: string = \"\"; for i in 0..200000 { s += \"x\"; }"},
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    // VipBenchmark [filter] runs every benchmark whose name contains filter.
+    const char *filter = argc > 1 ? argv[1] : "";
+    const int repeat = 5;
+
+    std::printf("%-24s %14s %14s %14s %14s\n", "benchmark", "interpreter", "closure", "peak, interp.", "peak, closure");
+    for (auto &&benchmark : benchmarks())
+    {
+        if (std::strstr(benchmark.name, filter) == nullptr)
+            continue;
+
+        auto interpreter = measure(benchmark, vip::ENGINE_INTERPRETER, repeat);
+        auto closure = measure(benchmark, vip::ENGINE_CLOSURE, repeat);
+        std::printf("%-24s %11.3f ms %11.3f ms %11.1f KB %11.1f KB\n", benchmark.name, interpreter.ms, closure.ms, interpreter.peak, closure.peak);
+    }
+
+    return 0;
+}
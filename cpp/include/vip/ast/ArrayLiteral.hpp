@@ -0,0 +1,21 @@
+#pragma once
+#include <vector>
+#include "./Consts.hpp"
+#include "./Node.hpp"
+
+namespace ast
+{
+    /// @brief `[1, 2, 3]`, a number array with the values of its elements.
+    class ArrayLiteral : public Node
+    {
+    private:
+        std::vector<Node *> elements;
+
+    public:
+        static constexpr unsigned int KIND = consts::ARRAY_LITERAL;
+        ArrayLiteral(std::vector<Node *> elements) : Node(0, 0, KIND), elements(std::move(elements)) {}
+        ~ArrayLiteral();
+        inline std::vector<Node *> &getElements() { return elements; }
+        std::string toString(int padding = 0) override;
+    };
+} // namespace ast
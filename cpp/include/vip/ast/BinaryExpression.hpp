@@ -12,7 +12,8 @@ namespace ast
         Node *rhs;
 
     public:
-        BinaryExpression(unsigned int op, Node *lhs, Node *rhs) : Node(0, 0, consts::BINARY_EXPRESSION), op(op), lhs(std::move(lhs)), rhs(std::move(rhs)) {}
+        static constexpr unsigned int KIND = consts::BINARY_EXPRESSION;
+        BinaryExpression(unsigned int op, Node *lhs, Node *rhs) : Node(0, 0, KIND), op(op), lhs(std::move(lhs)), rhs(std::move(rhs)) {}
         ~BinaryExpression();
         inline Node *getLhs() { return lhs; }
         inline Node *getRhs() { return rhs; }
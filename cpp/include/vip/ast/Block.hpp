@@ -13,7 +13,8 @@ namespace ast
         std::vector<Node *> statements;
 
     public:
-        Block(std::vector<Node *> statements) : Node(0, 0, consts::BLOCK_EXPRESSION), statements(std::move(statements)) {}
+        static constexpr unsigned int KIND = consts::BLOCK_EXPRESSION;
+        Block(std::vector<Node *> statements) : Node(0, 0, KIND), statements(std::move(statements)) {}
         ~Block();
         std::string toString(int padding = 0) override;
         std::vector<Node *> &getStatements() { return statements; }
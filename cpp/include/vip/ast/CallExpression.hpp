@@ -10,12 +10,21 @@ namespace ast
     private:
         Node *expression;
         std::vector<Node *> arguments;
+        unsigned int intrinsic = consts::INTRINSIC_NONE;
+        unsigned long unboundAt = 0;
 
     public:
-        CallExpression(Node *expression, std::vector<Node *> arguments) : Node(0, 0, consts::CALL_EXPRESSION), expression(expression), arguments(arguments) {}
+        static constexpr unsigned int KIND = consts::CALL_EXPRESSION;
+        CallExpression(Node *expression, std::vector<Node *> arguments) : Node(0, 0, KIND), expression(expression), arguments(arguments) {}
         ~CallExpression();
         inline Node *getExpression() { return expression; }
         inline std::vector<Node *> &getArguments() { return arguments; }
+        /// @brief the builtin the parser found this calls, consts::INTRINSIC_NONE if it calls
+        /// something else or the program declares a name it could call instead.
+        inline unsigned int getIntrinsic() const { return intrinsic; }
+        inline void setIntrinsic(unsigned int id) { intrinsic = id; }
+        /// @brief root context version the callee name was last found unbound at, filled in by the runtime.
+        inline unsigned long &getUnboundAt() { return unboundAt; }
         std::string toString(int padding = 0) override;
     };
 } // namespace ast
@@ -4,22 +4,34 @@ namespace ast
 {
     namespace consts
     {
+        /// @brief value of a two char operator, unlike a sum of the chars it can not collide with another operator.
+        constexpr unsigned int pair(char first, char second) { return (unsigned int)first << 8 | (unsigned int)second; }
+
         const unsigned int NOT = '!';
         const unsigned int EQUAL = '=';
         const unsigned int MINUS = '-';
         const unsigned int PLUS = '+';
         const unsigned int DIV = '/';
         const unsigned int MULT = '*';
-        const unsigned int AND = '&' + '&';
-        const unsigned int OR = '|' + '|';
+        const unsigned int MOD = '%';
+        const unsigned int BIT_AND = '&';
+        const unsigned int BIT_OR = '|';
+        const unsigned int BIT_XOR = '^';
+        const unsigned int SHIFT_LEFT = pair('<', '<');
+        const unsigned int SHIFT_RIGHT = pair('>', '>');
+        const unsigned int AND = pair('&', '&');
+        const unsigned int OR = pair('|', '|');
         const unsigned int LESS_THEN = '<';
         const unsigned int GREATER_THEN = '>';
-        const unsigned int LESS_THEN_OR_EQUAL = LESS_THEN + '=';
-        const unsigned int GREATER_THEN_OR_EQUAL = GREATER_THEN + '=';
-        const unsigned int EQUAL_EQUAL = EQUAL + EQUAL;
-        const unsigned int NOT_EQUAL = NOT + EQUAL;
-        const unsigned int SET_MINUS = MINUS + EQUAL;
-        const unsigned int SET_PLUS = PLUS + EQUAL;
+        const unsigned int LESS_THEN_OR_EQUAL = pair('<', '=');
+        const unsigned int GREATER_THEN_OR_EQUAL = pair('>', '=');
+        const unsigned int EQUAL_EQUAL = pair('=', '=');
+        const unsigned int NOT_EQUAL = pair('!', '=');
+        const unsigned int SET_MINUS = pair('-', '=');
+        const unsigned int SET_PLUS = pair('+', '=');
+        const unsigned int SET_MULT = pair('*', '=');
+        const unsigned int SET_DIV = pair('/', '=');
+        const unsigned int RANGE = pair('.', '.');
 
         const unsigned int BINARY_EXPRESSION = 1;
         const unsigned int BLOCK_EXPRESSION = 2;
@@ -35,6 +47,26 @@ namespace ast
         const unsigned int STRING_LITERAL = 12;
         const unsigned int PARAMETER_EXRESSION = 13;
         const unsigned int WHILE_EXRESSION = 14;
+        const unsigned int MATCH_STATEMENT = 15;
+        const unsigned int FOR_STATEMENT = 16;
+        const unsigned int STRUCT_DECLARATION = 17;
+        const unsigned int MEMBER_EXPRESSION = 18;
+        const unsigned int INDEX_EXPRESSION = 19;
+        const unsigned int ARRAY_LITERAL = 20;
+        /// @brief one past the largest node kind, the size of tables indexed by kind.
+        const unsigned int NODE_KIND_COUNT = 21;
+
+        /// @brief builtins a call can be evaluated as inline while no binding has their name, see
+        /// CallExpression::getIntrinsic.
+        const unsigned int INTRINSIC_NONE = 0;
+        const unsigned int INTRINSIC_SQRT = 1;
+        const unsigned int INTRINSIC_ABS = 2;
+        const unsigned int INTRINSIC_FLOOR = 3;
+        const unsigned int INTRINSIC_MIN = 4;
+        const unsigned int INTRINSIC_MAX = 5;
+        const unsigned int INTRINSIC_LEN = 6;
+        const unsigned int INTRINSIC_SUBSTR = 7;
+        const unsigned int INTRINSIC_CHAR_AT = 8;
 
     } // namespace consts
 
@@ -11,7 +11,8 @@ namespace ast
         Node *expression;
 
     public:
-        ExpressionStatement(Node *expression) : Node(0, 0, consts::EXPRESSION_STATEMENT), expression(std::move(expression)) {}
+        static constexpr unsigned int KIND = consts::EXPRESSION_STATEMENT;
+        ExpressionStatement(Node *expression) : Node(0, 0, KIND), expression(std::move(expression)) {}
         ~ExpressionStatement();
         Node *getExpression() { return expression; }
         std::string toString(int padding = 0) override;
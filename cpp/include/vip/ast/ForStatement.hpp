@@ -0,0 +1,32 @@
+#pragma once
+#include "./Identifier.hpp"
+#include "./Consts.hpp"
+#include "./Node.hpp"
+#include "Block.hpp"
+
+namespace ast
+{
+    /// @brief `for i in from..to step s { }`, counts from `from` up to but not including `to`,
+    /// or down to it when the step is negative. The bounds and step are evaluated once.
+    class ForStatement : public Node
+    {
+    private:
+        Identifier *name;
+        Node *from;
+        Node *to;
+        Node *step;
+        Block *body;
+
+    public:
+        static constexpr unsigned int KIND = consts::FOR_STATEMENT;
+        ForStatement(Identifier *name, Node *from, Node *to, Node *step, Block *body) : Node(0, 0, KIND), name(name), from(from), to(to), step(step), body(body) {}
+        ~ForStatement();
+        inline Identifier *getName() { return name; }
+        inline Node *getFrom() { return from; }
+        inline Node *getTo() { return to; }
+        /// @brief may be nullptr, the step is 1 then.
+        inline Node *getStep() { return step; }
+        inline Block *getBody() { return body; }
+        std::string toString(int padding = 0) override;
+    };
+} // namespace ast
@@ -16,7 +16,8 @@ namespace ast
         Block *body;
 
     public:
-        FunctionDeclartion(Identifier *name, std::vector<Parameter *> parameters, Block *body) : Node(0, 0, consts::FUNCTION_EXPRESSION), name(std::move(name)), parameters(std::move(parameters)), body(std::move(body)) {}
+        static constexpr unsigned int KIND = consts::FUNCTION_EXPRESSION;
+        FunctionDeclartion(Identifier *name, std::vector<Parameter *> parameters, Block *body) : Node(0, 0, KIND), name(std::move(name)), parameters(std::move(parameters)), body(std::move(body)) {}
         ~FunctionDeclartion();
         inline std::vector<Parameter *> getParameters() { return parameters; }
         inline void setBody(Block *body) { this->body = body; }
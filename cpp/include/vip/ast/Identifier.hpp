@@ -2,16 +2,32 @@
 #include "./Consts.hpp"
 #include "./Node.hpp"
 
+namespace jit
+{
+    class Value;
+}
+
 namespace ast
 {
+    /// @brief root slot an identifier resolved to, filled in by the runtime.
+    struct Binding
+    {
+        /// @brief root context version the slot was found at, 0 if nothing is cached.
+        unsigned long version = 0;
+        jit::Value *slot = nullptr;
+    };
+
     class Identifier : public Node
     {
     private:
         std::string value;
+        Binding binding;
 
     public:
-        Identifier(std::string value) : Node(0, 0, consts::IDENTIFIER), value(value) {}
+        static constexpr unsigned int KIND = consts::IDENTIFIER;
+        Identifier(std::string value) : Node(0, 0, KIND), value(value) {}
         std::string toString(int padding = 0) override;
         std::string &getValue() { return value; }
+        inline Binding &getBinding() { return binding; }
     };
 }
\ No newline at end of file
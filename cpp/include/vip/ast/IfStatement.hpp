@@ -13,7 +13,8 @@ namespace ast
         Node *elseStatement;
 
     public:
-        IfStatement(Node *expression, Block *thenStatement, Node *elseStatement) : Node(0, 0, consts::IF_STATEMENT), expression(expression), thenStatement(thenStatement), elseStatement(elseStatement) {}
+        static constexpr unsigned int KIND = consts::IF_STATEMENT;
+        IfStatement(Node *expression, Block *thenStatement, Node *elseStatement) : Node(0, 0, KIND), expression(expression), thenStatement(thenStatement), elseStatement(elseStatement) {}
         ~IfStatement();
         inline Node *getExpression() const { return expression; }
         inline Block *getThen() const { return thenStatement; }
@@ -0,0 +1,22 @@
+#pragma once
+#include "./Consts.hpp"
+#include "./Node.hpp"
+
+namespace ast
+{
+    /// @brief `object[index]`, reading or assigning an element of an array.
+    class IndexExpression : public Node
+    {
+    private:
+        Node *object;
+        Node *index;
+
+    public:
+        static constexpr unsigned int KIND = consts::INDEX_EXPRESSION;
+        IndexExpression(Node *object, Node *index) : Node(0, 0, KIND), object(object), index(index) {}
+        ~IndexExpression();
+        inline Node *getObject() { return object; }
+        inline Node *getIndex() { return index; }
+        std::string toString(int padding = 0) override;
+    };
+} // namespace ast
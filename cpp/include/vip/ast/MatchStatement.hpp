@@ -0,0 +1,74 @@
+#pragma once
+#include <unordered_map>
+#include <memory>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "./Consts.hpp"
+#include "./Block.hpp"
+#include "./Node.hpp"
+
+namespace ast
+{
+    /// @brief index of the case every value of a match statement selects, built once when it is parsed.
+    ///
+    /// Integer cases that cover at least half of their range are looked up in an array,
+    /// anything else in a hash map, so picking a case costs the same for any number of cases.
+    class CaseTable
+    {
+    private:
+        std::vector<int> dense;
+        double base = 0;
+        std::unordered_map<double, int> numbers;
+        /// @brief hash given to find, which callers may have computed already.
+        struct Prehashed
+        {
+            inline std::size_t operator()(std::size_t hash) const { return hash; }
+        };
+        /// @brief string cases by their std::hash<std::string_view>.
+        std::unordered_map<std::size_t, std::vector<std::pair<std::string, int>>, Prehashed> strings;
+
+    public:
+        /// @brief returned by find when no case has the value.
+        static constexpr int NO_CASE = -1;
+        /// @brief add a case value.
+        /// @return false if the value already has a case.
+        bool add(double value, int index);
+        bool add(const std::string &value, int index);
+        /// @brief move integer cases into an array if they are dense enough, call after the last add.
+        void seal();
+        int find(double value) const;
+        int find(const std::string &value) const;
+        /// @param hash std::hash<std::string_view> of value, like a jit::String caches it.
+        int find(std::string_view value, std::size_t hash) const;
+        /// @brief are the number cases in an array, base is the value of its first element.
+        inline bool isDense() const { return !dense.empty(); }
+        inline double getBase() const { return base; }
+    };
+
+    class MatchStatement : public Node
+    {
+    private:
+        Node *expression;
+        /// @brief literal value of each case.
+        std::vector<Node *> values;
+        std::vector<Block *> bodies;
+        Block *otherwise;
+        std::shared_ptr<const CaseTable> table;
+
+    public:
+        static constexpr unsigned int KIND = consts::MATCH_STATEMENT;
+        /// @throws std::logic_error if two cases have the same value.
+        MatchStatement(Node *expression, std::vector<Node *> values, std::vector<Block *> bodies, Block *otherwise);
+        ~MatchStatement();
+        inline Node *getExpression() const { return expression; }
+        inline std::vector<Node *> &getValues() { return values; }
+        inline std::vector<Block *> &getBodies() { return bodies; }
+        /// @brief block run when no case matches, may be nullptr.
+        inline Block *getElse() const { return otherwise; }
+        /// @brief shared so lowered code can keep it after the ast is gone.
+        inline const std::shared_ptr<const CaseTable> &getTable() const { return table; }
+        std::string toString(int padding = 0) override;
+    };
+} // namespace ast
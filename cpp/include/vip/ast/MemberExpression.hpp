@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include "./Consts.hpp"
+#include "./Node.hpp"
+
+namespace ast
+{
+    /// @brief slot a member expression found its field at, filled in by the runtime.
+    struct FieldCache
+    {
+        /// @brief id of the shape the slot belongs to, 0 if nothing is cached.
+        unsigned long shape = 0;
+        std::size_t slot = 0;
+    };
+
+    /// @brief `object.field`, reading or assigning a field of a record.
+    class MemberExpression : public Node
+    {
+    private:
+        Node *object;
+        std::string field;
+        FieldCache cache;
+
+    public:
+        static constexpr unsigned int KIND = consts::MEMBER_EXPRESSION;
+        MemberExpression(Node *object, std::string field) : Node(0, 0, KIND), object(object), field(std::move(field)) {}
+        ~MemberExpression();
+        inline Node *getObject() { return object; }
+        inline std::string &getField() { return field; }
+        inline FieldCache &getCache() { return cache; }
+        std::string toString(int padding = 0) override;
+    };
+} // namespace ast
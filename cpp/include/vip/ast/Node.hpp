@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include "../jit/Memory.hpp"
 
 namespace ast
 {
@@ -14,6 +15,9 @@ namespace ast
     public:
         Node(unsigned int start, unsigned int end, unsigned int kind) : start(start), end(end), kind(kind) {}
         virtual ~Node() = default;
+        /// @brief nodes are charged to the memory of the runtime that parses them, see jit::Memory.
+        static void *operator new(std::size_t size) { return jit::Memory::allocate(size); }
+        static void operator delete(void *pointer) { jit::Memory::deallocate(pointer); }
         /// @brief Get starting position of node from source
         /// @return
         inline unsigned int getStart() { return start; }
@@ -29,4 +33,14 @@ namespace ast
         virtual std::string toString(int padding = 0);
     };
 
+    /// @brief Cast a node to T after checking its kind, so no rtti is needed.
+    /// @return the node or nullptr if it is not a T.
+    template <typename T>
+    inline T *cast(Node *node)
+    {
+        if (node == nullptr || node->getKind() != T::KIND)
+            return nullptr;
+        return static_cast<T *>(node);
+    }
+
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include "./Consts.hpp"
 #include "./Node.hpp"
 
@@ -9,10 +10,18 @@ namespace ast
     {
     private:
         double value;
+        int64_t integer;
+        bool exact;
 
     public:
-        NumericLiteral(double value) : Node(0, 0, consts::NUMBERIC_LITERAL), value(value) {}
+        static constexpr unsigned int KIND = consts::NUMBERIC_LITERAL;
+        NumericLiteral(double value) : Node(0, 0, KIND), value(value), integer(0), exact(false) {}
+        NumericLiteral(int64_t value) : Node(0, 0, KIND), value((double)value), integer(value), exact(true) {}
+        /// @brief the value as a double, rounded for integers above 2^53.
         double getValue() { return value; }
+        /// @brief was the literal written without a dot and does it fit 64 bits.
+        inline bool isInteger() const { return exact; }
+        inline int64_t getInteger() const { return integer; }
         std::string toString(int padding = 0) override;
     };
-}
\ No newline at end of file
+}
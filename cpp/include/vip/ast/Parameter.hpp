@@ -14,7 +14,8 @@ namespace ast
         Node *initializer;
 
     public:
-        Parameter(Identifier *name, Node *type) : Node(0, 0, consts::PARAMETER_EXRESSION), name(std::move(name)), type(std::move(type)), initializer(nullptr) {}
+        static constexpr unsigned int KIND = consts::PARAMETER_EXRESSION;
+        Parameter(Identifier *name, Node *type) : Node(0, 0, KIND), name(std::move(name)), type(std::move(type)), initializer(nullptr) {}
         ~Parameter();
         inline Identifier *getName() const { return name; }
         inline Node *getType() const { return type; }
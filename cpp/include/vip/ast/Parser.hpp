@@ -1,9 +1,17 @@
 #pragma once
 #include <deque>
+#include <string>
+#include <unordered_set>
+#include <vector>
 #include "./FunctionDeclaration.hpp"
 #include "./VariableStatement.hpp"
 #include "../tokenizer/Token.hpp"
+#include "./StructDeclaration.hpp"
+#include "./MatchStatement.hpp"
+#include "./ForStatement.hpp"
 #include "./IfStatement.hpp"
+#include "./Identifier.hpp"
+#include "./CallExpression.hpp"
 #include "./Program.hpp"
 
 namespace ast
@@ -13,6 +21,10 @@ namespace ast
     private:
         std::deque<tokenizer::Token> *tokens;
         tokenizer::Token current;
+        /// @brief calls to intrinsics, they call a builtin unless the program declares the name.
+        std::vector<CallExpression *> intrinsics;
+        /// @brief every name the program declares, in any scope.
+        std::unordered_set<std::string> declared;
         /// @brief pops the first item in the deque and assigns it to the current prop.
         void consume();
         /// @brief Check if the next otken will be of the given type.
@@ -62,6 +74,12 @@ namespace ast
         /// @brief parse values literials and identifers
         /// @return pointer to statement
         Node *ParseStatement();
+        /// @brief parse the name of a type, `number` or an array of it like `number[]`.
+        /// @return type, nullptr if there is no identifier
+        Identifier *ParseType();
+        /// @brief parse a literal, identifer, call, member or index expression.
+        /// @return pointer to expression
+        Node *ParseOperand();
         /// @brief parse a binary expression
         /// @param experPrec the precedence of previous expression.
         /// @param lhs expression
@@ -79,6 +97,15 @@ namespace ast
         /// @brief parses a if statement.
         /// @return if statement
         IfStatement *ParseIfStatement();
+        /// @brief parses a match statement.
+        /// @return match statement
+        MatchStatement *ParseMatchStatement();
+        /// @brief parses a counted for loop.
+        /// @return for statement
+        ForStatement *ParseForStatement();
+        /// @brief parses a struct declaration.
+        /// @return struct declaration
+        StructDeclaration *ParseStructDeclaration();
 
     public:
         Parser(std::deque<tokenizer::Token> *tokens);
@@ -10,7 +10,8 @@ namespace ast
         Node *expression;
 
     public:
-        ReturnStatement(Node *expression) : Node(0, 0, consts::RETURN_STATEMENT), expression(expression) {}
+        static constexpr unsigned int KIND = consts::RETURN_STATEMENT;
+        ReturnStatement(Node *expression) : Node(0, 0, KIND), expression(expression) {}
         ~ReturnStatement() { delete expression; }
         Node *getExpression() { return expression; }
         std::string toString(int padding = 0) override
@@ -10,7 +10,8 @@ namespace ast
         std::string value;
 
     public:
-        StringLiteral(std::string value) : Node(0, 0, consts::STRING_LITERAL), value(value) {}
+        static constexpr unsigned int KIND = consts::STRING_LITERAL;
+        StringLiteral(std::string value) : Node(0, 0, KIND), value(value) {}
         std::string toString(int padding = 0) override
         {
             return std::string("<StringLiteral value=\"" + value + "\"/>\n").insert(0, padding, ' ');
@@ -0,0 +1,25 @@
+#pragma once
+#include <vector>
+#include "./Identifier.hpp"
+#include "./Parameter.hpp"
+#include "./Consts.hpp"
+#include "./Node.hpp"
+
+namespace ast
+{
+    /// @brief `struct Name { field: type, ... }`, the fields are laid out in the order they are declared.
+    class StructDeclaration : public Node
+    {
+    private:
+        Identifier *name;
+        std::vector<Parameter *> fields;
+
+    public:
+        static constexpr unsigned int KIND = consts::STRUCT_DECLARATION;
+        StructDeclaration(Identifier *name, std::vector<Parameter *> fields) : Node(0, 0, KIND), name(name), fields(std::move(fields)) {}
+        ~StructDeclaration();
+        inline std::string &getName() { return name->getValue(); }
+        inline std::vector<Parameter *> &getFields() { return fields; }
+        std::string toString(int padding = 0) override;
+    };
+} // namespace ast
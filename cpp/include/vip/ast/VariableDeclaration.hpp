@@ -13,7 +13,8 @@ namespace ast
         Node *initializer;
 
     public:
-        VariableDeclaration(Identifier *name, Identifier *type, Node *initializer) : Node(0, 0, consts::VARIABLE_DECLARATION), name(name), type(type), initializer(initializer) {}
+        static constexpr unsigned int KIND = consts::VARIABLE_DECLARATION;
+        VariableDeclaration(Identifier *name, Identifier *type, Node *initializer) : Node(0, 0, KIND), name(name), type(type), initializer(initializer) {}
         ~VariableDeclaration();
         Identifier *getName() { return name; }
         Identifier *getType() { return type; }
@@ -13,7 +13,8 @@ namespace ast
         std::vector<VariableDeclaration *> declarations;
 
     public:
-        VariableStatement(std::vector<VariableDeclaration *> declarations) : Node(0, 0, consts::VARIABLE_STATEMENT), declarations(declarations) {}
+        static constexpr unsigned int KIND = consts::VARIABLE_STATEMENT;
+        VariableStatement(std::vector<VariableDeclaration *> declarations) : Node(0, 0, KIND), declarations(declarations) {}
         ~VariableStatement()
         {
             for (auto &&i : declarations)
@@ -12,7 +12,8 @@ namespace ast
         Block *body;
 
     public:
-        WhileExpression(Node *expression, Block *body) : Node(0, 0, consts::WHILE_EXRESSION), expression(expression), body(body) {}
+        static constexpr unsigned int KIND = consts::WHILE_EXRESSION;
+        WhileExpression(Node *expression, Block *body) : Node(0, 0, KIND), expression(expression), body(body) {}
         ~WhileExpression();
         inline Node *getExpression() { return expression; }
         inline Block *getBody() { return body; }
@@ -0,0 +1,37 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include "./Value.hpp"
+
+namespace jit
+{
+    /// @brief Functions every program can call without declaring them.
+    ///
+    /// A builtin is only found when no variable has its name, so a program or a host that declares
+    /// a function of the same name replaces it. Every runtime holds a table of its own, because
+    /// the functions are counted by Values, which may not be shared between threads.
+    ///
+    /// The bulk functions on arrays run through the widest kernels the cpu supports, see
+    /// kernels::best, and change the array they are given in place. Maps are read and written by
+    /// index like arrays, the builtins only check, remove and size their keys.
+    ///
+    /// The math and string builtins are also intrinsics, see jit::intrinsics: while their name is
+    /// unbound the engines evaluate a call in place and only come here for what that does not cover.
+    class Builtins
+    {
+    private:
+        std::unordered_map<std::string, Value> functions;
+
+    public:
+        Builtins();
+        Builtins(const Builtins &) = delete;
+        Builtins &operator=(const Builtins &) = delete;
+
+        /// @brief the builtin with name, nullptr if there is none.
+        inline const Value *find(const std::string &name) const
+        {
+            auto found = functions.find(name);
+            return found != functions.end() ? &found->second : nullptr;
+        }
+    };
+} // namespace jit
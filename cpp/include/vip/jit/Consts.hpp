@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 
 namespace jit
 {
@@ -9,5 +10,47 @@ namespace jit
         const unsigned int ID_NUMBER = 2;
         const unsigned int ID_FUNCTION = 3;
         const unsigned int ID_INTERNAL_FUNCTION = 4;
+        /// @brief an integer wider than a Value holds inline, Value::getKind reports it as ID_NUMBER.
+        const unsigned int ID_INTEGER = 5;
+        /// @brief the layout of a struct, calling it makes a record.
+        const unsigned int ID_SHAPE = 6;
+        const unsigned int ID_RECORD = 7;
+        /// @brief a `number[]`, doubles in one contiguous buffer.
+        const unsigned int ID_ARRAY = 8;
+        /// @brief a `map` from numbers or strings to values.
+        const unsigned int ID_MAP = 9;
+        /// @brief one past the largest object id, the size of tables indexed by id.
+        const unsigned int ID_COUNT = 10;
+
+        /// @brief interpreted calls before a function is handed to the native compiler.
+        const unsigned int NATIVE_CALL_THRESHOLD = 10;
+        /// @brief arguments of a host call the interpreter evaluates on the native stack, more go to a vector.
+        const std::size_t HOST_INLINE_ARGUMENTS = 8;
+
+        /// @brief live young objects before the heap runs a minor collection.
+        const unsigned int HEAP_YOUNG_LIMIT = 1024;
+        /// @brief minor collections between two major ones, given the old generation grew by a quarter.
+        const unsigned int HEAP_MINORS_PER_MAJOR = 10;
+
+        /// @brief length below which a concatenation is copied into a flat string instead of becoming a rope.
+        const std::size_t ROPE_MIN_LENGTH = 128;
+
+        /// @brief bytes of the first chunk of a region, every new chunk doubles it up to REGION_CHUNK_LIMIT.
+        const std::size_t REGION_CHUNK_SIZE = 512;
+        const std::size_t REGION_CHUNK_LIMIT = 1 << 20;
+
+        /// @brief alignment of the buffer of an array, a cache line so vector loads never split one at the start.
+        const std::size_t ARRAY_ALIGNMENT = 64;
+
+        /// @brief slots whose control bytes a map compares at once, the width of an sse2 register.
+        const std::size_t MAP_GROUP = 16;
+
+        /// @brief largest alignment Memory::allocate hands out.
+        const std::size_t MEMORY_MAX_ALIGNMENT = 2048;
+
+        /// @brief entries a heap snapshot lists in each of its rankings.
+        const std::size_t SNAPSHOT_TOP = 10;
+        /// @brief chars of a string a heap snapshot shows.
+        const std::size_t SNAPSHOT_PREVIEW = 40;
     }
 } // namespace jit
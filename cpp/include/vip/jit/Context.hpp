@@ -1,30 +1,101 @@
 #pragma once
+#include <atomic>
 #include <memory>
 #include <string>
+#include <vector>
 #include <map>
-#include "./Object.hpp"
+#include <functional>
+#include "./Value.hpp"
+#include "./Region.hpp"
 
 namespace jit
 {
     class Context
     {
     private:
-        std::string name;
+        typedef std::map<std::string, Value, std::less<std::string>, RegionAllocator<std::pair<const std::string, Value>>> Variables;
+
+        const char *name;
+        /// @brief what name is about, the function for a function frame, may be nullptr.
+        const std::string *detail;
         Context *parent;
-        std::map<std::string, std::shared_ptr<Object>> variables;
+        Context *root;
+        /// @brief memory of the bindings of a context handed out by a ContextStack, given back whenever
+        /// it is cleared. nullptr for other contexts, which may outlive any scope.
+        std::unique_ptr<Region> region;
+        Variables variables;
         bool returnable;
+        /// @brief stamp of the root bindings, only meaningful on the root context.
+        unsigned long version;
+        /// @brief last stamp handed out, shared by every runtime on any thread so stamps never repeat.
+        static std::atomic<unsigned long> stamps;
+
+        /// @brief a context with bindings in a region of its own.
+        Context(std::unique_ptr<Region> region, const char *name, Context *ctx, bool returnable, const std::string *detail);
+
+        friend class ContextStack;
 
     public:
-        Context(std::string name, Context *ctx, bool returnable = false) : name(name), parent(ctx), returnable(returnable) {}
+        Context(const char *name, Context *ctx, bool returnable = false, const std::string *detail = nullptr) : Context(nullptr, name, ctx, returnable, detail) {}
         Context(const Context &) = delete;
         ~Context();
         Context &operator=(const Context &) = delete;
+        static void *operator new(std::size_t size) { return Memory::allocate(size); }
+        static void operator delete(void *pointer) { Memory::deallocate(pointer); }
+        /// @brief turn this context into a new one below ctx, dropping every binding.
+        void reset(const char *name, Context *ctx, bool returnable = false, const std::string *detail = nullptr);
+        /// @brief drop every binding.
+        void clear();
+        /// @brief name for diagnostics, like <function main>.
+        std::string getName() const;
         bool canReturn() { return returnable; }
         Context *getParentContext();
         bool remove(std::string key);
         bool has(std::string key);
-        std::shared_ptr<Object> update(std::string key,  std::shared_ptr<Object> value);
-        std::shared_ptr<Object> get(std::string key);
-        std::shared_ptr<Object> set(std::string key, std::shared_ptr<Object> value);
+        Value update(std::string key, Value value);
+        Value get(std::string key);
+        Value set(std::string key, Value value);
+        /// @brief call visit with every binding of this context, not of its parents.
+        void forEach(const std::function<void(const std::string &, const Value &)> &visit) const;
+        /// @brief copy every binding of scope into this context, replacing bindings of the same name.
+        void absorb(Context &scope);
+        /// @brief find the slot holding key in this context or a parent.
+        /// @param global set to whether the slot belongs to the root context.
+        /// @return the slot or nullptr if no context has key.
+        Value *lookup(const std::string &key, bool &global);
+        /// @brief changes whenever a root slot is removed or shadowed, so a cached root slot is
+        /// still what a lookup from any context would find as long as the version matches.
+        unsigned long getVersion() const { return root->version; }
+    };
+
+    /// @brief contexts handed out and given back in stack order, reused so a frame costs no allocation once warm.
+    class ContextStack
+    {
+    private:
+        std::vector<std::unique_ptr<Context>> contexts;
+        std::size_t depth = 0;
+
+    public:
+        Context *push(const char *name, Context *parent, bool returnable = false, const std::string *detail = nullptr);
+        void pop();
+        /// @brief number of contexts in use.
+        std::size_t size() const { return depth; }
+        /// @brief context in use at index, 0 is the one pushed first.
+        Context *at(std::size_t index) const { return contexts[index].get(); }
+    };
+
+    /// @brief a context taken from a ContextStack for the lifetime of a C++ scope, so exceptions give it back too.
+    class Scope
+    {
+    private:
+        ContextStack &stack;
+        Context *context;
+
+    public:
+        Scope(ContextStack &stack, const char *name, Context *parent, bool returnable = false, const std::string *detail = nullptr) : stack(stack), context(stack.push(name, parent, returnable, detail)) {}
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+        ~Scope() { stack.pop(); }
+        inline Context *get() const { return context; }
     };
 } // namespace jit
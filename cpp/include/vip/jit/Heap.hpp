@@ -0,0 +1,115 @@
+#pragma once
+#include <cstddef>
+#include "./Object.hpp"
+#include "./Consts.hpp"
+
+namespace jit
+{
+    /// @brief what a heap has done so far, pauses are in milliseconds.
+    struct HeapStats
+    {
+        /// @brief objects made while the heap was in use.
+        unsigned long allocated = 0;
+        /// @brief objects the collector freed, everything else was freed by its reference count.
+        unsigned long collected = 0;
+        /// @brief young objects that survived a collection and moved to the old generation.
+        unsigned long promoted = 0;
+        /// @brief objects alive in each generation.
+        std::size_t young = 0;
+        std::size_t old = 0;
+        /// @brief objects alive that can not be part of a cycle, no collection looks at them.
+        std::size_t acyclic = 0;
+        unsigned long minorCollections = 0;
+        unsigned long majorCollections = 0;
+        double totalPause = 0;
+        double maxPause = 0;
+    };
+
+    /// @brief Generational collector for the cycles reference counting can not free.
+    ///
+    /// Values still free an object the moment its last holder lets go; the heap only keeps a list
+    /// of the objects that are alive, split into a young and an old generation. A collection
+    /// subtracts the references the objects of a generation hold to each other from their counts,
+    /// so any count left over comes from outside: a context, a frame, an older object or a Value on
+    /// the native stack. Those objects are the roots, without having to scan the stack for them.
+    /// Whatever the roots do not reach is only held by cycles and is freed.
+    ///
+    /// Minor collections look at the young generation and promote what survives, a major
+    /// collection looks at both once the old generation has grown enough. Objects that can not
+    /// be part of a cycle, like strings, are kept in a list of their own that no collection walks.
+    class Heap
+    {
+    private:
+        static constexpr unsigned int YOUNG = 0;
+        static constexpr unsigned int OLD = 1;
+        static constexpr unsigned int ACYCLIC = 2;
+
+        /// @brief heap objects made on this thread are tracked by, see Heap::Use.
+        static thread_local Heap *active;
+
+        Object *generations[3] = {nullptr, nullptr, nullptr};
+        std::size_t counts[3] = {0, 0, 0};
+        /// @brief young objects that trigger a minor collection at the next safepoint.
+        std::size_t youngLimit;
+        /// @brief size of the old generation after the last major collection.
+        std::size_t oldAfterMajor = 0;
+        unsigned int minorsSinceMajor = 0;
+        HeapStats stats;
+
+        class Subtract;
+        class Reach;
+        class Clear;
+
+        void link(Object *object, unsigned int generation);
+        void unlink(Object *object);
+        /// @brief is object one of the generations up to and including upto.
+        inline bool owns(const Object *object, unsigned int upto) const
+        {
+            return object != nullptr && object->heap == this && object->generation <= upto;
+        }
+        /// @brief should the next collection look at the old generation too.
+        inline bool wantsMajor() const
+        {
+            return minorsSinceMajor + 1 >= consts::HEAP_MINORS_PER_MAJOR && counts[OLD] >= oldAfterMajor + oldAfterMajor / 4;
+        }
+
+    public:
+        /// @brief makes a heap the one new objects are tracked by for the lifetime of a C++ scope.
+        class Use
+        {
+        private:
+            Heap *previous;
+
+        public:
+            Use(Heap &heap) : previous(active) { active = &heap; }
+            Use(const Use &) = delete;
+            Use &operator=(const Use &) = delete;
+            ~Use() { active = previous; }
+        };
+
+        Heap(std::size_t youngLimit = consts::HEAP_YOUNG_LIMIT) : youngLimit(youngLimit) {}
+        Heap(const Heap &) = delete;
+        Heap &operator=(const Heap &) = delete;
+        /// @brief frees the cycles that are left and lets go of objects that outlive the heap.
+        ~Heap();
+
+        /// @brief heap new objects are tracked by, nullptr outside of Heap::Use.
+        static inline Heap *current() { return active; }
+
+        void track(Object *object);
+        void untrack(Object *object);
+
+        /// @brief collect if the young generation is full, called where no object is half made.
+        inline void safepoint()
+        {
+            if (counts[YOUNG] >= youngLimit)
+                collect(wantsMajor());
+        }
+
+        /// @brief free every object that is only reachable from cycles.
+        /// @param major look at the old generation too, not only the young one.
+        void collect(bool major);
+
+        HeapStats getStats() const;
+    };
+} // namespace jit
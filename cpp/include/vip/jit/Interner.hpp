@@ -0,0 +1,41 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include "./Value.hpp"
+
+namespace jit
+{
+    /// @brief Keeps a single String for every distinct text it is given.
+    ///
+    /// Literals are interned, so a literal evaluated a million times is one object, and two
+    /// interned strings are equal only if they are the same object. The interner holds its
+    /// strings for as long as it lives, so only text from the program itself belongs in it.
+    class Interner
+    {
+    private:
+        /// @brief open addressing with linear probing, empty values are free slots.
+        std::vector<Value> slots;
+        std::size_t count = 0;
+        /// @brief number unique to this interner, unlike its address it is never reused by another one.
+        unsigned long id;
+        /// @brief last id handed out.
+        static std::atomic<unsigned long> ids;
+
+        void grow();
+
+    public:
+        Interner() : slots(16), id(++ids) {}
+        Interner(const Interner &) = delete;
+        Interner &operator=(const Interner &) = delete;
+
+        /// @brief the interned string with text, made on first use.
+        const Value &intern(std::string_view text);
+        /// @brief number of distinct strings interned.
+        inline std::size_t size() const { return count; }
+        /// @brief call visit with every interned string.
+        void forEach(const std::function<void(const Value &)> &visit) const;
+    };
+} // namespace jit
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include "./Value.hpp"
+
+namespace jit
+{
+    /// @brief Builtins the engines evaluate where they are called.
+    ///
+    /// The parser marks calls to these names, see ast::CallExpression::getIntrinsic. While no
+    /// binding has the name, the engines evaluate the arguments in place and hand them here, with no
+    /// lookup of the builtin and no call. Whatever the fast path does not cover, like min of an
+    /// array or a wrong argument, goes to the builtin of the same name, which also reports the errors.
+    namespace intrinsics
+    {
+        /// @brief a number, doubles that are whole and fit 53 bits stay exact integers.
+        Value number(double value);
+
+        /// @brief evaluate an intrinsic on count arguments.
+        /// @param id one of the ast::consts::INTRINSIC ids.
+        /// @param result set to the value of the call.
+        /// @return false if the arguments have to go to the builtin instead.
+        /// @throws std::runtime_error if an index is out of range.
+        bool apply(unsigned int id, const Value *args, std::size_t count, Value &result);
+    } // namespace intrinsics
+} // namespace jit
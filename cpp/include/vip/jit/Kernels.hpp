@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+
+namespace jit
+{
+    namespace kernels
+    {
+        /// @brief Bulk operations on arrays of doubles, one set per instruction set.
+        ///
+        /// Every set gives the same results up to rounding: the vector sets sum in several lanes,
+        /// so a sum or dot product may round differently than a left to right loop would. Min and
+        /// max of arrays holding NaN are NaN.
+        struct Table
+        {
+            /// @brief name of the instruction set, like "avx2".
+            const char *name;
+            double (*sum)(const double *data, std::size_t count);
+            /// @brief smallest and largest element, count has to be at least 1.
+            double (*min)(const double *data, std::size_t count);
+            double (*max)(const double *data, std::size_t count);
+            double (*dot)(const double *lhs, const double *rhs, std::size_t count);
+            /// @brief data[i] *= factor.
+            void (*scale)(double *data, std::size_t count, double factor);
+            /// @brief target[i] += source[i].
+            void (*add)(double *target, const double *source, std::size_t count);
+            void (*fill)(double *data, std::size_t count, double value);
+        };
+
+        /// @brief plain loops, which every other set has to agree with.
+        const Table &scalar();
+        /// @brief the widest set the cpu running this supports, picked on first use.
+        const Table &best();
+    } // namespace kernels
+} // namespace jit
@@ -0,0 +1,231 @@
+#pragma once
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include "./components/InternalFunction.hpp"
+#include "./components/String.hpp"
+#include "./components/Array.hpp"
+#include "./components/Map.hpp"
+#include "./Value.hpp"
+#include "./Consts.hpp"
+
+namespace jit
+{
+    /// @brief Turns a C++ callable into a host function, see JustInTime::registerFn.
+    ///
+    /// The kind of every param is known from its C++ type, so it goes into the Signature and is
+    /// checked before the call; unpacking is then a static cast per argument and nothing is boxed.
+    /// Integer params only take whole numbers that fit them, and read those exactly.
+    /// A param may be a number type, bool, std::string, std::string_view, Array &, Map & or Value,
+    /// a result may also be void or const char *. Anything else does not compile.
+    namespace marshal
+    {
+        template <typename T>
+        using Plain = std::remove_cv_t<std::remove_reference_t<T>>;
+
+        /// @brief how a param of type T is read from an argument.
+        template <typename T, typename = void>
+        struct Param;
+
+        template <typename T>
+        struct Param<T, std::enable_if_t<std::is_floating_point_v<T>>>
+        {
+            static constexpr unsigned int KIND = consts::ID_NUMBER;
+            static inline T get(const Value &value) { return static_cast<T>(value.asNumber()); }
+        };
+
+        /// @brief integers are read exactly, a number that is not whole or does not fit T is rejected
+        /// like an argument of the wrong kind.
+        template <typename T>
+        struct Param<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>>
+        {
+            static constexpr unsigned int KIND = consts::ID_NUMBER;
+            static inline T get(const Value &value)
+            {
+                if (value.isInteger())
+                {
+                    auto integer = value.asInteger();
+                    bool fits;
+                    if constexpr (std::is_unsigned_v<T>)
+                        fits = integer >= 0 && static_cast<uint64_t>(integer) <= std::numeric_limits<T>::max();
+                    else
+                        fits = integer >= std::numeric_limits<T>::min() && integer <= std::numeric_limits<T>::max();
+                    if (fits)
+                        return static_cast<T>(integer);
+                }
+                else
+                {
+                    // the limits are powers of two, so max + 1 is exact where max itself may round up.
+                    auto number = value.asNumber();
+                    if (number == std::trunc(number) && number >= static_cast<double>(std::numeric_limits<T>::min()) &&
+                        number < static_cast<double>(std::numeric_limits<T>::max()) + 1.0)
+                        return static_cast<T>(number);
+                }
+                throw std::runtime_error("Invalid type");
+            }
+        };
+
+        template <>
+        struct Param<bool>
+        {
+            static constexpr unsigned int KIND = consts::ID_NUMBER;
+            static inline bool get(const Value &value) { return value.truthy(); }
+        };
+
+        template <>
+        struct Param<std::string_view>
+        {
+            static constexpr unsigned int KIND = consts::ID_STRING;
+            /// @brief valid during the call, the argument holds the string.
+            static inline std::string_view get(const Value &value) { return static_cast<String *>(value.getObject())->view(); }
+        };
+
+        template <>
+        struct Param<std::string>
+        {
+            static constexpr unsigned int KIND = consts::ID_STRING;
+            static inline std::string get(const Value &value) { return std::string(Param<std::string_view>::get(value)); }
+        };
+
+        template <>
+        struct Param<Array>
+        {
+            static constexpr unsigned int KIND = consts::ID_ARRAY;
+            static inline Array &get(const Value &value) { return *static_cast<Array *>(value.getObject()); }
+        };
+
+        template <>
+        struct Param<Map>
+        {
+            static constexpr unsigned int KIND = consts::ID_MAP;
+            static inline Map &get(const Value &value) { return *static_cast<Map *>(value.getObject()); }
+        };
+
+        template <>
+        struct Param<Value>
+        {
+            static constexpr unsigned int KIND = Signature::ANY;
+            static inline const Value &get(const Value &value) { return value; }
+        };
+
+        /// @brief how a result of type T becomes a value.
+        template <typename T, typename = void>
+        struct Result;
+
+        template <typename T>
+        struct Result<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>>
+        {
+            static inline Value make(T result)
+            {
+                // values have no unsigned integers, the few past int64 become the nearest number instead.
+                if constexpr (std::is_unsigned_v<T> && sizeof(T) >= sizeof(int64_t))
+                    if (result > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))
+                        return Value(static_cast<double>(result));
+                return Value::integer(static_cast<int64_t>(result));
+            }
+        };
+
+        template <typename T>
+        struct Result<T, std::enable_if_t<std::is_floating_point_v<T>>>
+        {
+            static inline Value make(T result) { return Value(static_cast<double>(result)); }
+        };
+
+        template <>
+        struct Result<bool>
+        {
+            static inline Value make(bool result) { return Value::boolean(result); }
+        };
+
+        template <>
+        struct Result<std::string>
+        {
+            static inline Value make(const std::string &result) { return Value(new String(std::string_view(result))); }
+        };
+
+        template <>
+        struct Result<std::string_view>
+        {
+            static inline Value make(std::string_view result) { return Value(new String(result)); }
+        };
+
+        template <>
+        struct Result<const char *>
+        {
+            static inline Value make(const char *result) { return Value(new String(result)); }
+        };
+
+        template <>
+        struct Result<Value>
+        {
+            static inline Value make(Value result) { return result; }
+        };
+
+        /// @brief return and param types of a callable, from a function pointer or an operator().
+        template <typename F>
+        struct Callable : Callable<decltype(&F::operator())>
+        {
+        };
+
+        template <typename R, typename... Args>
+        struct Callable<R (*)(Args...)>
+        {
+            static constexpr std::size_t ARITY = sizeof...(Args);
+
+            static Signature signature() { return Signature{{Param<Plain<Args>>::KIND...}, false}; }
+
+            template <typename F, std::size_t... I>
+            static Value invoke(F &fn, Arguments args, std::index_sequence<I...>)
+            {
+                if constexpr (std::is_void_v<R>)
+                {
+                    fn(Param<Plain<Args>>::get(args[I])...);
+                    return Value();
+                }
+                else
+                    return Result<std::decay_t<R>>::make(fn(Param<Plain<Args>>::get(args[I])...));
+            }
+        };
+
+        template <typename R, typename... Args>
+        struct Callable<R (&)(Args...)> : Callable<R (*)(Args...)>
+        {
+        };
+        template <typename R, typename... Args>
+        struct Callable<R(Args...)> : Callable<R (*)(Args...)>
+        {
+        };
+        template <typename C, typename R, typename... Args>
+        struct Callable<R (C::*)(Args...)> : Callable<R (*)(Args...)>
+        {
+        };
+        template <typename C, typename R, typename... Args>
+        struct Callable<R (C::*)(Args...) const> : Callable<R (*)(Args...)>
+        {
+        };
+
+        /// @brief can F be bound by its C++ signature, the callbacks on runtime values are registered as they are.
+        template <typename F>
+        constexpr bool bindable = !std::is_convertible_v<F, CallbackFunction> && !std::is_convertible_v<F, ValueFunction>;
+
+        /// @brief the signature that checks the arguments of F.
+        template <typename F>
+        inline Signature signature() { return Callable<std::decay_t<F>>::signature(); }
+
+        /// @brief a host function that unpacks its arguments for fn and turns its result into a value.
+        template <typename F>
+        HostFunction bind(F fn)
+        {
+            using Traits = Callable<std::decay_t<F>>;
+            return [fn = std::move(fn)](Arguments args) mutable -> Value
+            {
+                return Traits::invoke(fn, args, std::make_index_sequence<Traits::ARITY>());
+            };
+        }
+    } // namespace marshal
+} // namespace jit
@@ -0,0 +1,120 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+
+namespace jit
+{
+    /// @brief what a runtime has allocated, in bytes. A limit of 0 is no limit.
+    struct MemoryStats
+    {
+        std::size_t current = 0;
+        std::size_t peak = 0;
+        std::size_t softLimit = 0;
+        std::size_t hardLimit = 0;
+        /// @brief allocations that failed because they would have gone past the hard limit.
+        unsigned long refused = 0;
+    };
+
+    /// @brief where a runtime gets its memory from, for embedders that bring their own allocator.
+    struct Allocator
+    {
+        /// @brief bytes aligned to align, a power of two. Throws std::bad_alloc when out of memory.
+        std::function<void *(std::size_t bytes, std::size_t align)> allocate;
+        /// @brief gives back memory from allocate with the bytes and align it was asked for, it must not throw.
+        std::function<void(void *pointer, std::size_t bytes, std::size_t align)> deallocate;
+    };
+
+    /// @brief thrown instead of allocating past the hard limit of a runtime, nothing was allocated.
+    class MemoryLimitError : public std::bad_alloc
+    {
+    public:
+        const char *what() const noexcept override { return "Memory limit exceeded."; }
+    };
+
+    /// @brief Accounting of the memory a runtime allocates.
+    ///
+    /// Objects, the chunks of regions that hold frames and bindings, the buffers of strings, arrays
+    /// and maps, and ast nodes are allocated through Memory::allocate, which charges the memory in
+    /// use on the thread, see Memory::Use. Every allocation remembers what it was charged to, so
+    /// freeing it credits the right runtime wherever that happens, even after the runtime is gone.
+    /// Memory allocated while no memory is in use is not charged to anything.
+    ///
+    /// The bytes come from ::operator new unless the memory was given an Allocator, which then also
+    /// frees everything charged to it.
+    ///
+    /// Going past the soft limit calls a callback once, until usage drops below it again. An
+    /// allocation that would go past the hard limit throws MemoryLimitError, a std::bad_alloc,
+    /// which ends the script like any other error and leaves the runtime usable.
+    class Memory
+    {
+    private:
+        struct Account;
+
+        /// @brief outlives the memory when allocations charged to it are still alive.
+        Account *account;
+
+        static thread_local Account *active;
+
+        static void charge(Account *account, std::size_t bytes);
+        static void credit(Account *account, std::size_t bytes) noexcept;
+
+    public:
+        /// @brief makes a memory the one allocations are charged to for the lifetime of a C++ scope.
+        class Use
+        {
+        private:
+            Account *previous;
+
+        public:
+            Use(Memory &memory) : previous(active) { active = memory.account; }
+            Use(const Use &) = delete;
+            Use &operator=(const Use &) = delete;
+            ~Use() { active = previous; }
+        };
+
+        Memory();
+        Memory(const Memory &) = delete;
+        Memory &operator=(const Memory &) = delete;
+        ~Memory();
+
+        /// @param bytes usage that calls callback when it is reached, 0 for none.
+        /// @param callback called with the usage that reached the limit, it must not throw.
+        void setSoftLimit(std::size_t bytes, std::function<void(std::size_t)> callback);
+        /// @param bytes usage no allocation may go past, 0 for none.
+        void setHardLimit(std::size_t bytes);
+        /// @param allocator what allocations charged to this memory are made and freed with, it has to
+        /// outlive them. Empty functions go back to ::operator new and ::operator delete.
+        /// @throws std::runtime_error if anything is charged to the memory already.
+        void setAllocator(Allocator allocator);
+        MemoryStats getStats() const;
+
+        /// @brief allocate bytes, charged to the memory in use.
+        /// @param align alignment, a power of two up to consts::MEMORY_MAX_ALIGNMENT.
+        /// @throws MemoryLimitError if the hard limit would be passed.
+        static void *allocate(std::size_t bytes, std::size_t align = alignof(std::max_align_t));
+        /// @brief free memory from allocate, crediting what it was charged to.
+        static void deallocate(void *pointer) noexcept;
+        /// @brief bytes charged for memory from allocate, with the header and padding in front of it.
+        static std::size_t size(const void *pointer) noexcept;
+    };
+
+    /// @brief std allocator that charges the memory in use, see Memory.
+    template <typename T>
+    class MemoryAllocator
+    {
+    public:
+        typedef T value_type;
+
+        MemoryAllocator() noexcept = default;
+        template <typename U>
+        MemoryAllocator(const MemoryAllocator<U> &) noexcept {}
+
+        inline T *allocate(std::size_t count) { return static_cast<T *>(Memory::allocate(count * sizeof(T), alignof(T))); }
+        inline void deallocate(T *pointer, std::size_t) noexcept { Memory::deallocate(pointer); }
+
+        inline friend bool operator==(const MemoryAllocator &, const MemoryAllocator &) { return true; }
+        inline friend bool operator!=(const MemoryAllocator &, const MemoryAllocator &) { return false; }
+    };
+} // namespace jit
@@ -1,22 +1,91 @@
 #pragma once
 #include <iostream>
+#include <memory>
+#include "./Memory.hpp"
 
 namespace jit
 {
+    class Value;
+    class Heap;
+
+    /// @brief visits the values an object holds, see Object::trace.
+    class Tracer
+    {
+    public:
+        virtual ~Tracer() = default;
+        virtual void visit(Value &child) = 0;
+    };
+
     class Object
     {
     private:
         unsigned int kind = 0;
+        /// @brief number of Values holding this object, it deletes itself when the last one lets go.
+        unsigned int refs = 0;
+        /// @brief references the collector has not accounted for, only meaningful while it runs.
+        unsigned int scratch = 0;
+        /// @brief generation of the heap the object is in, see Heap.
+        unsigned int generation = 0;
+        /// @brief can the object hold values that lead back to it.
+        bool cyclic;
+        /// @brief heap that was in use when the object was made, nullptr if there was none.
+        Heap *heap = nullptr;
+        /// @brief neighbours in the list of the generation.
+        Object *prev = nullptr;
+        Object *next = nullptr;
+
+        friend class Heap;
+        friend class Snapshot;
 
     public:
-        Object(unsigned int kind) : kind(kind) {}
-        virtual ~Object() = default;
+        /// @param cyclic can the object hold values that lead back to it, only those are looked at by
+        /// the collector and have to implement trace.
+        Object(unsigned int kind, bool cyclic = false);
+        Object(const Object &other);
+        Object &operator=(const Object &) { return *this; }
+        virtual ~Object();
+        /// @brief objects are charged to the memory of the runtime that makes them, see Memory.
+        static void *operator new(std::size_t size) { return Memory::allocate(size); }
+        static void operator delete(void *pointer) { Memory::deallocate(pointer); }
         inline unsigned int getKind() const { return kind; }
+        inline void retain() { refs++; }
+        inline void release()
+        {
+            if (--refs == 0)
+                delete this;
+        }
+        /// @brief number of Values holding this object, 0 for objects only a shared_ptr holds.
+        inline unsigned int getRefs() const { return refs; }
         virtual void print(std::ostream &where) const { where << "object"; };
+        /// @brief hand every value this object holds to tracer, cyclic objects have to override this or
+        /// the collector can not find the cycles they are part of.
+        virtual void trace(Tracer &) {}
+        /// @brief bytes the object takes up with the buffers it owns, as Memory charges them.
+        virtual std::size_t footprint() const { return Memory::size(this); }
         inline friend std::ostream &operator<<(std::ostream &out, const Object &f)
         {
             f.print(out);
             return out;
         }
     };
+
+    /// @brief Cast an object to T after checking its kind, so no rtti is needed.
+    /// @return the object or nullptr if it is not a T.
+    template <typename T>
+    inline T *cast(const std::shared_ptr<Object> &value)
+    {
+        if (value == nullptr || value->getKind() != T::KIND)
+            return nullptr;
+        return static_cast<T *>(value.get());
+    }
+
+    /// @brief Like cast, but shares the object, in place of std::dynamic_pointer_cast which needs rtti.
+    /// @return the object or nullptr if it is not a T.
+    template <typename T>
+    inline std::shared_ptr<T> sharedCast(const std::shared_ptr<Object> &value)
+    {
+        if (cast<T>(value) == nullptr)
+            return nullptr;
+        return std::static_pointer_cast<T>(value);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,146 @@
+#pragma once
+#include <array>
+#include "../ast/Consts.hpp"
+#include "./Value.hpp"
+#include "./Consts.hpp"
+
+namespace jit
+{
+    namespace operators
+    {
+        /// @brief apply an operator to two values whose kinds the kernel was selected for.
+        typedef Value (*Kernel)(const Value &lhs, const Value &rhs);
+
+        const unsigned int OP_PLUS = 0;
+        const unsigned int OP_MINUS = 1;
+        const unsigned int OP_MULT = 2;
+        const unsigned int OP_DIV = 3;
+        const unsigned int OP_LESS_THEN = 4;
+        const unsigned int OP_GREATER_THEN = 5;
+        const unsigned int OP_LESS_THEN_OR_EQUAL = 6;
+        const unsigned int OP_GREATER_THEN_OR_EQUAL = 7;
+        const unsigned int OP_EQUAL_EQUAL = 8;
+        const unsigned int OP_NOT_EQUAL = 9;
+        const unsigned int OP_AND = 10;
+        const unsigned int OP_OR = 11;
+        const unsigned int OP_MOD = 12;
+        const unsigned int OP_BIT_AND = 13;
+        const unsigned int OP_BIT_OR = 14;
+        const unsigned int OP_BIT_XOR = 15;
+        const unsigned int OP_SHIFT_LEFT = 16;
+        const unsigned int OP_SHIFT_RIGHT = 17;
+        /// @brief index of operators the table does not know.
+        const unsigned int OP_UNKNOWN = 18;
+        const unsigned int OP_COUNT = 19;
+
+        /// @brief map an ast::consts operator to its dense index in the table.
+        constexpr unsigned int index(unsigned int op)
+        {
+            switch (op)
+            {
+            case ast::consts::PLUS:
+                return OP_PLUS;
+            case ast::consts::MINUS:
+                return OP_MINUS;
+            case ast::consts::MULT:
+                return OP_MULT;
+            case ast::consts::DIV:
+                return OP_DIV;
+            case ast::consts::LESS_THEN:
+                return OP_LESS_THEN;
+            case ast::consts::GREATER_THEN:
+                return OP_GREATER_THEN;
+            case ast::consts::LESS_THEN_OR_EQUAL:
+                return OP_LESS_THEN_OR_EQUAL;
+            case ast::consts::GREATER_THEN_OR_EQUAL:
+                return OP_GREATER_THEN_OR_EQUAL;
+            case ast::consts::EQUAL_EQUAL:
+                return OP_EQUAL_EQUAL;
+            case ast::consts::NOT_EQUAL:
+                return OP_NOT_EQUAL;
+            case ast::consts::AND:
+                return OP_AND;
+            case ast::consts::OR:
+                return OP_OR;
+            case ast::consts::MOD:
+                return OP_MOD;
+            case ast::consts::BIT_AND:
+                return OP_BIT_AND;
+            case ast::consts::BIT_OR:
+                return OP_BIT_OR;
+            case ast::consts::BIT_XOR:
+                return OP_BIT_XOR;
+            case ast::consts::SHIFT_LEFT:
+                return OP_SHIFT_LEFT;
+            case ast::consts::SHIFT_RIGHT:
+                return OP_SHIFT_RIGHT;
+            default:
+                return OP_UNKNOWN;
+            }
+        }
+
+        /// @brief the operator a compound assignment applies, like ast::consts::PLUS for +=.
+        /// @return the operator or 0 if op is not a compound assignment.
+        constexpr unsigned int compound(unsigned int op)
+        {
+            switch (op)
+            {
+            case ast::consts::SET_PLUS:
+                return ast::consts::PLUS;
+            case ast::consts::SET_MINUS:
+                return ast::consts::MINUS;
+            case ast::consts::SET_MULT:
+                return ast::consts::MULT;
+            case ast::consts::SET_DIV:
+                return ast::consts::DIV;
+            default:
+                return 0;
+            }
+        }
+
+        /// @brief && and || only evaluate their rhs when the lhs does not decide the result.
+        constexpr bool isLogical(unsigned int op)
+        {
+            return op == ast::consts::AND || op == ast::consts::OR;
+        }
+
+        /// @brief kernels indexed by (lhs id, rhs id, operator index), combinations that are not
+        /// supported get a kernel that throws the same error the interpreter always has.
+        extern const std::array<Kernel, consts::ID_COUNT * consts::ID_COUNT * OP_COUNT> TABLE;
+
+        /// @brief find the kernel for two object ids and an operator index.
+        inline Kernel lookup(unsigned int lhs, unsigned int rhs, unsigned int op)
+        {
+            if (lhs >= consts::ID_COUNT || rhs >= consts::ID_COUNT)
+            {
+                // ids the table does not cover have no operators, only keep whether they match.
+                rhs = lhs == rhs ? consts::ID_NULL : consts::ID_STRING;
+                lhs = consts::ID_NULL;
+            }
+            return TABLE[(lhs * consts::ID_COUNT + rhs) * OP_COUNT + op];
+        }
+
+        /// @brief apply an operator to two values.
+        /// @param op operator index
+        Value apply(unsigned int op, const Value &lhs, const Value &rhs);
+
+        /// @brief target = target op rhs, changing the object target holds when no other value holds it.
+        /// @param op operator index
+        /// @return the new value of target.
+        const Value &assign(unsigned int op, Value &target, const Value &rhs);
+
+        /// @brief object[index], an element of an array or the value of a key of a map.
+        /// @throws std::runtime_error if object can not be indexed or has nothing at index.
+        Value element(const Value &object, const Value &index);
+
+        /// @brief object[index] = value, or object[index] op= value for a compound assignment.
+        /// @param op operator index of a compound assignment, OP_UNKNOWN for a plain one.
+        /// @return the value stored.
+        Value setElement(const Value &object, const Value &index, unsigned int op, const Value &value);
+
+        /// @brief result of a logical operator decided by its lhs alone.
+        /// @param op operator index
+        /// @return the result or an empty value if the rhs has to be evaluated.
+        Value shortCircuit(unsigned int op, const Value &lhs);
+    } // namespace operators
+} // namespace jit
@@ -0,0 +1,116 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "./Consts.hpp"
+#include "./Memory.hpp"
+
+namespace jit
+{
+    /// @brief Monotonic allocator for memory that dies with a scope.
+    ///
+    /// Memory is carved from chunks by bumping a pointer and is never given back one allocation at
+    /// a time. Releasing to a mark or resetting hands back everything allocated since in O(1) and
+    /// keeps the chunks, so a region that is warm allocates nothing from the system. A region is
+    /// used by a single thread and never takes a lock.
+    class Region
+    {
+    private:
+        struct Chunk
+        {
+            Chunk *next;
+            std::size_t size;
+            inline char *data() { return reinterpret_cast<char *>(this + 1); }
+        };
+
+        Chunk *first = nullptr;
+        Chunk *current = nullptr;
+        char *cursor = nullptr;
+        char *limit = nullptr;
+        std::size_t chunkSize;
+
+        /// @brief move on to the next chunk that fits size, allocating one if there is none.
+        void *grow(std::size_t size, std::size_t align);
+
+    public:
+        /// @brief a point to release back to, everything allocated after it is given back.
+        struct Mark
+        {
+            Chunk *chunk;
+            char *cursor;
+        };
+
+        /// @brief gives the memory allocated in a C++ scope back to the region at its end.
+        class Scope
+        {
+        private:
+            Region &region;
+            Mark mark;
+
+        public:
+            Scope(Region &region) : region(region), mark(region.mark()) {}
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+            ~Scope() { region.release(mark); }
+        };
+
+        Region(std::size_t chunkSize = consts::REGION_CHUNK_SIZE) : chunkSize(chunkSize) {}
+        Region(const Region &) = delete;
+        Region &operator=(const Region &) = delete;
+        ~Region();
+
+        inline void *allocate(std::size_t size, std::size_t align)
+        {
+            auto address = (reinterpret_cast<std::uintptr_t>(cursor) + align - 1) & ~(std::uintptr_t)(align - 1);
+            if (cursor != nullptr && address + size <= reinterpret_cast<std::uintptr_t>(limit))
+            {
+                cursor = reinterpret_cast<char *>(address + size);
+                return reinterpret_cast<void *>(address);
+            }
+            return grow(size, align);
+        }
+
+        inline Mark mark() const { return Mark{current, cursor}; }
+        inline void release(Mark mark)
+        {
+            current = mark.chunk;
+            cursor = mark.cursor;
+            limit = current != nullptr ? current->data() + current->size : nullptr;
+        }
+        /// @brief give back everything, the chunks are kept for the next use.
+        inline void reset() { release(Mark{first, first != nullptr ? first->data() : nullptr}); }
+    };
+
+    /// @brief std allocator over a region, or over Memory::allocate when it has no region.
+    ///
+    /// Deallocating region memory does nothing, it comes back when the region is released.
+    template <typename T>
+    class RegionAllocator
+    {
+    private:
+        Region *region;
+
+    public:
+        typedef T value_type;
+
+        RegionAllocator(Region *region = nullptr) noexcept : region(region) {}
+        template <typename U>
+        RegionAllocator(const RegionAllocator<U> &other) noexcept : region(other.getRegion()) {}
+
+        inline Region *getRegion() const { return region; }
+
+        inline T *allocate(std::size_t count)
+        {
+            if (region == nullptr)
+                return static_cast<T *>(Memory::allocate(count * sizeof(T), alignof(T)));
+            return static_cast<T *>(region->allocate(count * sizeof(T), alignof(T)));
+        }
+        inline void deallocate(T *pointer, std::size_t) noexcept
+        {
+            if (region == nullptr)
+                Memory::deallocate(pointer);
+        }
+
+        inline friend bool operator==(const RegionAllocator &lhs, const RegionAllocator &rhs) { return lhs.region == rhs.region; }
+        inline friend bool operator!=(const RegionAllocator &lhs, const RegionAllocator &rhs) { return lhs.region != rhs.region; }
+    };
+} // namespace jit
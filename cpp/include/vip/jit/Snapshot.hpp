@@ -0,0 +1,90 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+#include "./Value.hpp"
+#include "./Heap.hpp"
+#include "./Consts.hpp"
+
+namespace jit
+{
+    /// @brief objects of one kind a snapshot found and the bytes they take up.
+    struct SnapshotKind
+    {
+        std::size_t count = 0;
+        std::size_t bytes = 0;
+    };
+
+    /// @brief Everything the roots of a runtime keep alive at one moment.
+    ///
+    /// A snapshot walks the bindings of the contexts that are alive and the interned literals, and
+    /// every object those reach, breadth first so the path it records for an object is a shortest
+    /// one. Objects the heap tracks that the walk does not reach are counted as unreached: they are
+    /// held by a Value on the C++ side or by cycles the collector has not freed yet.
+    ///
+    /// toJson writes a compact document whose keys always come in the same order, so two
+    /// snapshots can be compared with a text diff, or with diff for the change per kind.
+    class Snapshot
+    {
+    public:
+        /// @brief an object worth a closer look and how it is kept alive.
+        struct Retained
+        {
+            unsigned int kind;
+            std::size_t bytes;
+            /// @brief the root followed by the kind of every object on the way, like `cache > map > string`.
+            std::string path;
+        };
+        struct StringEntry
+        {
+            std::size_t length;
+            std::size_t bytes;
+            /// @brief the first consts::SNAPSHOT_PREVIEW chars.
+            std::string preview;
+            std::string path;
+        };
+        struct FunctionEntry
+        {
+            std::string name;
+            /// @brief ast the function keeps for its params and body, 0 once it has been lowered.
+            std::size_t astNodes;
+            std::size_t astBytes;
+            std::string path;
+        };
+
+    private:
+        std::array<SnapshotKind, consts::ID_COUNT> kinds;
+        std::size_t objects = 0;
+        std::size_t bytes = 0;
+        std::size_t unreached = 0;
+        std::vector<Retained> largest;
+        std::vector<StringEntry> strings;
+        std::vector<FunctionEntry> functions;
+
+        class Walk;
+
+    public:
+        /// @brief walk everything roots reach.
+        /// @param roots values with the name their paths start with.
+        /// @param heap heap whose unreached objects are counted, nullptr to count none.
+        static Snapshot take(const std::vector<std::pair<std::string, Value>> &roots, const Heap *heap);
+
+        inline std::size_t getObjects() const { return objects; }
+        inline std::size_t getBytes() const { return bytes; }
+        inline std::size_t getUnreached() const { return unreached; }
+        /// @param kind one of the jit::consts ids.
+        inline const SnapshotKind &getKind(unsigned int kind) const { return kinds[kind]; }
+        /// @brief the consts::SNAPSHOT_TOP objects that take up the most bytes, largest first.
+        inline const std::vector<Retained> &getLargest() const { return largest; }
+        /// @brief the consts::SNAPSHOT_TOP longest strings, longest first.
+        inline const std::vector<StringEntry> &getStrings() const { return strings; }
+        /// @brief the consts::SNAPSHOT_TOP functions that keep the most ast, largest first.
+        inline const std::vector<FunctionEntry> &getFunctions() const { return functions; }
+
+        std::string toJson() const;
+        /// @brief what changed from before to after, per kind and in total, as json.
+        static std::string diff(const Snapshot &before, const Snapshot &after);
+    };
+} // namespace jit
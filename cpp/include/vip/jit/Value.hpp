@@ -0,0 +1,170 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include "./components/Integer.hpp"
+#include "./Object.hpp"
+#include "./Consts.hpp"
+
+namespace jit
+{
+    static_assert(sizeof(void *) == 8, "Value keeps pointers in the low 48 bits of a double.");
+
+    /// @brief A value of the language in 64 bits.
+    ///
+    /// Numbers are the double itself. The quiet NaN space holds the immediates null, false and
+    /// true, integers of up to 48 bits, and with the sign bit set, pointers to the objects that live
+    /// on the heap: strings, functions and wider integers. Every NaN is folded into one canonical
+    /// NaN first, so no double is mistaken for a tagged value. Objects are counted by the Values
+    /// holding them, without atomics, so a Value must not be shared between threads.
+    ///
+    /// A default constructed value is empty, which is what a variable declared without a value
+    /// holds and what a callback returning nothing gives back.
+    class Value
+    {
+    private:
+        static constexpr uint64_t SIGN = 0x8000000000000000ull;
+        static constexpr uint64_t QNAN = 0x7ffc000000000000ull;
+        static constexpr uint64_t CANONICAL_NAN = 0x7ff8000000000000ull;
+        static constexpr uint64_t TAG_EMPTY = QNAN;
+        static constexpr uint64_t TAG_NULL = QNAN | 1;
+        static constexpr uint64_t TAG_FALSE = QNAN | 2;
+        static constexpr uint64_t TAG_TRUE = QNAN | 3;
+        static constexpr uint64_t POINTER = SIGN | QNAN;
+        static constexpr uint64_t TAG_INTEGER = QNAN | (1ull << 48);
+        static constexpr uint64_t INTEGER_MASK = SIGN | QNAN | (3ull << 48);
+        static constexpr uint64_t PAYLOAD = (1ull << 48) - 1;
+        static constexpr int64_t INLINE_LIMIT = 1ll << 47;
+
+        uint64_t bits;
+
+        struct Raw
+        {
+        };
+        constexpr Value(Raw, uint64_t bits) : bits(bits) {}
+
+        inline Object *pointer() const { return reinterpret_cast<Object *>(bits & ~POINTER); }
+
+    public:
+        constexpr Value() : bits(TAG_EMPTY) {}
+        explicit Value(double number)
+        {
+            if (number != number)
+                bits = CANONICAL_NAN;
+            else
+                std::memcpy(&bits, &number, sizeof(bits));
+        }
+        /// @brief hold an object, a new object starts out owned by this value.
+        explicit Value(Object *object) : bits(reinterpret_cast<uint64_t>(object) | POINTER)
+        {
+            object->retain();
+        }
+        Value(const Value &other) : bits(other.bits)
+        {
+            if (isObject())
+                pointer()->retain();
+        }
+        Value(Value &&other) noexcept : bits(other.bits) { other.bits = TAG_EMPTY; }
+        ~Value()
+        {
+            if (isObject())
+                pointer()->release();
+        }
+        Value &operator=(const Value &other)
+        {
+            Value copy(other);
+            std::swap(bits, copy.bits);
+            return *this;
+        }
+        Value &operator=(Value &&other) noexcept
+        {
+            // the moved from value is left empty, like a moved from shared_ptr.
+            Value old(std::move(*this));
+            std::swap(bits, other.bits);
+            return *this;
+        }
+
+        static inline Value boolean(bool value) { return Value(Raw{}, value ? TAG_TRUE : TAG_FALSE); }
+        static inline Value null() { return Value(Raw{}, TAG_NULL); }
+        /// @brief an exact integer, inline when it fits 48 bits.
+        static inline Value integer(int64_t value)
+        {
+            if (value >= -INLINE_LIMIT && value < INLINE_LIMIT)
+                return Value(Raw{}, TAG_INTEGER | ((uint64_t)value & PAYLOAD));
+            return Value(new Integer(value));
+        }
+
+        inline bool isEmpty() const { return bits == TAG_EMPTY; }
+        inline bool isNull() const { return bits == TAG_NULL; }
+        /// @brief is this a double or an integer, booleans are not.
+        inline bool isNumber() const { return isDouble() || isInteger(); }
+        inline bool isDouble() const { return (bits & QNAN) != QNAN; }
+        inline bool isInteger() const
+        {
+            return (bits & INTEGER_MASK) == TAG_INTEGER || (isObject() && pointer()->getKind() == consts::ID_INTEGER);
+        }
+        inline bool isBoolean() const { return (bits | 1) == TAG_TRUE; }
+        inline bool isObject() const { return (bits & POINTER) == POINTER; }
+
+        /// @brief the integer, only for values isInteger is true for.
+        inline int64_t asInteger() const
+        {
+            if (!isObject())
+                return (int64_t)(bits << 16) >> 16;
+            return static_cast<Integer *>(pointer())->getValue();
+        }
+        /// @brief the number, 1 or 0 for booleans, only for values of kind consts::ID_NUMBER.
+        inline double asNumber() const
+        {
+            if (isBoolean())
+                return bits == TAG_TRUE ? 1 : 0;
+            if (!isDouble())
+                return (double)asInteger();
+            double number;
+            std::memcpy(&number, &bits, sizeof(number));
+            return number;
+        }
+        /// @brief does this value let an if or a loop run, only numbers and booleans can.
+        inline bool truthy() const { return (isNumber() || isBoolean()) && asNumber() != 0; }
+
+        /// @brief object id of the value, numbers, integers and booleans are consts::ID_NUMBER.
+        inline unsigned int getKind() const
+        {
+            if (isObject())
+                return pointer()->getKind() == consts::ID_INTEGER ? consts::ID_NUMBER : pointer()->getKind();
+            if (isDouble() || isBoolean() || (bits & INTEGER_MASK) == TAG_INTEGER)
+                return consts::ID_NUMBER;
+            return consts::ID_NULL;
+        }
+        /// @brief the object held, nullptr for immediates.
+        inline Object *getObject() const { return isObject() ? pointer() : nullptr; }
+        /// @brief is this the only value holding its object, so the object may be changed in place.
+        inline bool isUnique() const { return isObject() && pointer()->getRefs() == 1; }
+
+        friend std::ostream &operator<<(std::ostream &out, const Value &value);
+    };
+
+    /// @brief Cast the object a value holds to T after checking its kind.
+    /// @return the object or nullptr if the value is not a T.
+    template <typename T>
+    inline T *cast(const Value &value)
+    {
+        if (!value.isObject() || value.getObject()->getKind() != T::KIND)
+            return nullptr;
+        return static_cast<T *>(value.getObject());
+    }
+
+    /// @brief print a value a record or map holds, records, maps and arrays are only named so cycles
+    /// between records and maps still print.
+    void printHeld(std::ostream &out, const Value &value);
+
+    /// @brief the value as an object for the public api, numbers become jit::Number and null jit::Null.
+    /// @return the object or nullptr for an empty value.
+    std::shared_ptr<Object> box(const Value &value);
+
+    /// @brief the value an object from the public api stands for.
+    /// @throws std::runtime_error if the object can not be held by a value.
+    Value unbox(const std::shared_ptr<Object> &object);
+} // namespace jit
@@ -0,0 +1,118 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <utility>
+#include "../../ast/Program.hpp"
+#include "../Value.hpp"
+#include "../Heap.hpp"
+#include "../Memory.hpp"
+#include "../Snapshot.hpp"
+#include "../Interner.hpp"
+#include "../Builtins.hpp"
+#include "../Region.hpp"
+
+namespace jit
+{
+    namespace closure
+    {
+        /// @brief values of a frame, carved from the region of the engine and given back when the call returns.
+        typedef std::vector<Value, RegionAllocator<Value>> Values;
+
+        struct Global;
+        /// @brief the locals in scope at a call site, as the global of their name and their slot.
+        typedef std::vector<std::pair<Global *, std::size_t>> Visible;
+        /// @brief the locals of the frames tail calls replaced, by the global of their name.
+        typedef std::vector<std::pair<Global *, Value>> Replaced;
+
+        /// @brief params and locals of a single call, indexed by the slots resolved while lowering.
+        struct Frame
+        {
+            /// @brief region the frames and arguments of the calls made from this frame come from.
+            Region *region;
+            Values slots;
+            /// @brief value of the return statement that ended the call.
+            Value result;
+            /// @brief function a return statement in tail position called, run by the caller in this frame.
+            Value tail;
+            Values arguments;
+            /// @brief frame of the call site, nullptr for the frame of a program.
+            Frame *caller = nullptr;
+            /// @brief locals of caller the call site sees, which the callee sees too.
+            const Visible *site = nullptr;
+            /// @brief seen by the callee before the locals of caller, nullptr for the frame of a program.
+            Replaced *replaced = nullptr;
+
+            Frame(std::size_t size, Region *region) : region(region), slots(size, Value(), RegionAllocator<Value>(region)), arguments(RegionAllocator<Value>(region)) {}
+        };
+
+        /// @brief a top level variable, bound by address into the code that uses it.
+        struct Global
+        {
+            Value value;
+            bool declared = false;
+            /// @brief a local somewhere has the name, so a function may read the local of a caller instead.
+            bool shadowed = false;
+        };
+
+        typedef std::function<Value(Frame &)> Expression;
+        /// @brief run a statement, returns true if a return statement ran and left its value in Frame::result.
+        typedef std::function<bool(Frame &)> Statement;
+
+        /// @brief lowered body of a function or program.
+        struct Procedure
+        {
+            std::string name;
+            /// @brief object id each param has to have, consts::ID_RECORD for a param typed with a struct.
+            std::vector<unsigned int> params;
+            /// @brief struct the record passed to each consts::ID_RECORD param has to be of, empty for other params.
+            std::vector<std::string> structs;
+            /// @brief number of slots a frame for this procedure needs, params come first.
+            std::size_t slots = 0;
+            Statement body;
+        };
+
+        class Lowering;
+
+        /// @brief Execution engine that lowers the ast once into a tree of pre-bound callables.
+        ///
+        /// Every node becomes a closure that captures its children and the slot or global it reads,
+        /// so running code needs no kind switches, casts or name lookups. Names resolve like they do
+        /// in the interpreter: a function sees its own params and locals, then the locals its
+        /// callers see at their call sites, then the top level variables. A name that is a local
+        /// nowhere, which most globals are, is read from its global without a look at the callers.
+        class Engine
+        {
+        private:
+            /// @brief first, so it goes last and still sees every object the engine lets go of.
+            Heap heap;
+            /// @brief what the objects, contexts and programs of the engine take up, see Memory.
+            Memory memory;
+            /// @brief the string literals of every program the engine has run.
+            Interner strings;
+            /// @brief called by names that no global is declared with when the call runs.
+            Builtins builtins;
+            /// @brief memory of the frames that are running, released in stack order as calls return.
+            Region frames;
+            std::map<std::string, Global> globals;
+            std::deque<Procedure> procedures;
+
+            friend class Lowering;
+
+        public:
+            Engine();
+            Engine(const Engine &) = delete;
+            Engine &operator=(const Engine &) = delete;
+            void declare(std::string key, Value value);
+            void drop(std::string key);
+            Value execute(ast::Program &program, bool returnLast = false);
+            inline Heap &getHeap() { return heap; }
+            inline Memory &getMemory() { return memory; }
+            /// @brief walk what the globals and the literals reach, frames live on the native stack and are not seen.
+            Snapshot snapshot();
+        };
+    } // namespace closure
+} // namespace jit
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "../Object.hpp"
+#include "../Value.hpp"
+#include "../Consts.hpp"
+
+namespace jit
+{
+    /// @brief A `number[]`, a fixed number of doubles in one buffer.
+    ///
+    /// The buffer is aligned to consts::ARRAY_ALIGNMENT and holds the doubles themselves, not
+    /// Values, so the bulk builtins hand it straight to the kernels, see kernels::Table. An array
+    /// can not hold anything that leads back to it and is never looked at by the collector.
+    class Array : public Object
+    {
+    private:
+        double *data;
+        std::size_t length;
+
+        /// @brief the slot of an index that is not an inline integer.
+        static std::size_t slowSlot(const Value &index, std::size_t length);
+
+    public:
+        static constexpr unsigned int KIND = consts::ID_ARRAY;
+
+        Array(std::size_t length, double value = 0);
+        Array(const Array &) = delete;
+        Array &operator=(const Array &) = delete;
+        ~Array();
+
+        inline double *getData() { return data; }
+        inline const double *getData() const { return data; }
+        inline std::size_t size() const { return length; }
+
+        /// @brief slot an index refers to.
+        /// @throws std::runtime_error if index is not a whole number or out of range.
+        inline std::size_t slot(const Value &index) const
+        {
+            if (index.isInteger() && !index.isObject())
+            {
+                auto at = index.asInteger();
+                if (at >= 0 && (uint64_t)at < length)
+                    return (std::size_t)at;
+            }
+            return slowSlot(index, length);
+        }
+        inline Value get(const Value &index) const { return Value(data[slot(index)]); }
+        /// @throws std::runtime_error if value is not a number.
+        void set(const Value &index, const Value &value);
+
+        std::size_t footprint() const override { return Object::footprint() + Memory::size(data); }
+        void print(std::ostream &where) const override;
+    };
+} // namespace jit
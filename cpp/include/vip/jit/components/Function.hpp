@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include <vector>
 #include "../../ast/Parameter.hpp"
 #include "../../ast/Block.hpp"
@@ -7,18 +8,50 @@
 
 namespace jit
 {
+    namespace native
+    {
+        struct NativeFunction;
+    }
+    namespace closure
+    {
+        struct Procedure;
+    }
+
     class Function : public Object
     {
     private:
         std::string name;
         ast::Block *body;
         std::vector<ast::Parameter *> params;
+        unsigned int calls;
+        native::NativeFunction *native;
+        bool nativeRejected;
+        closure::Procedure *procedure;
+        unsigned long id;
+        /// @brief last id handed out, shared by the runtimes on every thread.
+        static std::atomic<unsigned long> ids;
 
     public:
-        Function(std::string name, ast::Block *body, std::vector<ast::Parameter *> params) : Object(consts::ID_FUNCTION), name(name), body(body), params(params) {}
+        static constexpr unsigned int KIND = consts::ID_FUNCTION;
+        Function(std::string name, ast::Block *body, std::vector<ast::Parameter *> params) : Object(KIND), name(name), body(body), params(params), calls(0), native(nullptr), nativeRejected(false), procedure(nullptr), id(++ids) {}
         ~Function();
         inline ast::Block *getBody() { return body; }
         inline std::vector<ast::Parameter *> &getParams() { return params; }
+        inline std::string &getName() { return name; }
+        /// @brief number unique to this function, unlike its address it is never reused by another one.
+        inline unsigned long getId() const { return id; }
+        /// @brief count a call made through the interpreter.
+        /// @return number of calls so far.
+        inline unsigned int hit() { return ++calls; }
+        /// @brief get the machine code for this function, nullptr if it has not been compiled.
+        inline native::NativeFunction *getNative() const { return native; }
+        inline void setNative(native::NativeFunction *code) { native = code; }
+        /// @brief has the native compiler given up on this function.
+        inline bool isNativeRejected() const { return nativeRejected; }
+        inline void rejectNative() { nativeRejected = true; }
+        /// @brief get the lowered body used by the closure engine, nullptr for functions declared by the interpreter.
+        inline closure::Procedure *getProcedure() const { return procedure; }
+        inline void setProcedure(closure::Procedure *code) { procedure = code; }
 
         void print(std::ostream &where) const override;
     };
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+#include "../Object.hpp"
+#include "../Consts.hpp"
+
+namespace jit
+{
+    /// @brief an integer too wide to be stored inline in a Value, it is a number like any other.
+    class Integer : public Object
+    {
+    private:
+        int64_t value;
+
+    public:
+        static constexpr unsigned int KIND = consts::ID_INTEGER;
+        Integer(int64_t value) : Object(KIND), value(value) {}
+        inline int64_t getValue() const { return value; }
+        void print(std::ostream &where) const override { where << value; }
+    };
+} // namespace jit
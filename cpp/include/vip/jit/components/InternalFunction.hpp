@@ -1,20 +1,74 @@
 #pragma once
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
+#include <functional>
 #include "../Object.hpp"
+#include "../Value.hpp"
 #include "../Consts.hpp"
 namespace jit
 {
     typedef std::shared_ptr<Object> (*CallbackFunction)(std::vector<std::shared_ptr<Object>>);
+
+    /// @brief The arguments of a host call, a view over the values the caller evaluated them into.
+    ///
+    /// Nothing is copied and nothing is counted, so the view is only valid during the call. A host
+    /// function that keeps an argument copies the Value, which holds on to it.
+    class Arguments
+    {
+    private:
+        const Value *values;
+        std::size_t count;
+
+    public:
+        Arguments(const Value *values, std::size_t count) : values(values), count(count) {}
+
+        inline std::size_t size() const { return count; }
+        inline bool empty() const { return count == 0; }
+        inline const Value &operator[](std::size_t index) const { return values[index]; }
+        inline const Value *begin() const { return values; }
+        inline const Value *end() const { return values + count; }
+    };
+
+    /// @brief a host function, the state it needs is captured by the closure instead of kept in globals.
+    typedef std::function<Value(Arguments args)> HostFunction;
+    /// @brief a callback that takes and returns values as the runtime holds them, so calling it boxes nothing.
+    /// It is run as a variadic host function that takes any kind.
+    typedef Value (*ValueFunction)(Arguments args);
+
+    /// @brief what a host function takes. It is checked when the function is registered, and every
+    /// call is checked against it before the host function runs, so the host can rely on it.
+    struct Signature
+    {
+        /// @brief accepts a value of any kind.
+        static constexpr unsigned int ANY = consts::ID_COUNT;
+
+        /// @brief kind of each param as Value::getKind reports it, or ANY.
+        std::vector<unsigned int> params;
+        /// @brief takes any number of arguments after params.
+        bool variadic = false;
+    };
+
     class InternalFunction : public Object
     {
     private:
         std::string name;
         CallbackFunction func;
+        HostFunction host;
+        Signature signature;
+
+        /// @throws std::runtime_error if the arguments do not match the signature.
+        void check(const Value *args, std::size_t count) const;
 
     public:
-        InternalFunction(std::string name, CallbackFunction callback) : Object(consts::ID_INTERNAL_FUNCTION), name(name), func(callback) {}
-        std::shared_ptr<Object> execute(std::vector<std::shared_ptr<Object>> args);
+        static constexpr unsigned int KIND = consts::ID_INTERNAL_FUNCTION;
+        InternalFunction(std::string name, CallbackFunction callback) : Object(KIND), name(name), func(callback) {}
+        InternalFunction(std::string name, ValueFunction callback) : InternalFunction(std::move(name), Signature{{}, true}, callback) {}
+        /// @throws std::runtime_error if a param of the signature is no kind a value can have.
+        InternalFunction(std::string name, Signature signature, HostFunction callback);
+        /// @brief call with count arguments, args only has to stay valid during the call.
+        Value call(const Value *args, std::size_t count);
         void print(std::ostream &where) const override;
     };
 } // namespace jit
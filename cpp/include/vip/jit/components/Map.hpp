@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../Object.hpp"
+#include "../Memory.hpp"
+#include "../Value.hpp"
+#include "../Consts.hpp"
+
+namespace jit
+{
+    /// @brief A `map` from numbers or strings to values.
+    ///
+    /// Open addressing in the style of a Swiss table: every slot has a control byte that is either
+    /// free, a tombstone or 7 bits of the hash of its key. A probe loads the control bytes of a
+    /// group of slots at once and only compares the keys whose bits match, so a miss rarely looks
+    /// at a key at all. Strings hash once and keep it, see String::hash.
+    ///
+    /// Number keys are stored exactly as they compare: a whole double is the integer it equals, so
+    /// `m[1]` and `m[1.0]` are the same entry. A map can hold itself and is traced by the collector.
+    class Map : public Object
+    {
+    private:
+        struct Entry
+        {
+            Value key;
+            Value value;
+        };
+
+        /// @brief one byte per slot, see Map::EMPTY and Map::DELETED, the low 7 bits of the hash if it is used.
+        std::vector<int8_t, MemoryAllocator<int8_t>> controls;
+        std::vector<Entry, MemoryAllocator<Entry>> entries;
+        /// @brief slots, 0 or a power of two that is a multiple of consts::MAP_GROUP.
+        std::size_t capacity = 0;
+        std::size_t count = 0;
+        /// @brief entries that can be added before the map has to grow, tombstones use it up too.
+        std::size_t growthLeft = 0;
+
+        /// @brief the key as it is stored and its hash.
+        /// @throws std::runtime_error if key is neither a number nor a string, or NaN.
+        static Value normalize(const Value &key, std::size_t &hash);
+        static bool same(const Value &lhs, const Value &rhs);
+
+        /// @brief slot holding a normalized key, capacity if it has none.
+        std::size_t probe(const Value &key, std::size_t hash) const;
+        /// @brief a free or deleted slot a key of hash can be put in, the map must not be full.
+        std::size_t vacancy(std::size_t hash) const;
+        void rehash(std::size_t slots);
+
+    public:
+        static constexpr unsigned int KIND = consts::ID_MAP;
+        static constexpr int8_t EMPTY = -128;
+        static constexpr int8_t DELETED = -2;
+
+        /// @param expected entries the map can take before it grows.
+        Map(std::size_t expected = 0);
+        Map(const Map &) = delete;
+        Map &operator=(const Map &) = delete;
+
+        inline std::size_t size() const { return count; }
+        /// @brief make room for expected entries, so adding up to that many never rehashes.
+        void reserve(std::size_t expected);
+
+        /// @brief the value of key, nullptr if the map has none.
+        /// @throws std::runtime_error if key can not be a key.
+        Value *find(const Value &key);
+        /// @brief the value of key, added as an empty value if the map has none.
+        /// @throws std::runtime_error if key can not be a key.
+        Value &insert(const Value &key);
+        /// @return was there an entry with key.
+        bool remove(const Value &key);
+
+        void trace(Tracer &tracer) override;
+        std::size_t footprint() const override;
+        void print(std::ostream &where) const override;
+    };
+} // namespace jit
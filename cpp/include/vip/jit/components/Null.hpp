@@ -7,7 +7,8 @@ namespace jit
     class Null : public Object
     {
     public:
-        Null() : Object(consts::ID_NULL) {}
+        static constexpr unsigned int KIND = consts::ID_NULL;
+        Null() : Object(KIND) {}
         void print(std::ostream &where) const override { where << "null"; }
     };
 } // namespace jit
@@ -4,6 +4,7 @@
 
 namespace jit
 {
+    /// @brief a number as the public api hands it out, the runtime keeps numbers inline in a Value.
     class Number : public Object
     {
     private:
@@ -11,9 +12,10 @@ namespace jit
         bool isBool;
 
     public:
-        Number(double value) : Object(consts::ID_NUMBER), value(value), isBool(false) {}
-        Number(bool value) : Object(consts::ID_NUMBER), value(value ? 1 : 0), isBool(true) {}
-        Number() : Object(2), value(0.0) {}
+        static constexpr unsigned int KIND = consts::ID_NUMBER;
+        Number(double value) : Object(KIND), value(value), isBool(false) {}
+        Number(bool value) : Object(KIND), value(value ? 1 : 0), isBool(true) {}
+        Number() : Object(KIND), value(0.0), isBool(false) {}
         inline bool isBoolean() const { return isBool; }
         inline double getValue() const { return value; }
         inline bool asBool() const { return (bool)value; }
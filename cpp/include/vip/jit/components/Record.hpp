@@ -0,0 +1,75 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include "../Object.hpp"
+#include "../Value.hpp"
+#include "../Consts.hpp"
+#include "./Shape.hpp"
+
+namespace jit
+{
+    /// @brief An instance of a struct.
+    ///
+    /// The fields are stored inline, right after the record in the same allocation, in the slots
+    /// of its shape. Reading a field at a site that saw the shape before is a compare of the shape
+    /// id and a load from the slot, see Record::at.
+    class Record : public Object
+    {
+    private:
+        /// @brief number of fields allocated after a record.
+        struct Fields
+        {
+            std::size_t count;
+        };
+
+        /// @brief holds the Shape, so it lives as long as its records.
+        Value shape;
+        unsigned long shapeId;
+        std::size_t count;
+
+        Record(const Value &shape);
+
+        static void *operator new(std::size_t size, Fields fields) { return Memory::allocate(size + fields.count * sizeof(Value)); }
+        static void operator delete(void *pointer, Fields) { Memory::deallocate(pointer); }
+
+        /// @brief the slot of a field of a shape the site has not seen, caching it for the next time.
+        static Value &miss(const Value &value, const std::string &field, unsigned long &cachedShape, std::size_t &cachedSlot);
+
+    public:
+        static constexpr unsigned int KIND = consts::ID_RECORD;
+
+        static void operator delete(void *pointer) { Memory::deallocate(pointer); }
+
+        Record(const Record &) = delete;
+        Record &operator=(const Record &) = delete;
+        ~Record();
+
+        /// @brief a record of a shape with the values of its fields in slot order.
+        /// @throws std::runtime_error if there are not as many values as fields or one has the wrong type.
+        static Value make(const Value &shape, Value *values, std::size_t count);
+
+        /// @brief the slot of a field, found through the shape and slot a site cached.
+        /// @param cachedShape id of the shape the site saw last, updated on a miss.
+        /// @param cachedSlot slot of the field in that shape, updated on a miss.
+        /// @throws std::runtime_error if value is not a record or its struct has no such field.
+        static inline Value &at(const Value &value, const std::string &field, unsigned long &cachedShape, std::size_t &cachedSlot)
+        {
+            if (auto record = cast<Record>(value); record != nullptr && record->shapeId == cachedShape)
+                return record->getFields()[cachedSlot];
+            return miss(value, field, cachedShape, cachedSlot);
+        }
+
+        /// @brief `value.field = rhs` or a compound assignment to a field, the result has to be of the field's type.
+        /// @param op operator index of a compound assignment, operators::OP_UNKNOWN for a plain one.
+        /// @throws std::runtime_error like at, or if the field would hold a value of another type.
+        static const Value &write(const Value &value, const std::string &field, unsigned long &cachedShape, std::size_t &cachedSlot, unsigned int op, const Value &rhs);
+
+        inline const Shape &getShape() const { return *static_cast<const Shape *>(shape.getObject()); }
+        inline Value *getFields() { return reinterpret_cast<Value *>(this + 1); }
+        inline const Value *getFields() const { return reinterpret_cast<const Value *>(this + 1); }
+        inline std::size_t size() const { return count; }
+
+        void trace(Tracer &tracer) override;
+        void print(std::ostream &where) const override;
+    };
+} // namespace jit
@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../../ast/StructDeclaration.hpp"
+#include "../Object.hpp"
+#include "../Value.hpp"
+#include "../Consts.hpp"
+
+namespace jit
+{
+    /// @brief Layout of the records of a struct.
+    ///
+    /// The slot of every field is fixed when the struct is declared, so a site that saw a shape
+    /// before finds a field by comparing the id of the shape, without looking up its name.
+    class Shape : public Object
+    {
+    private:
+        std::string name;
+        std::vector<std::string> fields;
+        /// @brief type each field is declared with, "number", "string", "number[]", "map" or the name of a struct.
+        std::vector<std::string> types;
+        unsigned long id;
+        /// @brief last id handed out, shared by the runtimes on every thread.
+        static std::atomic<unsigned long> ids;
+
+    public:
+        static constexpr unsigned int KIND = consts::ID_SHAPE;
+        /// @brief returned by find for a field the shape does not have.
+        static constexpr std::size_t NO_FIELD = SIZE_MAX;
+
+        /// @throws std::runtime_error if two fields have the same name.
+        Shape(ast::StructDeclaration &declaration);
+        inline const std::string &getName() const { return name; }
+        inline const std::vector<std::string> &getFields() const { return fields; }
+        inline std::size_t size() const { return fields.size(); }
+        /// @brief number unique to this shape, unlike its address it is never reused by another one.
+        inline unsigned long getId() const { return id; }
+        /// @brief slot of a field, NO_FIELD if there is none with that name.
+        std::size_t find(const std::string &field) const;
+        /// @brief can value be stored in a field of slot.
+        bool accepts(std::size_t slot, const Value &value) const;
+        /// @brief does value have a type, "number", "string", "number[]", "map" or the name of a struct, empty values have none.
+        static bool isOfType(const Value &value, const std::string &type);
+
+        void print(std::ostream &where) const override;
+    };
+} // namespace jit
@@ -1,20 +1,94 @@
 #pragma once
+#include <string>
+#include <string_view>
+#include <functional>
+#include <utility>
 #include "../Object.hpp"
+#include "../Value.hpp"
 #include "../Consts.hpp"
 
 namespace jit
 {
+    /// @brief Text of the language, kept as a rope so concatenating does not copy.
+    ///
+    /// A string is flat text, the concatenation of two strings or a slice of a flat string. The
+    /// first read of a concatenation or slice flattens it into the string itself, so reading it
+    /// again costs nothing and the parts it was made of are let go. The hash is computed once, and
+    /// two strings from the same Interner are equal only if they are the same string.
     class String : public Object
     {
+    public:
+        /// @brief text charged to the runtime the string belongs to, like the string itself.
+        using Text = std::basic_string<char, std::char_traits<char>, MemoryAllocator<char>>;
+
     private:
-        std::string value;
+        /// @brief the text, only complete once flat is set.
+        mutable Text value;
+        /// @brief parts of a concatenation, a slice keeps the string it is of in left.
+        mutable Value left;
+        mutable Value right;
+        /// @brief where a slice starts in left.
+        std::size_t offset;
+        std::size_t length;
+        mutable std::size_t hashCode = 0;
+        mutable bool hashed = false;
+        mutable bool flat;
+        /// @brief id of the Interner that keeps this string for its text, 0 if none does. Interned
+        /// strings are never changed.
+        unsigned long internedBy = 0;
+
+        friend class Interner;
+
+        void flatten() const;
+        /// @brief let go of a part, taking a long rope apart without one destructor calling the next.
+        static void dismantle(Value &part);
 
     public:
-        String(std::string value) : Object(consts::ID_STRING), value(value) {}
-        String() : Object(3), value("") {}
-        inline std::string getValue() const { return value; }
+        static constexpr unsigned int KIND = consts::ID_STRING;
+        String(std::string_view value) : Object(KIND), value(value), offset(0), length(this->value.size()), flat(true) {}
+        String(Text value) : Object(KIND), value(std::move(value)), offset(0), length(this->value.size()), flat(true) {}
+        String(const char *value) : String(std::string_view(value)) {}
+        String() : Object(KIND), offset(0), length(0), flat(true) {}
+        /// @brief lhs followed by rhs, both have to hold a String.
+        String(Value lhs, Value rhs);
+        /// @brief length chars of the String base holds from offset on, the range has to be inside it.
+        String(Value base, std::size_t offset, std::size_t length);
+        ~String();
+
+        inline std::size_t size() const { return length; }
+        /// @brief the text, flattening the string on first use.
+        inline const Text &getValue() const
+        {
+            if (!flat)
+                flatten();
+            return value;
+        }
+        /// @brief the text without copying it, a slice is viewed in the string it is of.
+        std::string_view view() const;
+        /// @brief up to count chars from the start of the text, without flattening the string.
+        std::string prefix(std::size_t count) const;
+        /// @brief std::hash<std::string_view> of the text, computed on first use.
+        inline std::size_t hash() const
+        {
+            if (!hashed)
+            {
+                hashCode = std::hash<std::string_view>{}(view());
+                hashed = true;
+            }
+            return hashCode;
+        }
+        inline bool isInterned() const { return internedBy != 0; }
+        /// @brief append in place, only for a string no other value holds.
+        void append(const String &rhs);
+        /// @brief the concatenation of two values holding strings, a rope once it is long enough to be worth it.
+        static Value concat(const Value &lhs, const Value &rhs);
         void print(std::ostream &where) const override;
-        friend String operator+(String &lhs, const String &rhs);
+        void trace(Tracer &tracer) override;
+        std::size_t footprint() const override;
+        friend bool operator<(const String &lhs, const String &rhs);
+        inline friend bool operator>(const String &lhs, const String &rhs) { return rhs < lhs; }
+        inline friend bool operator<=(const String &lhs, const String &rhs) { return !(lhs > rhs); }
+        inline friend bool operator>=(const String &lhs, const String &rhs) { return !(lhs < rhs); }
         friend bool operator==(const String &lhs, const String &rhs);
         inline friend bool operator!=(const String &lhs, const String &rhs) { return !(lhs == rhs); }
     };
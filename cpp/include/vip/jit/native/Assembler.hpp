@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace jit
+{
+    namespace native
+    {
+        enum Reg : uint8_t
+        {
+            RAX = 0,
+            RCX = 1,
+            RDX = 2,
+            RBX = 3,
+            RSP = 4,
+            RBP = 5,
+            RSI = 6,
+            RDI = 7
+        };
+
+        enum Cond : uint8_t
+        {
+            COND_O = 0x0,
+            COND_B = 0x2,
+            COND_AE = 0x3,
+            COND_E = 0x4,
+            COND_NE = 0x5,
+            COND_BE = 0x6,
+            COND_A = 0x7,
+            COND_P = 0xA,
+            COND_NP = 0xB
+        };
+
+        /// @brief A position in the code stream that jumps can target before it is bound.
+        struct Label
+        {
+            int position = -1;
+            std::vector<std::size_t> fixups;
+        };
+
+        /// @brief Minimal x86-64 encoder covering the scalar double subset used by the native tier.
+        class Assembler
+        {
+        private:
+            std::vector<uint8_t> code;
+            void byte(uint8_t value) { code.push_back(value); }
+            void int32(int32_t value);
+            void int64(int64_t value);
+            /// @brief emit a sse instruction of the form PREFIX 0F OP with register operands.
+            void sse(uint8_t prefix, uint8_t op, uint8_t dst, uint8_t src);
+            /// @brief emit a sse instruction of the form PREFIX 0F OP with a [rbp + disp] operand.
+            void sseFrame(uint8_t prefix, uint8_t op, uint8_t reg, int32_t disp);
+
+        public:
+            inline const std::vector<uint8_t> &getCode() const { return code; }
+            inline std::size_t size() const { return code.size(); }
+
+            /// @brief overwrite a previously emitted 32 bit immediate.
+            void patch32(std::size_t at, int32_t value);
+            void bind(Label &label);
+            void jmp(Label &label);
+            void jcc(Cond cond, Label &label);
+            void call(Label &label);
+
+            void push(Reg reg);
+            void pop(Reg reg);
+            void ret();
+            void movRegReg(Reg dst, Reg src);
+            void movImm64(Reg dst, uint64_t value);
+            /// @brief sub reg, imm32
+            /// @return offset of the immediate so it can be patched.
+            std::size_t subImm32(Reg dst, int32_t value);
+            /// @brief cmp rsp, [reg]
+            void cmpRspMem(Reg base);
+            /// @brief call reg
+            void call(Reg reg);
+            /// @brief call [reg]
+            void callMem(Reg reg);
+
+            void storeInt32(int32_t disp, Reg src);
+            void andInt32(Reg dst, int32_t disp);
+            void orInt32(Reg dst, int32_t disp);
+            void testInt32(Reg reg);
+            void setcc(Cond cond, Reg reg);
+            void andByte(Reg dst, Reg src);
+            void orByte(Reg dst, Reg src);
+            void movzxByte(Reg dst, Reg src);
+
+            void movsdLoad(uint8_t xmm, int32_t disp);
+            void movsdStore(int32_t disp, uint8_t xmm);
+            void movsd(uint8_t dst, uint8_t src);
+            void movqFromGp(uint8_t xmm, Reg src);
+            void addsd(uint8_t dst, uint8_t src);
+            void subsd(uint8_t dst, uint8_t src);
+            void mulsd(uint8_t dst, uint8_t src);
+            void divsd(uint8_t dst, uint8_t src);
+            void ucomisd(uint8_t lhs, uint8_t rhs);
+            void xorpd(uint8_t dst, uint8_t src);
+        };
+    } // namespace native
+} // namespace jit
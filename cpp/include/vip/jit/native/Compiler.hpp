@@ -0,0 +1,75 @@
+#pragma once
+#include <csetjmp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <deque>
+#include <set>
+#include "../Context.hpp"
+#include "../Object.hpp"
+
+namespace jit
+{
+    class Function;
+
+    namespace native
+    {
+        /// @brief Per compiler state that generated code reads through an absolute address.
+        struct State
+        {
+            uintptr_t stackLimit = 0;
+            std::jmp_buf *jump = nullptr;
+        };
+
+        /// @brief Machine code for a single vip function using the SysV double calling convention.
+        struct NativeFunction
+        {
+            void *entry = nullptr;
+            std::size_t arity = 0;
+            /// @brief globals the code was specialized against by the id of the function they held,
+            /// checked on every entry from the interpreter.
+            std::vector<std::pair<std::string, unsigned long>> dependencies;
+            /// @brief params and locals of every function reachable from this one.
+            std::set<std::string> locals;
+            /// @brief names of every function reachable from this one.
+            std::set<std::string> callees;
+        };
+
+        /// @brief Baseline compiler that translates numeric vip functions into x86-64 code.
+        ///
+        /// Only functions whose params are all `number` and whose bodies use arithmetic, comparisons,
+        /// `if`, `while`, locals and calls to other such functions are accepted. Anything else is
+        /// rejected at compile time, and runtime conditions the code can not handle (division by zero,
+        /// numbers leaving the exact integer range, falling off the end of the function, stack exhaustion) bail out so the interpreter can rerun
+        /// the call. Compiled functions are pure, so rerunning them is always safe.
+        class Compiler
+        {
+        private:
+            State state;
+            std::deque<NativeFunction> functions;
+            std::vector<std::pair<void *, std::size_t>> pages;
+
+        public:
+            Compiler() = default;
+            Compiler(const Compiler &) = delete;
+            Compiler &operator=(const Compiler &) = delete;
+            ~Compiler();
+            /// @brief Is native code generation supported on this platform.
+            static bool isSupported();
+            /// @brief Compile a function and every function it calls.
+            /// @param fn function to compile
+            /// @param scope context used to resolve the functions it calls
+            /// @return the compiled function or nullptr if the function is not supported.
+            NativeFunction *compile(Function *fn, Context *scope);
+            /// @brief Check that the globals the code was compiled against still resolve the same way.
+            bool canEnter(NativeFunction *fn, Context *scope);
+            /// @brief Run compiled code.
+            /// @param fn function to run
+            /// @param args arguments, one per param
+            /// @param result return value of the function
+            /// @return false if the code bailed out and the call must be interpreted.
+            bool invoke(NativeFunction *fn, const double *args, double &result);
+        };
+    } // namespace native
+} // namespace jit
@@ -1,36 +1,119 @@
 #pragma once
 #include <memory>
 #include <utility>
+#include <array>
 
 #include "../ast/FunctionDeclaration.hpp"
 #include "../ast/ExpressionStatement.hpp"
 #include "../ast/VariableStatement.hpp"
+#include "../ast/BinaryExpression.hpp"
+#include "../ast/CallExpression.hpp"
+#include "../ast/MatchStatement.hpp"
+#include "../ast/ForStatement.hpp"
+#include "../ast/MemberExpression.hpp"
+#include "../ast/IndexExpression.hpp"
 #include "../ast/IfStatement.hpp"
 #include "../ast/Program.hpp"
+#include "../ast/Consts.hpp"
+#include "./components/Function.hpp"
+#include "./native/Compiler.hpp"
 #include "./Context.hpp"
-#include "./Object.hpp"
+#include "./Value.hpp"
+#include "./Heap.hpp"
+#include "./Memory.hpp"
+#include "./Snapshot.hpp"
+#include "./Interner.hpp"
+#include "./Builtins.hpp"
 
 namespace jit
 {
     class Runtime
     {
     private:
+        typedef Value (Runtime::*ExpressionVisitor)(ast::Node *value, Context *context);
+        typedef std::pair<Value, bool> (Runtime::*StatementVisitor)(ast::Node *value, Context *context);
+        /// @brief visitors indexed by ast::consts node kind.
+        static const std::array<ExpressionVisitor, ast::consts::NODE_KIND_COUNT> expressionVisitors;
+        static const std::array<StatementVisitor, ast::consts::NODE_KIND_COUNT> statementVisitors;
+
+        /// @brief a call in tail position, left by a return statement for the loop in invoke to run.
+        struct TailCall
+        {
+            Value fn;
+            std::vector<Value> args;
+        };
+
+        /// @brief first, so it goes last and still sees every object the runtime lets go of.
+        Heap heap;
+        /// @brief what the objects, contexts and programs of the runtime take up, see Memory.
+        Memory memory;
+        /// @brief the string literals of every program the runtime has run.
+        Interner strings;
+        Builtins builtins;
         Context *ctx;
-        void visitVariableStatement(ast::VariableStatement *value, Context *context);
-        std::pair<std::shared_ptr<Object>, bool> visitIfStatement(ast::IfStatement *value, Context *context);
-        void visitFunctionDeclartion(ast::FunctionDeclartion *value, Context *context);
+        /// @brief contexts of the ifs, loops and calls that are running.
+        ContextStack contexts;
+        /// @brief context of the innermost function call.
+        Context *frame;
+        TailCall tailCall;
+        native::Compiler nativeCompiler;
+        unsigned int nativeThreshold;
+        std::pair<Value, bool> visitVariableStatement(ast::Node *value, Context *context);
+        std::pair<Value, bool> visitIfStatement(ast::Node *value, Context *context);
+        std::pair<Value, bool> visitMatchStatement(ast::Node *value, Context *context);
+        std::pair<Value, bool> visitFunctionDeclartion(ast::Node *value, Context *context);
+        std::pair<Value, bool> visitExpressionStatement(ast::Node *value, Context *context);
+        std::pair<Value, bool> visitReturnStatement(ast::Node *value, Context *context);
+        std::pair<Value, bool> visitWhileExpression(ast::Node *value, Context *context);
+        std::pair<Value, bool> visitForStatement(ast::Node *value, Context *context);
+        std::pair<Value, bool> visitStructDeclaration(ast::Node *value, Context *context);
+        /// @brief evaluate a bound or step of a for loop.
+        /// @throws std::runtime_error if it is not a number.
+        Value visitRangeBound(ast::Node *value, Context *context);
+        std::pair<Value, bool> visitIllegalStatement(ast::Node *value, Context *context);
         void visitVariableDeclaration(ast::VariableDeclaration *value, Context *context);
-        std::pair<std::shared_ptr<Object>, bool> visitStatements(std::vector<ast::Node *> &statements, Context *context, bool returnLast = false);
-        std::pair<std::shared_ptr<Object>, bool> visitStatement(ast::Node *statement, Context *context);
-        std::shared_ptr<Object> visitExpression(ast::Node *value, Context *context);
+        std::pair<Value, bool> visitStatements(std::vector<ast::Node *> &statements, Context *context, bool returnLast = false);
+        std::pair<Value, bool> visitStatement(ast::Node *statement, Context *context);
+        Value visitExpression(ast::Node *value, Context *context);
+        Value visitBinaryExpression(ast::Node *value, Context *context);
+        Value visitCallExpression(ast::Node *value, Context *context);
+        Value visitNumericLiteral(ast::Node *value, Context *context);
+        Value visitStringLiteral(ast::Node *value, Context *context);
+        Value visitIdentifier(ast::Node *value, Context *context);
+        Value visitMemberExpression(ast::Node *value, Context *context);
+        Value visitIndexExpression(ast::Node *value, Context *context);
+        Value visitArrayLiteral(ast::Node *value, Context *context);
+        /// @brief `object[index] = rhs` and the compound assignments to an element of an array or map.
+        Value visitIndexAssignment(ast::IndexExpression *target, ast::BinaryExpression *bin, Context *context);
+        Value visitUnknownExpression(ast::Node *value, Context *context);
+        /// @brief value of a name, reading a root slot the identifier cached without a lookup.
+        /// @return the value, the builtin of that name if no context has the name, or an empty value if there is none.
+        Value resolve(ast::Identifier *name, Context *context);
+        /// @brief whether no context has the name call is made by, so its intrinsic may be evaluated in place.
+        bool unbound(ast::CallExpression *call, ast::Identifier *name, Context *context);
+        /// @brief evaluate the arguments of a call to a function that takes arity params.
+        std::vector<Value> visitArguments(ast::CallExpression *call, std::size_t arity, Context *context);
+        /// @brief call a function, running the tail calls it makes in the same native frame.
+        Value invoke(Value fn, std::vector<Value> &values, Context *context);
+        /// @brief run a call as native code when the function is hot enough and the arguments allow it.
+        /// @param result set to the return value of the call.
+        /// @return false if the call has to be interpreted.
+        bool visitNative(Function &fn, std::vector<Value> &args, Context *context, Value &result);
 
     public:
         Runtime();
         Runtime(const Runtime &) = delete;
         Runtime &operator=(const Runtime &) = delete;
         ~Runtime();
-        void declare(std::string key, std::shared_ptr<Object> value);
+        void declare(std::string key, Value value);
         void drop(std::string key);
-        std::shared_ptr<Object> execute(ast::Program &program, bool returnLast = false);
+        /// @brief Set how many interpreted calls a function needs before it is compiled to native code.
+        /// @param calls number of calls, 0 disables the native tier.
+        void setNativeThreshold(unsigned int calls) { nativeThreshold = calls; }
+        Value execute(ast::Program &program, bool returnLast = false);
+        inline Heap &getHeap() { return heap; }
+        inline Memory &getMemory() { return memory; }
+        /// @brief walk what the root context, the contexts that are running and the literals reach.
+        Snapshot snapshot();
     };
 }
@@ -2,28 +2,116 @@
 #include <string>
 #include <memory>
 #include "./jit/runtime.hpp"
+#include "./jit/closure/Engine.hpp"
 #include "./jit/components/InternalFunction.hpp"
+#include "./jit/Marshal.hpp"
 #include "./jit/Object.hpp"
+#include "./jit/Value.hpp"
+#include "./jit/Heap.hpp"
+#include "./jit/Memory.hpp"
+#include "./jit/Snapshot.hpp"
 
 namespace vip
 {
+    /// @brief how JustInTime runs code.
+    enum Engine
+    {
+        /// @brief walk the ast on every execute, hot numeric functions are compiled to native code.
+        ENGINE_INTERPRETER,
+        /// @brief lower the ast once into pre-bound closures and run those.
+        ENGINE_CLOSURE
+    };
+
     class JustInTime
     {
     private:
         jit::Runtime rt;
+        jit::closure::Engine closures;
+        Engine engine;
         bool cliMode;
 
+        /// @brief memory of the engine code runs on.
+        jit::Memory &memory();
+        /// @brief heap of the engine code runs on.
+        jit::Heap &heap();
+        /// @brief make a host function charged to the engine and declare it as a global.
+        template <typename... Args>
+        void declare(const std::string &name, Args &&...args);
+
     public:
         /// @brief Create a runtime wrapper for just in time
         /// @param cliMode should the last statement be printed to std out.
-        JustInTime(bool cliMode) : rt(jit::Runtime()), cliMode(cliMode) {}
-        JustInTime() : rt(jit::Runtime()), cliMode(false) {}
+        /// @param engine how code is executed.
+        JustInTime(bool cliMode, Engine engine = ENGINE_INTERPRETER) : rt(jit::Runtime()), engine(engine), cliMode(cliMode) {}
+        JustInTime() : rt(jit::Runtime()), engine(ENGINE_INTERPRETER), cliMode(false) {}
         /// @brief Register an system level function
         /// @param name name of function
         /// @param callback function to call
         void registerFn(std::string name, jit::CallbackFunction callback);
+        /// @brief Register an system level function that works on values directly, so calls to it box nothing.
+        /// @param name name of function
+        /// @param callback function to call
+        void registerFn(std::string name, jit::ValueFunction callback);
+        /// @brief Register an system level function that reads its arguments in place and may keep host state in its closure.
+        /// @param name name of function
+        /// @param signature what the function takes, every call is checked against it.
+        /// @param callback function to call
+        /// @throws std::runtime_error if the signature names a kind no value has.
+        void registerFn(std::string name, jit::Signature signature, jit::HostFunction callback);
+        /// @brief Register any C++ callable, like double(double, double) or std::string(std::string_view).
+        /// Its params are checked by kind and unpacked without a cast at runtime, see jit::marshal.
+        /// @param name name of function
+        /// @param callback function to call
+        template <typename F, typename = std::enable_if_t<jit::marshal::bindable<F>>>
+        void registerFn(std::string name, F callback)
+        {
+            auto signature = jit::marshal::signature<F>();
+            registerFn(std::move(name), std::move(signature), jit::marshal::bind(std::move(callback)));
+        }
+        /// @brief Remove a function or variable from the global scope
+        /// @param name name of the function
+        void unregisterFn(std::string name);
         /// @brief execute code
         /// @param input the content to execute.
+        /// @return the value of the last statement in cli mode, numbers come back as jit::Number.
         std::shared_ptr<jit::Object> execute(std::string input);
+        /// @brief Free the cycles no code can reach anymore, in both generations.
+        void collectGarbage();
+        /// @brief What the collector has done so far, including its pause times.
+        jit::HeapStats getHeapStats();
+        /// @brief Limit what scripts may allocate, past it execute throws a std::bad_alloc.
+        /// @param bytes most bytes the runtime may use at once, 0 for no limit.
+        void setMemoryLimit(std::size_t bytes);
+        /// @brief Have callback called once the runtime uses bytes, and again after it went below.
+        /// @param bytes usage to report, 0 for none.
+        /// @param callback called with the usage, it must not throw.
+        void setSoftMemoryLimit(std::size_t bytes, std::function<void(std::size_t)> callback);
+        /// @brief Have the runtime allocate through allocator instead of ::operator new, see jit::Memory.
+        /// @param allocator has to outlive everything the runtime allocates with it.
+        /// @throws std::runtime_error if the runtime has allocated already, so before execute or registerFn.
+        void setAllocator(jit::Allocator allocator);
+        /// @brief How much memory the runtime uses now and has used at most.
+        jit::MemoryStats getMemoryStats();
+        /// @brief Walk every object the globals and the running frames keep alive, see jit::Snapshot.
+        jit::Snapshot snapshotHeap();
+        /// @brief Write snapshotHeap as json to a file.
+        /// @throws std::runtime_error if the file can not be written.
+        void writeHeapSnapshot(std::string path);
+    };
+
+    class AheadOfTime
+    {
+    private:
+        std::string buildDir;
+
+    public:
+        /// @brief Create a compiler that builds native executables through the system c compiler.
+        /// @param buildDir directory the generated c sources are written to.
+        AheadOfTime(std::string buildDir) : buildDir(buildDir) {}
+        AheadOfTime() : buildDir("vip_build") {}
+        /// @brief translate code to c and build it into an executable
+        /// @param input the content to compile.
+        /// @param outfile path of the executable
+        void build(std::string input, std::string outfile);
     };
 }
\ No newline at end of file
@@ -0,0 +1,27 @@
+#include <vip/ast/ArrayLiteral.hpp>
+
+namespace ast
+{
+    ArrayLiteral::~ArrayLiteral()
+    {
+        for (auto &&element : elements)
+        {
+            if (element != nullptr)
+                delete element;
+        }
+    }
+
+    // <ArrayLiteral>
+    //     <NumericLiteral value="1"/>
+    // </ArrayLiteral>
+    std::string ArrayLiteral::toString(int padding)
+    {
+        auto tag = std::string("<ArrayLiteral>\n").insert(0, padding, ' ');
+        for (auto &&element : elements)
+        {
+            tag += element->toString(padding + 3);
+        }
+        tag += std::string("</ArrayLiteral>\n").insert(0, padding, ' ');
+        return tag;
+    }
+} // namespace ast
@@ -0,0 +1,36 @@
+#include <vip/ast/ForStatement.hpp>
+
+namespace ast
+{
+    ForStatement::~ForStatement()
+    {
+        delete name;
+        delete from;
+        delete to;
+        if (step != nullptr)
+            delete step;
+        delete body;
+    }
+    std::string ForStatement::toString(int padding)
+    {
+        auto tag = std::string("<ForStatement>\n").insert(0, padding, ' ');
+
+        tag += name->toString(padding + 3);
+        tag += std::string("<From>\n").insert(0, padding + 3, ' ');
+        tag += from->toString(padding + 6);
+        tag += std::string("</From>\n").insert(0, padding + 3, ' ');
+        tag += std::string("<To>\n").insert(0, padding + 3, ' ');
+        tag += to->toString(padding + 6);
+        tag += std::string("</To>\n").insert(0, padding + 3, ' ');
+        if (step != nullptr)
+        {
+            tag += std::string("<Step>\n").insert(0, padding + 3, ' ');
+            tag += step->toString(padding + 6);
+            tag += std::string("</Step>\n").insert(0, padding + 3, ' ');
+        }
+        tag += body->toString(padding + 3);
+        tag += std::string("</ForStatement>\n").insert(0, padding, ' ');
+
+        return tag;
+    }
+} // namespace ast
@@ -0,0 +1,36 @@
+#include <vip/ast/IndexExpression.hpp>
+
+namespace ast
+{
+    IndexExpression::~IndexExpression()
+    {
+        if (object != nullptr)
+            delete object;
+        if (index != nullptr)
+            delete index;
+    }
+
+    // <IndexExpression>
+    //     <Object>
+    //        <Identifier value="values"/>
+    //     </Object>
+    //     <Index>
+    //        <NumericLiteral value="0"/>
+    //     </Index>
+    // </IndexExpression>
+    std::string IndexExpression::toString(int padding)
+    {
+        auto tag = std::string("<IndexExpression>\n").insert(0, padding, ' ');
+
+        tag += std::string("<Object>\n").insert(0, padding + 3, ' ');
+        tag += object->toString(padding + 6);
+        tag += std::string("</Object>\n").insert(0, padding + 3, ' ');
+
+        tag += std::string("<Index>\n").insert(0, padding + 3, ' ');
+        tag += index->toString(padding + 6);
+        tag += std::string("</Index>\n").insert(0, padding + 3, ' ');
+
+        tag += std::string("</IndexExpression>\n").insert(0, padding, ' ');
+        return tag;
+    }
+} // namespace ast
@@ -0,0 +1,148 @@
+#include <vip/ast/MatchStatement.hpp>
+#include <stdexcept>
+#include <cmath>
+
+#include <vip/ast/NumericLiteral.hpp>
+#include <vip/ast/StringLiteral.hpp>
+
+namespace ast
+{
+    namespace
+    {
+        /// @brief largest array a jump table may use.
+        const double MAX_DENSE_SPAN = 4096;
+    }
+
+    bool CaseTable::add(double value, int index)
+    {
+        return numbers.insert({value, index}).second;
+    }
+
+    bool CaseTable::add(const std::string &value, int index)
+    {
+        auto &bucket = strings[std::hash<std::string_view>{}(value)];
+        for (auto &&entry : bucket)
+        {
+            if (entry.first == value)
+                return false;
+        }
+        bucket.push_back({value, index});
+        return true;
+    }
+
+    void CaseTable::seal()
+    {
+        if (numbers.empty())
+            return;
+
+        double low = numbers.begin()->first;
+        double high = low;
+        for (auto &&entry : numbers)
+        {
+            if (entry.first != std::floor(entry.first))
+                return;
+            low = std::min(low, entry.first);
+            high = std::max(high, entry.first);
+        }
+
+        double span = high - low + 1;
+        if (span > MAX_DENSE_SPAN || span > 2 * numbers.size())
+            return;
+
+        base = low;
+        dense.assign((std::size_t)span, NO_CASE);
+        for (auto &&entry : numbers)
+            dense[(std::size_t)(entry.first - low)] = entry.second;
+        numbers.clear();
+    }
+
+    int CaseTable::find(double value) const
+    {
+        if (!dense.empty())
+        {
+            // the range check also keeps nan and fractions that round into range out.
+            double offset = value - base;
+            if (!(offset >= 0 && offset < dense.size()) || offset != std::floor(offset))
+                return NO_CASE;
+            return dense[(std::size_t)offset];
+        }
+
+        auto found = numbers.find(value);
+        return found == numbers.end() ? NO_CASE : found->second;
+    }
+
+    int CaseTable::find(const std::string &value) const
+    {
+        return find(value, std::hash<std::string_view>{}(value));
+    }
+
+    int CaseTable::find(std::string_view value, std::size_t hash) const
+    {
+        auto found = strings.find(hash);
+        if (found == strings.end())
+            return NO_CASE;
+        for (auto &&entry : found->second)
+        {
+            if (entry.first == value)
+                return entry.second;
+        }
+        return NO_CASE;
+    }
+
+    MatchStatement::MatchStatement(Node *expression, std::vector<Node *> values, std::vector<Block *> bodies, Block *otherwise) : Node(0, 0, KIND), expression(expression), values(values), bodies(bodies), otherwise(otherwise)
+    {
+        auto cases = std::make_shared<CaseTable>();
+        for (std::size_t i = 0; i < values.size(); i++)
+        {
+            bool added = false;
+            if (auto number = cast<NumericLiteral>(values[i]); number != nullptr)
+                added = cases->add(number->getValue(), (int)i);
+            else if (auto text = cast<StringLiteral>(values[i]); text != nullptr)
+                added = cases->add(text->getValue(), (int)i);
+            else
+                throw std::logic_error("Expected a number or string as case value");
+
+            if (!added)
+                throw std::logic_error("Duplicate case in match statement");
+        }
+        cases->seal();
+        table = cases;
+    }
+
+    MatchStatement::~MatchStatement()
+    {
+        delete expression;
+        for (auto &&value : values)
+            delete value;
+        for (auto &&body : bodies)
+            delete body;
+        if (otherwise != nullptr)
+            delete otherwise;
+    }
+
+    std::string MatchStatement::toString(int padding)
+    {
+        auto tag = std::string("<MatchStatement>\n").insert(0, padding, ' ');
+        tag += std::string("<Expression>\n").insert(0, padding + 3, ' ');
+        tag += expression->toString(padding + 6);
+        tag += std::string("</Expression>\n").insert(0, padding + 3, ' ');
+
+        for (std::size_t i = 0; i < values.size(); i++)
+        {
+            tag += std::string("<Case>\n").insert(0, padding + 3, ' ');
+            tag += values[i]->toString(padding + 6);
+            tag += bodies[i]->toString(padding + 6);
+            tag += std::string("</Case>\n").insert(0, padding + 3, ' ');
+        }
+
+        if (otherwise != nullptr)
+        {
+            tag += std::string("<ElseStatement>\n").insert(0, padding + 3, ' ');
+            tag += otherwise->toString(padding + 6);
+            tag += std::string("</ElseStatement>\n").insert(0, padding + 3, ' ');
+        }
+
+        tag += std::string("</MatchStatement>\n").insert(0, padding, ' ');
+        return tag;
+    }
+} // namespace ast
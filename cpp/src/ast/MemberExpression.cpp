@@ -0,0 +1,21 @@
+#include <vip/ast/MemberExpression.hpp>
+
+namespace ast
+{
+    MemberExpression::~MemberExpression()
+    {
+        if (object != nullptr)
+            delete object;
+    }
+
+    // <MemberExpression field="x">
+    //     <Identifier value="point"/>
+    // </MemberExpression>
+    std::string MemberExpression::toString(int padding)
+    {
+        auto tag = std::string("<MemberExpression field=\"" + field + "\">\n").insert(0, padding, ' ');
+        tag += object->toString(padding + 3);
+        tag += std::string("</MemberExpression>\n").insert(0, padding, ' ');
+        return tag;
+    }
+} // namespace ast
@@ -4,7 +4,7 @@ namespace ast
 {
     std::string NumericLiteral::toString(int padding)
     {
-        return std::string("<NumericLiteral value=\"" + std::to_string(value) + "\"/>\n").insert(0, padding, ' ');
+        return std::string("<NumericLiteral value=\"" + (exact ? std::to_string(integer) : std::to_string(value)) + "\"/>\n").insert(0, padding, ' ');
     }
 
 }
\ No newline at end of file
@@ -2,6 +2,9 @@
 #include <stdexcept>
 #include <string.h>
 #include <string>
+#include <charconv>
+#include <cstdint>
+#include <utility>
 
 #include <vip/ast/ExpressionStatement.hpp>
 #include <vip/ast/VariableDeclaration.hpp>
@@ -10,6 +13,9 @@
 #include <vip/ast/WhileExpression.hpp>
 #include <vip/ast/CallExpression.hpp>
 #include <vip/ast/NumericLiteral.hpp>
+#include <vip/ast/MemberExpression.hpp>
+#include <vip/ast/IndexExpression.hpp>
+#include <vip/ast/ArrayLiteral.hpp>
 #include <vip/ast/StringLiteral.hpp>
 #include <vip/ast/Identifier.hpp>
 #include <vip/ast/Parameter.hpp>
@@ -26,7 +32,43 @@ namespace ast
         }
         if (value.size() > 2)
             throw std::logic_error("operator should be at most 2 chars in length");
-        return value.at(0) + value.at(1);
+        return consts::pair(value.at(0), value.at(1));
+    }
+
+    /// @brief the intrinsic a call to name is, consts::INTRINSIC_NONE if it is none.
+    unsigned int intrinsic(const std::string &name)
+    {
+        static const std::pair<const char *, unsigned int> intrinsics[] = {
+            {"sqrt", consts::INTRINSIC_SQRT},
+            {"abs", consts::INTRINSIC_ABS},
+            {"floor", consts::INTRINSIC_FLOOR},
+            {"min", consts::INTRINSIC_MIN},
+            {"max", consts::INTRINSIC_MAX},
+            {"len", consts::INTRINSIC_LEN},
+            {"substr", consts::INTRINSIC_SUBSTR},
+            {"charAt", consts::INTRINSIC_CHAR_AT}};
+
+        for (auto &&entry : intrinsics)
+            if (name == entry.first)
+                return entry.second;
+        return consts::INTRINSIC_NONE;
+    }
+
+    /// @brief a literal without a dot that fits 64 bits is an exact integer, anything else a double.
+    NumericLiteral *parseNumber(const std::string &text, bool negative)
+    {
+        int64_t integer;
+        auto end = text.data() + text.size();
+        if (auto result = std::from_chars(text.data(), end, integer); result.ec == std::errc() && result.ptr == end)
+        {
+            // -2^63 has no positive counterpart, so it stays a double like every other overflow.
+            if (!negative)
+                return new NumericLiteral(integer);
+            return new NumericLiteral(-integer);
+        }
+
+        double value = stod(text);
+        return new NumericLiteral(negative ? -value : value);
     }
 
     Parser::Parser(std::deque<tokenizer::Token> *tokens) : tokens(tokens), current(tokenizer::Token())
@@ -99,6 +141,12 @@ namespace ast
             return 3;
         if (value == "while")
             return 4;
+        if (value == "match")
+            return 5;
+        if (value == "for")
+            return 6;
+        if (value == "struct")
+            return 7;
 
         return -1;
     }
@@ -115,19 +163,43 @@ namespace ast
             return -1;
         }
 
+        // punctuation ends an expression, it is never an operator.
+        if (is_any("{}()[],;:"))
+        {
+            return -1;
+        }
+
         unsigned int el = getOperatorValue(current.getValue());
 
         switch (el)
         {
-        case consts::AND:
+        case consts::EQUAL:
+        case consts::SET_PLUS:
+        case consts::SET_MINUS:
+        case consts::SET_MULT:
+        case consts::SET_DIV:
+            return 2;
         case consts::OR:
+            return 4;
+        case consts::AND:
+            return 6;
         case consts::GREATER_THEN_OR_EQUAL:
         case consts::LESS_THEN_OR_EQUAL:
         case consts::GREATER_THEN:
         case consts::EQUAL_EQUAL:
-        case consts::EQUAL:
+        case consts::NOT_EQUAL:
         case consts::LESS_THEN:
             return 10;
+        // bitwise operators bind tighter than comparisons, so `h & 1 == 0` tests the low bit.
+        case consts::BIT_OR:
+            return 11;
+        case consts::BIT_XOR:
+            return 12;
+        case consts::BIT_AND:
+            return 13;
+        case consts::SHIFT_LEFT:
+        case consts::SHIFT_RIGHT:
+            return 15;
         case consts::PLUS:
             return 20;
         case consts::MINUS:
@@ -135,6 +207,7 @@ namespace ast
         case consts::MULT:
             return 40;
         case consts::DIV:
+        case consts::MOD:
             return 50;
         default:
             return -1;
@@ -145,9 +218,9 @@ namespace ast
     {
         if (is(tokenizer::TYPE_NUMBER))
         {
-            double value = stod(current.getValue());
+            auto literal = parseNumber(current.getValue(), false);
             consume();
-            return new NumericLiteral(value);
+            return literal;
         }
         if (is(tokenizer::TYPE_IDENTIFER))
         {
@@ -164,9 +237,53 @@ namespace ast
             return new StringLiteral(value);
         }
 
+        if (is(tokenizer::TYPE_SYMBOL, '['))
+        {
+            consume(); // eat '['
+
+            std::vector<Node *> elements;
+            while (!is(tokenizer::TYPE_SYMBOL, ']'))
+            {
+                if (!elements.empty())
+                {
+                    if (!is(tokenizer::TYPE_SYMBOL, ','))
+                        throw std::logic_error("Expected to find ','");
+                    consume(); // eat ','
+                }
+
+                auto element = ParseExpression();
+                if (element == nullptr)
+                    throw std::logic_error("Expected to find expression");
+                elements.push_back(element);
+            }
+            consume(); // eat ']'
+
+            return new ArrayLiteral(elements);
+        }
+
         return nullptr;
     }
 
+    Identifier *Parser::ParseType()
+    {
+        // IDENTIFER(????) (SYMBOL('[') SYMBOL(']'))?
+        Identifier *type = cast<Identifier>(ParseStatement());
+        if (type == nullptr || !is(tokenizer::TYPE_SYMBOL, '['))
+            return type;
+
+        consume(); // eat '['
+        if (!is(tokenizer::TYPE_SYMBOL, ']'))
+        {
+            delete type;
+            throw std::logic_error("Expected to find ']'");
+        }
+        consume(); // eat ']'
+
+        auto array = new Identifier(type->getValue() + "[]");
+        delete type;
+        return array;
+    }
+
     Node *Parser::BinOpRHS(int experPrec, Node *lhs)
     {
 
@@ -180,7 +297,7 @@ namespace ast
             unsigned int op = getOperatorValue(current.getValue());
             consume();
 
-            auto rhs = ParseStatement();
+            auto rhs = ParseOperand();
             if (rhs == nullptr)
                 return nullptr;
 
@@ -199,11 +316,11 @@ namespace ast
         return nullptr;
     }
 
-    Node *Parser::ParseExpression()
+    Node *Parser::ParseOperand()
     {
         auto lhs = ParseStatement();
 
-        if (auto *name = dynamic_cast<Identifier *>(lhs); name != nullptr && is(tokenizer::TYPE_SYMBOL, '('))
+        if (auto *name = cast<Identifier>(lhs); name != nullptr && is(tokenizer::TYPE_SYMBOL, '('))
         {
             consume(); // eat '('
 
@@ -226,13 +343,50 @@ namespace ast
             }
             consume(); // eat ')'
 
-            lhs = new CallExpression(name, arguments);
+            auto call = new CallExpression(name, arguments);
+            if (auto id = intrinsic(name->getValue()); id != consts::INTRINSIC_NONE)
+            {
+                call->setIntrinsic(id);
+                intrinsics.push_back(call);
+            }
+            lhs = call;
         }
 
+        while (lhs != nullptr && (is(tokenizer::TYPE_SYMBOL, ".") || is(tokenizer::TYPE_SYMBOL, "[")))
+        {
+            if (is(tokenizer::TYPE_SYMBOL, "["))
+            {
+                consume(); // eat '['
+                auto index = ParseExpression();
+                if (index == nullptr)
+                    throw std::logic_error("Expected to find expression");
+                if (!is(tokenizer::TYPE_SYMBOL, ']'))
+                    throw std::logic_error("Expected to find ']'");
+                consume(); // eat ']'
+
+                lhs = new IndexExpression(lhs, index);
+                continue;
+            }
+
+            consume(); // eat '.'
+            if (!is(tokenizer::TYPE_IDENTIFER))
+                throw std::logic_error("Expected to find identifier");
+
+            lhs = new MemberExpression(lhs, current.getValue());
+            consume();
+        }
+
+        return lhs;
+    }
+
+    Node *Parser::ParseExpression()
+    {
+        auto lhs = ParseOperand();
+
         if (lhs == nullptr)
             return nullptr;
 
-        if (is_any("+-*<>/=") || is(tokenizer::TYPE_SYMBOL, "==") || is(tokenizer::TYPE_SYMBOL, ">=") || is(tokenizer::TYPE_SYMBOL, "<=") || is(tokenizer::TYPE_SYMBOL, "!=") || is(tokenizer::TYPE_SYMBOL, "&&") || is(tokenizer::TYPE_SYMBOL, "||"))
+        if (is_any("+-*<>/=%&|^") || is(tokenizer::TYPE_SYMBOL, "==") || is(tokenizer::TYPE_SYMBOL, ">=") || is(tokenizer::TYPE_SYMBOL, "<=") || is(tokenizer::TYPE_SYMBOL, "!=") || is(tokenizer::TYPE_SYMBOL, "&&") || is(tokenizer::TYPE_SYMBOL, "||"))
         {
             lhs = BinOpRHS(0, lhs);
         }
@@ -279,13 +433,161 @@ namespace ast
         return new IfStatement(condition, thenBlock, nullptr);
     }
 
+    MatchStatement *Parser::ParseMatchStatement()
+    {
+        // IDENTIFER(match) SYMBOL('(') expression SYMBOL(')') SYMBOL('{') (IDENTIFER(case) literal block)* (IDENTIFER(else) block)? SYMBOL('}')
+        consume(); // eat 'match'
+        if (!is(tokenizer::TYPE_SYMBOL, '('))
+            throw std::logic_error("Expected to find '('");
+        consume(); // eat '('
+
+        Node *expression = ParseExpression();
+
+        if (!is(tokenizer::TYPE_SYMBOL, ')'))
+            throw std::logic_error("Expected to find ')'");
+        consume(); // eat ')'
+
+        if (!is(tokenizer::TYPE_SYMBOL, '{'))
+            throw std::logic_error("Expected to find '{'");
+        consume(); // eat '{'
+
+        std::vector<Node *> values;
+        std::vector<Block *> bodies;
+        while (is(tokenizer::TYPE_IDENTIFER, "case"))
+        {
+            consume(); // eat 'case'
+
+            bool negative = is(tokenizer::TYPE_SYMBOL, "-");
+            if (negative)
+                consume(); // eat '-'
+
+            if (is(tokenizer::TYPE_NUMBER))
+            {
+                values.push_back(parseNumber(current.getValue(), negative));
+                consume();
+            }
+            else if (!negative && is(tokenizer::TYPE_STRING))
+            {
+                values.push_back(new StringLiteral(current.getValue()));
+                consume();
+            }
+            else
+                throw std::logic_error("Expected to find a number or string");
+
+            std::vector<Node *> body;
+            ParseBlock(body, true);
+            bodies.push_back(new Block(body));
+        }
+
+        Block *otherwise = nullptr;
+        if (is(tokenizer::TYPE_IDENTIFER, "else"))
+        {
+            consume(); // eat 'else'
+
+            std::vector<Node *> body;
+            ParseBlock(body, true);
+            otherwise = new Block(body);
+        }
+
+        if (!is(tokenizer::TYPE_SYMBOL, '}'))
+            throw std::logic_error("Expected to find '}'");
+        consume(); // eat '}'
+
+        return new MatchStatement(expression, values, bodies, otherwise);
+    }
+
+    ForStatement *Parser::ParseForStatement()
+    {
+        // IDENTIFER(for) IDENTIFER(????) IDENTIFER(in) expression SYMBOL(..) expression (IDENTIFER(step) expression)? block
+        consume(); // eat 'for'
+        Identifier *name = cast<Identifier>(ParseStatement());
+        if (name == nullptr)
+            throw std::logic_error("Expected to find identifier");
+        declared.insert(name->getValue());
+
+        if (!is(tokenizer::TYPE_IDENTIFER, "in"))
+            throw std::logic_error("Expected to find 'in'");
+        consume(); // eat 'in'
+
+        Node *from = ParseExpression();
+        if (from == nullptr)
+            throw std::logic_error("Expected to find expression");
+
+        if (!is(tokenizer::TYPE_SYMBOL, ".."))
+            throw std::logic_error("Expected to find '..'");
+        consume(); // eat '..'
+
+        Node *to = ParseExpression();
+        if (to == nullptr)
+            throw std::logic_error("Expected to find expression");
+
+        Node *step = nullptr;
+        if (is(tokenizer::TYPE_IDENTIFER, "step"))
+        {
+            consume(); // eat 'step'
+            step = ParseExpression();
+            if (step == nullptr)
+                throw std::logic_error("Expected to find expression");
+        }
+
+        std::vector<Node *> body;
+        ParseBlock(body, true);
+
+        return new ForStatement(name, from, to, step, new Block(body));
+    }
+
+    StructDeclaration *Parser::ParseStructDeclaration()
+    {
+        // IDENTIFER(struct) IDENTIFER(????) SYMBOL('{') (IDENTIFER(????) SYMBOL(:) IDENTIFER(????))(,+) SYMBOL('}')
+        consume(); // eat 'struct'
+        Identifier *name = cast<Identifier>(ParseStatement());
+        if (name == nullptr)
+            throw std::logic_error("Expected to find identifier");
+        declared.insert(name->getValue());
+
+        if (!is(tokenizer::TYPE_SYMBOL, '{'))
+            throw std::logic_error("Expected to find '{'");
+        consume(); // eat '{'
+
+        std::vector<Parameter *> fields;
+        bool first = true;
+        while (!is(tokenizer::TYPE_SYMBOL, '}'))
+        {
+            if (!first)
+            {
+                if (!is(tokenizer::TYPE_SYMBOL, ','))
+                    throw std::logic_error("Expected to find ','");
+                consume(); // eat ','
+            }
+            first = false;
+
+            Identifier *field = cast<Identifier>(ParseStatement());
+            if (field == nullptr)
+                throw std::logic_error("Expected to find identifier");
+
+            if (!is(tokenizer::TYPE_SYMBOL, ':'))
+                throw std::logic_error("Expected to find ':'");
+            consume(); // eat ':'
+
+            Identifier *type = ParseType();
+            if (type == nullptr)
+                throw std::logic_error("Expected to find identifier");
+
+            fields.push_back(new Parameter(field, type));
+        }
+        consume(); // eat '}'
+
+        return new StructDeclaration(name, fields);
+    }
+
     FunctionDeclartion *Parser::ParseFunctionDeclartion()
     {
         // IDENTIFER(fn) IDENTIFER(????) SYMBOL('(') arguments SYMBOL(')') block
         consume(); // eat 'fn'
-        Identifier *name = dynamic_cast<Identifier *>(ParseStatement());
+        Identifier *name = cast<Identifier>(ParseStatement());
         if (name == nullptr)
             throw std::logic_error("Expected to find identifier;");
+        declared.insert(name->getValue());
 
         std::vector<Parameter *> parameters;
         if (!is(tokenizer::TYPE_SYMBOL, '('))
@@ -303,7 +605,7 @@ namespace ast
             }
             first = false;
 
-            Identifier *param = dynamic_cast<Identifier *>(ParseStatement());
+            Identifier *param = cast<Identifier>(ParseStatement());
             if (param == nullptr)
                 throw std::logic_error("Expected to find identifier");
 
@@ -312,10 +614,11 @@ namespace ast
             consume(); // eat ':'
 
             // parse typedata
-            Identifier *typedata = dynamic_cast<Identifier *>(ParseStatement());
+            Identifier *typedata = ParseType();
             if (typedata == nullptr)
                 throw std::logic_error("Expected to find identifier");
 
+            declared.insert(param->getValue());
             parameters.push_back(new Parameter(param, typedata));
             // parse function arguments
         }
@@ -348,16 +651,17 @@ namespace ast
                 consume(); // eat ','
             }
 
-            Identifier *d = dynamic_cast<Identifier *>(ParseStatement());
+            Identifier *d = cast<Identifier>(ParseStatement());
             if (d == nullptr)
             {
                 throw std::logic_error("Expected to find identifier");
             }
+            declared.insert(d->getValue());
 
             if (!is(tokenizer::TYPE_SYMBOL, ':'))
                 throw std::logic_error("Expected to find ':'");
             consume(); // eat ':'
-            Identifier *td = dynamic_cast<Identifier *>(ParseStatement());
+            Identifier *td = ParseType();
 
             if (!is(tokenizer::TYPE_SYMBOL, '='))
             {
@@ -450,6 +754,21 @@ namespace ast
                     statements.push_back(new WhileExpression(statement, block));
                     break;
                 }
+                case 5:
+                {
+                    statements.push_back(ParseMatchStatement());
+                    break;
+                }
+                case 6:
+                {
+                    statements.push_back(ParseForStatement());
+                    break;
+                }
+                case 7:
+                {
+                    statements.push_back(ParseStructDeclaration());
+                    break;
+                }
                 default:
                     throw std::logic_error("Unknown keyword");
                 }
@@ -490,6 +809,12 @@ namespace ast
             program.setStatements(statments);
         };
 
+        // a declaration anywhere in the program, even after the call, may be what the call reaches.
+        for (auto &&call : intrinsics)
+            if (declared.count(static_cast<Identifier *>(call->getExpression())->getValue()) != 0)
+                call->setIntrinsic(consts::INTRINSIC_NONE);
+        intrinsics.clear();
+
         return program;
     }
 }
\ No newline at end of file
@@ -0,0 +1,43 @@
+#include <vip/ast/StructDeclaration.hpp>
+
+namespace ast
+{
+    StructDeclaration::~StructDeclaration()
+    {
+        if (name != nullptr)
+            delete name;
+
+        for (auto &&field : fields)
+        {
+            if (field != nullptr)
+                delete field;
+        }
+    }
+
+    // <StructDeclaration>
+    //     <Name>
+    //        <Identifier value="Point"/>
+    //     </Name>
+    //     <Fields>
+    //        <Parameter type="number" name="x"/>
+    //     </Fields>
+    // </StructDeclaration>
+    std::string StructDeclaration::toString(int padding)
+    {
+        auto tag = std::string("<StructDeclaration>\n").insert(0, padding, ' ');
+
+        tag += std::string("<Name>\n").insert(0, padding + 3, ' ');
+        tag += name->toString(padding + 7);
+        tag += std::string("</Name>\n").insert(0, padding + 3, ' ');
+
+        tag += std::string("<Fields>\n").insert(0, padding + 3, ' ');
+        for (auto &&field : fields)
+        {
+            tag += field->toString(padding + 7);
+        }
+        tag += std::string("</Fields>\n").insert(0, padding + 3, ' ');
+
+        tag += std::string("</StructDeclaration>\n").insert(0, padding, ' ');
+        return tag;
+    }
+} // namespace ast
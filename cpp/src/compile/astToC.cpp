@@ -0,0 +1,1294 @@
+#include "./compiler.hpp"
+#include <stdexcept>
+#include <cstdio>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <deque>
+#include <tuple>
+#include <map>
+#include <set>
+
+#include <vip/ast/FunctionDeclaration.hpp>
+#include <vip/ast/ExpressionStatement.hpp>
+#include <vip/ast/VariableStatement.hpp>
+#include <vip/ast/BinaryExpression.hpp>
+#include <vip/ast/ReturnStatement.hpp>
+#include <vip/ast/WhileExpression.hpp>
+#include <vip/ast/CallExpression.hpp>
+#include <vip/ast/NumericLiteral.hpp>
+#include <vip/ast/MatchStatement.hpp>
+#include <vip/ast/ForStatement.hpp>
+#include <vip/ast/StringLiteral.hpp>
+#include <vip/ast/IfStatement.hpp>
+#include <vip/ast/Identifier.hpp>
+#include <vip/ast/Consts.hpp>
+
+// Programs are lowered to c99 that links the runtime in runtime.cpp.
+//
+// Variables declared as `number` become plain doubles as long as every value stored in them
+// is a number, and so do params and return values once type inference has proven the same
+// for every call site and return statement. Everything else is a boxed vip_value.
+//
+// Names are resolved lexically: a function sees its own params and locals and the top level
+// variables of the program, while the interpreter also lets it see the locals of its caller.
+// A program where that makes a difference, because a function reads a top level name that a
+// function calling it binds as a local, is rejected instead of compiled to something else.
+//
+// The interpreter keeps integers exact up to 64 bits, doubles only up to 2^53. Integer literals
+// past that are rejected, and arithmetic on whole numbers that leaves the range fails at runtime
+// instead of printing a rounded result.
+namespace compile
+{
+    namespace
+    {
+        const int64_t EXACT_LIMIT = 1ll << 53;
+
+        enum Type
+        {
+            TYPE_NUMBER,
+            TYPE_BOOL,
+            TYPE_DYNAMIC
+        };
+
+        struct Variable
+        {
+            std::string cname;
+            bool number;
+        };
+
+        struct Fn
+        {
+            ast::FunctionDeclartion *decl;
+            std::string cname;
+            bool numberReturn;
+            std::vector<Variable *> params;
+        };
+
+        struct Operand
+        {
+            std::string code;
+            Type type;
+        };
+
+        std::string mangle(const std::string &name)
+        {
+            static const char *hex = "0123456789ABCDEF";
+            std::string result;
+            for (unsigned char c : name)
+            {
+                if (isalnum(c))
+                {
+                    result.push_back((char)c);
+                    continue;
+                }
+                result.push_back('_');
+                result.push_back(hex[c >> 4]);
+                result.push_back(hex[c & 15]);
+            }
+            return result;
+        }
+
+        std::string literal(double value)
+        {
+            char buffer[64];
+            snprintf(buffer, sizeof(buffer), "%.17g", value);
+            std::string result(buffer);
+            if (result.find_first_of(".eni") == std::string::npos)
+                result += ".0";
+            return result;
+        }
+
+        /// @brief the value of a literal, compiled numbers are doubles so larger integers would be rounded.
+        double numeric(ast::NumericLiteral *node)
+        {
+            if (node->isInteger() && (node->getInteger() > EXACT_LIMIT || node->getInteger() < -EXACT_LIMIT))
+                throw std::runtime_error("Integers past 2^53 are not supported by the compiler.");
+            return node->getValue();
+        }
+
+        std::string quote(const std::string &value)
+        {
+            std::string result = "\"";
+            for (unsigned char c : value)
+            {
+                if (c == '\\' || c == '"')
+                {
+                    result.push_back('\\');
+                    result.push_back((char)c);
+                }
+                else if (c < 0x20 || c >= 0x7f)
+                {
+                    char buffer[8];
+                    snprintf(buffer, sizeof(buffer), "\\%03o", c);
+                    result += buffer;
+                }
+                else
+                {
+                    result.push_back((char)c);
+                }
+            }
+            return result + "\"";
+        }
+
+        bool isNumeric(Type type)
+        {
+            return type != TYPE_DYNAMIC;
+        }
+
+        /// @brief the operator a compound assignment applies, like PLUS for +=, or 0 if op is not one.
+        unsigned int compound(unsigned int op)
+        {
+            switch (op)
+            {
+            case ast::consts::SET_PLUS:
+                return ast::consts::PLUS;
+            case ast::consts::SET_MINUS:
+                return ast::consts::MINUS;
+            case ast::consts::SET_MULT:
+                return ast::consts::MULT;
+            case ast::consts::SET_DIV:
+                return ast::consts::DIV;
+            default:
+                return 0;
+            }
+        }
+
+        bool definitelyReturns(std::vector<ast::Node *> &statements)
+        {
+            for (auto &&statement : statements)
+            {
+                if (statement->getKind() == ast::consts::RETURN_STATEMENT)
+                    return true;
+
+                if (statement->getKind() == ast::consts::IF_STATEMENT)
+                {
+                    auto value = static_cast<ast::IfStatement *>(statement);
+                    std::vector<ast::Node *> elseBranch;
+                    if (value->getElse() == nullptr)
+                        continue;
+                    if (value->getElse()->getKind() == ast::consts::BLOCK_EXPRESSION)
+                        elseBranch = static_cast<ast::Block *>(value->getElse())->getStatements();
+                    else
+                        elseBranch.push_back(value->getElse());
+
+                    if (definitelyReturns(value->getThen()->getStatements()) && definitelyReturns(elseBranch))
+                        return true;
+                }
+
+                if (statement->getKind() == ast::consts::MATCH_STATEMENT)
+                {
+                    auto value = static_cast<ast::MatchStatement *>(statement);
+                    if (value->getElse() == nullptr || !definitelyReturns(value->getElse()->getStatements()))
+                        continue;
+
+                    auto &bodies = value->getBodies();
+                    if (std::all_of(bodies.begin(), bodies.end(), [](ast::Block *body)
+                                    { return definitelyReturns(body->getStatements()); }))
+                        return true;
+                }
+            }
+            return false;
+        }
+
+        class Translator
+        {
+        private:
+            ast::Program &program;
+            std::map<const ast::Node *, Variable> variables;
+            std::map<std::string, Variable *> globals;
+            std::map<std::string, Fn> functions;
+            std::vector<std::map<std::string, Variable *>> scopes;
+            std::vector<std::string> literals;
+            Fn *current = nullptr;
+            bool changed = false;
+            /// @brief per function, nullptr for the top level: the names it binds as locals, the
+            /// top level names it reads and the functions it calls, see checkScoping.
+            std::map<const Fn *, std::set<std::string>> locals;
+            std::map<const Fn *, std::set<std::string>> reads;
+            std::map<const Fn *, std::set<const Fn *>> calls;
+            int names = 0;
+
+            std::string out;
+            int indent = 0;
+            int temps = 0;
+            std::vector<std::string> owned;
+
+            void demote(bool &number)
+            {
+                if (number)
+                {
+                    number = false;
+                    changed = true;
+                }
+            }
+
+            Variable *create(const ast::Node *node, const std::string &name, bool number, bool global)
+            {
+                auto found = variables.find(node);
+                if (found != variables.end())
+                    return &found->second;
+
+                auto cname = global ? "vipg_" + mangle(name) : "v_" + mangle(name) + "_" + std::to_string(names++);
+                return &variables.emplace(node, Variable{cname, number}).first->second;
+            }
+
+            bool isTopLevel() const { return current == nullptr && scopes.empty(); }
+
+            /// @brief bring a declaration into scope.
+            /// @return the variable or nullptr if the name already exists and the declaration only evaluates its initializer.
+            Variable *declare(ast::VariableDeclaration *decl)
+            {
+                auto &name = decl->getName()->getValue();
+                if (isTopLevel())
+                {
+                    auto var = create(decl, name, false, true);
+                    return globals[name] == var ? var : nullptr;
+                }
+
+                auto &scope = scopes.back();
+                if (scope.find(name) != scope.end())
+                    return nullptr;
+
+                bool number = decl->getType() != nullptr && decl->getType()->getValue() == "number";
+                auto var = create(decl, name, number, false);
+                scope[name] = var;
+                locals[current].insert(name);
+                return var;
+            }
+
+            Variable *lookup(const std::string &name)
+            {
+                for (auto it = scopes.rbegin(); it != scopes.rend(); it++)
+                {
+                    if (auto found = it->find(name); found != it->end())
+                        return found->second;
+                }
+                if (auto found = globals.find(name); found != globals.end())
+                {
+                    if (current != nullptr)
+                        reads[current].insert(name);
+                    return found->second;
+                }
+                return nullptr;
+            }
+
+            Fn &callee(ast::CallExpression *call)
+            {
+                auto name = ast::cast<ast::Identifier>(call->getExpression());
+                if (name == nullptr)
+                    throw std::runtime_error("Expected a function name.");
+                auto found = functions.find(name->getValue());
+                if (found == functions.end())
+                    throw std::runtime_error("No function with give name exists: " + name->getValue());
+                if (found->second.params.size() != call->getArguments().size())
+                    throw std::runtime_error("Given params does not function sig.");
+                calls[current].insert(&found->second);
+                if (current != nullptr)
+                    reads[current].insert(name->getValue());
+                return found->second;
+            }
+
+            static bool isPrintln(ast::CallExpression *call)
+            {
+                auto name = ast::cast<ast::Identifier>(call->getExpression());
+                return name != nullptr && name->getValue() == "println";
+            }
+
+            Type typeOf(ast::Node *node)
+            {
+                switch (node->getKind())
+                {
+                case ast::consts::NUMBERIC_LITERAL:
+                    return TYPE_NUMBER;
+                case ast::consts::STRING_LITERAL:
+                    return TYPE_DYNAMIC;
+                case ast::consts::IDENTIFIER:
+                {
+                    auto &name = static_cast<ast::Identifier *>(node)->getValue();
+                    if (auto var = lookup(name); var != nullptr)
+                        return var->number ? TYPE_NUMBER : TYPE_DYNAMIC;
+                    if (name == "true" || name == "false")
+                        return TYPE_BOOL;
+                    throw std::runtime_error("No variable exsists: " + name);
+                }
+                case ast::consts::CALL_EXPRESSION:
+                {
+                    auto call = static_cast<ast::CallExpression *>(node);
+                    if (isPrintln(call))
+                        return TYPE_DYNAMIC;
+                    return callee(call).numberReturn ? TYPE_NUMBER : TYPE_DYNAMIC;
+                }
+                case ast::consts::BINARY_EXPRESSION:
+                {
+                    auto bin = static_cast<ast::BinaryExpression *>(node);
+                    switch (bin->getOp())
+                    {
+                    case ast::consts::EQUAL:
+                        return typeOf(bin->getRhs());
+                    case ast::consts::SET_PLUS:
+                    case ast::consts::SET_MINUS:
+                    case ast::consts::SET_MULT:
+                    case ast::consts::SET_DIV:
+                    case ast::consts::PLUS:
+                    case ast::consts::MINUS:
+                    case ast::consts::MULT:
+                    case ast::consts::DIV:
+                    case ast::consts::MOD:
+                    case ast::consts::BIT_AND:
+                    case ast::consts::BIT_OR:
+                    case ast::consts::BIT_XOR:
+                    case ast::consts::SHIFT_LEFT:
+                    case ast::consts::SHIFT_RIGHT:
+                        return isNumeric(typeOf(bin->getLhs())) && isNumeric(typeOf(bin->getRhs())) ? TYPE_NUMBER : TYPE_DYNAMIC;
+                    case ast::consts::LESS_THEN:
+                    case ast::consts::GREATER_THEN:
+                    case ast::consts::LESS_THEN_OR_EQUAL:
+                    case ast::consts::GREATER_THEN_OR_EQUAL:
+                    case ast::consts::EQUAL_EQUAL:
+                    case ast::consts::NOT_EQUAL:
+                        return isNumeric(typeOf(bin->getLhs())) && isNumeric(typeOf(bin->getRhs())) ? TYPE_BOOL : TYPE_DYNAMIC;
+                    case ast::consts::AND:
+                    case ast::consts::OR:
+                        // anything but a number on either side fails at runtime, so the result is always a bool.
+                        typeOf(bin->getLhs());
+                        typeOf(bin->getRhs());
+                        return TYPE_BOOL;
+                    default:
+                        throw std::runtime_error("Unknown operation");
+                    }
+                }
+                case ast::consts::MEMBER_EXPRESSION:
+                    throw std::runtime_error("Structs are not supported by the compiler.");
+                case ast::consts::INDEX_EXPRESSION:
+                case ast::consts::ARRAY_LITERAL:
+                    throw std::runtime_error("Arrays are not supported by the compiler.");
+                default:
+                    throw std::runtime_error("Unknown expression.");
+                }
+            }
+
+            // ---- type inference ----
+
+            void inferExpression(ast::Node *node)
+            {
+                typeOf(node);
+                if (node->getKind() == ast::consts::BINARY_EXPRESSION)
+                {
+                    auto bin = static_cast<ast::BinaryExpression *>(node);
+                    if (bin->getOp() == ast::consts::EQUAL || compound(bin->getOp()) != 0)
+                    {
+                        auto ident = ast::cast<ast::Identifier>(bin->getLhs());
+                        if (ident == nullptr)
+                            throw std::runtime_error("Can not assign to value.");
+                        auto var = lookup(ident->getValue());
+                        if (var == nullptr)
+                            throw std::runtime_error("No variable exsists: " + ident->getValue());
+
+                        inferExpression(bin->getRhs());
+                        if (typeOf(bin->getOp() == ast::consts::EQUAL ? bin->getRhs() : bin) != TYPE_NUMBER)
+                            demote(var->number);
+                        return;
+                    }
+                    inferExpression(bin->getLhs());
+                    inferExpression(bin->getRhs());
+                    return;
+                }
+
+                if (node->getKind() == ast::consts::CALL_EXPRESSION)
+                {
+                    auto call = static_cast<ast::CallExpression *>(node);
+                    auto &args = call->getArguments();
+                    for (auto &&arg : args)
+                        inferExpression(arg);
+                    if (isPrintln(call))
+                        return;
+
+                    auto &fn = callee(call);
+                    for (std::size_t i = 0; i < args.size(); i++)
+                    {
+                        if (typeOf(args[i]) != TYPE_NUMBER)
+                            demote(fn.params[i]->number);
+                    }
+                }
+            }
+
+            void inferBlock(std::vector<ast::Node *> &statements)
+            {
+                scopes.emplace_back();
+                for (auto &&statement : statements)
+                    inferStatement(statement);
+                scopes.pop_back();
+            }
+
+            void inferFunction(Fn &fn)
+            {
+                auto saved = scopes;
+                scopes.clear();
+                scopes.emplace_back();
+                auto params = fn.decl->getParameters();
+                for (std::size_t i = 0; i < params.size(); i++)
+                {
+                    scopes.back()[params[i]->getName()->getValue()] = fn.params[i];
+                    locals[&fn].insert(params[i]->getName()->getValue());
+                }
+
+                current = &fn;
+                for (auto &&statement : fn.decl->getBody())
+                    inferStatement(statement);
+                current = nullptr;
+                scopes = saved;
+            }
+
+            void inferStatement(ast::Node *statement)
+            {
+                switch (statement->getKind())
+                {
+                case ast::consts::VARIABLE_STATEMENT:
+                {
+                    for (auto &&decl : static_cast<ast::VariableStatement *>(statement)->getDeclarations())
+                    {
+                        auto init = decl->getInitalizer();
+                        Type type = TYPE_NUMBER;
+                        if (init != nullptr)
+                        {
+                            inferExpression(init);
+                            type = typeOf(init);
+                        }
+                        if (auto var = declare(decl); var != nullptr && type != TYPE_NUMBER)
+                            demote(var->number);
+                    }
+                    return;
+                }
+                case ast::consts::EXPRESSION_STATEMENT:
+                    inferExpression(static_cast<ast::ExpressionStatement *>(statement)->getExpression());
+                    return;
+                case ast::consts::RETURN_STATEMENT:
+                {
+                    if (current == nullptr)
+                        throw std::runtime_error("Uncaught SyntaxError: Illegal return statement");
+                    auto expr = static_cast<ast::ReturnStatement *>(statement)->getExpression();
+                    inferExpression(expr);
+                    if (typeOf(expr) != TYPE_NUMBER)
+                        demote(current->numberReturn);
+                    return;
+                }
+                case ast::consts::IF_STATEMENT:
+                {
+                    auto value = static_cast<ast::IfStatement *>(statement);
+                    inferExpression(value->getExpression());
+                    inferBlock(value->getThen()->getStatements());
+                    if (auto elseBlock = value->getElse(); elseBlock != nullptr)
+                    {
+                        if (elseBlock->getKind() == ast::consts::BLOCK_EXPRESSION)
+                            inferBlock(static_cast<ast::Block *>(elseBlock)->getStatements());
+                        else
+                            inferStatement(elseBlock);
+                    }
+                    return;
+                }
+                case ast::consts::FOR_STATEMENT:
+                {
+                    auto loop = static_cast<ast::ForStatement *>(statement);
+                    inferExpression(loop->getFrom());
+                    inferExpression(loop->getTo());
+                    if (loop->getStep() != nullptr)
+                        inferExpression(loop->getStep());
+
+                    auto &name = loop->getName()->getValue();
+                    scopes.emplace_back();
+                    scopes.back()[name] = create(loop, name, true, false);
+                    locals[current].insert(name);
+                    inferBlock(loop->getBody()->getStatements());
+                    scopes.pop_back();
+                    return;
+                }
+                case ast::consts::MATCH_STATEMENT:
+                {
+                    auto value = static_cast<ast::MatchStatement *>(statement);
+                    inferExpression(value->getExpression());
+                    for (auto &&body : value->getBodies())
+                        inferBlock(body->getStatements());
+                    if (value->getElse() != nullptr)
+                        inferBlock(value->getElse()->getStatements());
+                    return;
+                }
+                case ast::consts::WHILE_EXRESSION:
+                {
+                    auto loop = static_cast<ast::WhileExpression *>(statement);
+                    inferExpression(loop->getExpression());
+                    inferBlock(loop->getBody()->getStatements());
+                    return;
+                }
+                case ast::consts::FUNCTION_EXPRESSION:
+                {
+                    if (!isTopLevel())
+                        throw std::runtime_error("Nested functions are not supported by the compiler.");
+                    inferFunction(functions.at(static_cast<ast::FunctionDeclartion *>(statement)->getName()));
+                    return;
+                }
+                case ast::consts::STRUCT_DECLARATION:
+                    throw std::runtime_error("Structs are not supported by the compiler.");
+                default:
+                    throw std::runtime_error("Uncaught SyntaxError: Illegal statement");
+                }
+            }
+
+            // ---- code generation ----
+
+            void line(const std::string &text)
+            {
+                out += std::string(indent * 4, ' ') + text + "\n";
+            }
+            std::string temp()
+            {
+                return "t" + std::to_string(temps++);
+            }
+            void open()
+            {
+                line("{");
+                indent++;
+            }
+            void close()
+            {
+                for (auto &&name : owned)
+                    line("vip_release(" + name + ");");
+                owned.clear();
+                indent--;
+                line("}");
+            }
+
+            static std::string box(const Operand &op)
+            {
+                switch (op.type)
+                {
+                case TYPE_NUMBER:
+                    return "vip_number(" + op.code + ")";
+                case TYPE_BOOL:
+                    return "vip_bool(" + op.code + ")";
+                default:
+                    return op.code;
+                }
+            }
+            static std::string truthy(const Operand &op)
+            {
+                switch (op.type)
+                {
+                case TYPE_NUMBER:
+                    return "(" + op.code + " != 0)";
+                case TYPE_BOOL:
+                    return op.code;
+                default:
+                    return "vip_truthy(" + op.code + ")";
+                }
+            }
+            static std::string runtimeOp(unsigned int op)
+            {
+                switch (op)
+                {
+                case ast::consts::PLUS:
+                    return "VIP_ADD";
+                case ast::consts::MINUS:
+                    return "VIP_SUB";
+                case ast::consts::MULT:
+                    return "VIP_MUL";
+                case ast::consts::DIV:
+                    return "VIP_DIV";
+                case ast::consts::LESS_THEN:
+                    return "VIP_LT";
+                case ast::consts::GREATER_THEN:
+                    return "VIP_GT";
+                case ast::consts::LESS_THEN_OR_EQUAL:
+                    return "VIP_LE";
+                case ast::consts::GREATER_THEN_OR_EQUAL:
+                    return "VIP_GE";
+                case ast::consts::EQUAL_EQUAL:
+                    return "VIP_EQ";
+                case ast::consts::NOT_EQUAL:
+                    return "VIP_NE";
+                case ast::consts::AND:
+                    return "VIP_AND";
+                case ast::consts::MOD:
+                    return "VIP_MOD";
+                case ast::consts::BIT_AND:
+                    return "VIP_BIT_AND";
+                case ast::consts::BIT_OR:
+                    return "VIP_BIT_OR";
+                case ast::consts::BIT_XOR:
+                    return "VIP_BIT_XOR";
+                case ast::consts::SHIFT_LEFT:
+                    return "VIP_SHIFT_LEFT";
+                case ast::consts::SHIFT_RIGHT:
+                    return "VIP_SHIFT_RIGHT";
+                default:
+                    return "VIP_OR";
+                }
+            }
+
+            Operand dynamic(const std::string &code)
+            {
+                auto t = temp();
+                line("vip_value " + t + " = " + code + ";");
+                owned.push_back(t);
+                return Operand{t, TYPE_DYNAMIC};
+            }
+
+            Operand genCall(ast::CallExpression *call)
+            {
+                std::vector<Operand> args;
+                for (auto &&arg : call->getArguments())
+                    args.push_back(genExpression(arg));
+
+                if (isPrintln(call))
+                {
+                    if (args.empty())
+                    {
+                        line("vip_println(0, NULL);");
+                        return Operand{"vip_null()", TYPE_DYNAMIC};
+                    }
+                    auto t = temp();
+                    std::string values;
+                    for (auto &&arg : args)
+                        values += (values.empty() ? "" : ", ") + box(arg);
+                    line("vip_value " + t + "[] = {" + values + "};");
+                    line("vip_println(" + std::to_string(args.size()) + ", " + t + ");");
+                    return Operand{"vip_null()", TYPE_DYNAMIC};
+                }
+
+                auto &fn = callee(call);
+                std::string values;
+                for (std::size_t i = 0; i < args.size(); i++)
+                    values += (i == 0 ? "" : ", ") + (fn.params[i]->number ? args[i].code : box(args[i]));
+
+                if (!fn.numberReturn)
+                    return dynamic(fn.cname + "(" + values + ")");
+
+                auto t = temp();
+                line("double " + t + " = " + fn.cname + "(" + values + ");");
+                return Operand{t, TYPE_NUMBER};
+            }
+
+            Operand genExpression(ast::Node *node)
+            {
+                switch (node->getKind())
+                {
+                case ast::consts::NUMBERIC_LITERAL:
+                    return Operand{literal(numeric(static_cast<ast::NumericLiteral *>(node))), TYPE_NUMBER};
+                case ast::consts::STRING_LITERAL:
+                {
+                    literals.push_back(static_cast<ast::StringLiteral *>(node)->getValue());
+                    return Operand{"vip_lit" + std::to_string(literals.size() - 1), TYPE_DYNAMIC};
+                }
+                case ast::consts::IDENTIFIER:
+                {
+                    auto &name = static_cast<ast::Identifier *>(node)->getValue();
+                    auto var = lookup(name);
+                    if (var == nullptr)
+                        return Operand{name == "true" ? "1" : "0", TYPE_BOOL};
+
+                    // read into a temporary so later operands can not change what was read.
+                    if (!var->number)
+                        return dynamic("vip_retain(" + var->cname + ")");
+                    auto t = temp();
+                    line("double " + t + " = " + var->cname + ";");
+                    return Operand{t, TYPE_NUMBER};
+                }
+                case ast::consts::CALL_EXPRESSION:
+                    return genCall(static_cast<ast::CallExpression *>(node));
+                case ast::consts::BINARY_EXPRESSION:
+                    break;
+                default:
+                    throw std::runtime_error("Unknown expression.");
+                }
+
+                auto bin = static_cast<ast::BinaryExpression *>(node);
+                if (bin->getOp() == ast::consts::EQUAL)
+                {
+                    auto var = lookup(static_cast<ast::Identifier *>(bin->getLhs())->getValue());
+                    auto rhs = genExpression(bin->getRhs());
+                    if (var->number)
+                    {
+                        line(var->cname + " = " + rhs.code + ";");
+                        return rhs;
+                    }
+                    line("vip_assign(&" + var->cname + ", " + box(rhs) + ");");
+                    return Operand{box(rhs), TYPE_DYNAMIC};
+                }
+
+                if (auto base = compound(bin->getOp()); base != 0)
+                {
+                    auto var = lookup(static_cast<ast::Identifier *>(bin->getLhs())->getValue());
+                    auto rhs = genExpression(bin->getRhs());
+                    if (var->number)
+                    {
+                        if (base == ast::consts::DIV)
+                            line(var->cname + " = vip_div(" + var->cname + ", " + rhs.code + ");");
+                        else
+                            line(var->cname + " = vip_exact(" + var->cname + " " + (char)base + " " + rhs.code + ", " + var->cname + ", " + rhs.code + ");");
+                        auto t = temp();
+                        line("double " + t + " = " + var->cname + ";");
+                        return Operand{t, TYPE_NUMBER};
+                    }
+                    line("vip_update(&" + var->cname + ", " + runtimeOp(base) + ", " + box(rhs) + ");");
+                    return dynamic("vip_retain(" + var->cname + ")");
+                }
+
+                if (bin->getOp() == ast::consts::AND || bin->getOp() == ast::consts::OR)
+                    return genLogical(bin);
+
+                auto lhs = genExpression(bin->getLhs());
+                auto rhs = genExpression(bin->getRhs());
+                if (!isNumeric(lhs.type) || !isNumeric(rhs.type))
+                    return dynamic("vip_binary(" + runtimeOp(bin->getOp()) + ", " + box(lhs) + ", " + box(rhs) + ")");
+
+                auto t = temp();
+                switch (bin->getOp())
+                {
+                case ast::consts::PLUS:
+                case ast::consts::MINUS:
+                case ast::consts::MULT:
+                {
+                    char op = (char)bin->getOp();
+                    line("double " + t + " = vip_exact(" + lhs.code + " " + op + " " + rhs.code + ", " + lhs.code + ", " + rhs.code + ");");
+                    return Operand{t, TYPE_NUMBER};
+                }
+                case ast::consts::DIV:
+                    line("double " + t + " = vip_div(" + lhs.code + ", " + rhs.code + ");");
+                    return Operand{t, TYPE_NUMBER};
+                case ast::consts::MOD:
+                    line("double " + t + " = vip_mod(" + lhs.code + ", " + rhs.code + ");");
+                    return Operand{t, TYPE_NUMBER};
+                case ast::consts::BIT_AND:
+                case ast::consts::BIT_OR:
+                case ast::consts::BIT_XOR:
+                case ast::consts::SHIFT_LEFT:
+                case ast::consts::SHIFT_RIGHT:
+                    line("double " + t + " = vip_bitwise(" + runtimeOp(bin->getOp()) + ", " + lhs.code + ", " + rhs.code + ");");
+                    return Operand{t, TYPE_NUMBER};
+                case ast::consts::LESS_THEN:
+                    line("int " + t + " = " + lhs.code + " < " + rhs.code + ";");
+                    return Operand{t, TYPE_BOOL};
+                case ast::consts::GREATER_THEN:
+                    line("int " + t + " = " + lhs.code + " > " + rhs.code + ";");
+                    return Operand{t, TYPE_BOOL};
+                case ast::consts::LESS_THEN_OR_EQUAL:
+                    line("int " + t + " = !(" + lhs.code + " > " + rhs.code + ");");
+                    return Operand{t, TYPE_BOOL};
+                case ast::consts::GREATER_THEN_OR_EQUAL:
+                    line("int " + t + " = !(" + lhs.code + " < " + rhs.code + ");");
+                    return Operand{t, TYPE_BOOL};
+                case ast::consts::EQUAL_EQUAL:
+                    line("int " + t + " = " + lhs.code + " == " + rhs.code + ";");
+                    return Operand{t, TYPE_BOOL};
+                default:
+                    line("int " + t + " = " + lhs.code + " != " + rhs.code + ";");
+                    return Operand{t, TYPE_BOOL};
+                }
+            }
+
+            /// @brief && and || only run the rhs when the lhs does not decide the result.
+            Operand genLogical(ast::BinaryExpression *bin)
+            {
+                bool isAnd = bin->getOp() == ast::consts::AND;
+                auto lhs = genExpression(bin->getLhs());
+
+                // a lhs that is not a number falls through to vip_binary, which reports the error.
+                std::string decided;
+                if (isNumeric(lhs.type))
+                    decided = isAnd ? "!" + truthy(lhs) : truthy(lhs);
+                else
+                    decided = isAnd ? "(" + lhs.code + ".kind == VIP_NUMBER && !vip_truthy(" + lhs.code + "))" : "vip_truthy(" + lhs.code + ")";
+
+                auto t = temp();
+                line("int " + t + ";");
+                line("if (" + decided + ")");
+                line(std::string("    ") + t + (isAnd ? " = 0;" : " = 1;"));
+                line("else");
+
+                // temporaries of the rhs only exist on this branch, so they are released on it.
+                auto outer = std::move(owned);
+                owned.clear();
+                open();
+                auto rhs = genExpression(bin->getRhs());
+                if (isNumeric(lhs.type) && isNumeric(rhs.type))
+                    line(t + " = " + truthy(rhs) + ";");
+                else
+                    line(t + " = vip_truthy(" + dynamic("vip_binary(" + runtimeOp(bin->getOp()) + ", " + box(lhs) + ", " + box(rhs) + ")").code + ");");
+                close();
+                owned = std::move(outer);
+
+                return Operand{t, TYPE_BOOL};
+            }
+
+            void releaseScope(std::map<std::string, Variable *> &scope)
+            {
+                for (auto &&entry : scope)
+                {
+                    if (!entry.second->number)
+                        line("vip_release(" + entry.second->cname + ");");
+                }
+            }
+
+            void genBlock(std::vector<ast::Node *> &statements)
+            {
+                open();
+                scopes.emplace_back();
+                for (auto &&statement : statements)
+                    genStatement(statement);
+                releaseScope(scopes.back());
+                scopes.pop_back();
+                indent--;
+                line("}");
+            }
+
+            void genIf(ast::IfStatement *value)
+            {
+                open();
+                auto condition = genExpression(value->getExpression());
+                auto t = temp();
+                line("int " + t + " = " + truthy(condition) + ";");
+                for (auto &&name : owned)
+                    line("vip_release(" + name + ");");
+                owned.clear();
+                line("if (" + t + ")");
+                genBlock(value->getThen()->getStatements());
+
+                if (auto elseBlock = value->getElse(); elseBlock != nullptr)
+                {
+                    line("else");
+                    if (elseBlock->getKind() == ast::consts::BLOCK_EXPRESSION)
+                    {
+                        genBlock(static_cast<ast::Block *>(elseBlock)->getStatements());
+                    }
+                    else
+                    {
+                        genIf(static_cast<ast::IfStatement *>(elseBlock));
+                    }
+                }
+                close();
+            }
+
+            static std::string number(const Operand &op)
+            {
+                return op.type == TYPE_DYNAMIC ? "vip_bound(" + op.code + ")" : op.code;
+            }
+
+            /// @brief a counted loop is a c for loop on a double, the loop variable is assigned from it every iteration.
+            void genFor(ast::ForStatement *value)
+            {
+                open();
+                auto from = temp();
+                auto to = temp();
+                auto step = temp();
+                line("double " + from + " = " + number(genExpression(value->getFrom())) + ";");
+                line("double " + to + " = " + number(genExpression(value->getTo())) + ";");
+
+                std::string direction;
+                if (auto constant = ast::cast<ast::NumericLiteral>(value->getStep()); constant != nullptr || value->getStep() == nullptr)
+                {
+                    double by = constant != nullptr ? numeric(constant) : 1;
+                    if (by == 0)
+                        line("vip_fail(\"Step of a for loop can not be 0.\");");
+                    line("double " + step + " = " + literal(by) + ";");
+                    direction = by > 0 ? " < " : " > ";
+                }
+                else
+                {
+                    line("double " + step + " = " + number(genExpression(value->getStep())) + ";");
+                    line("if (" + step + " == 0)");
+                    line("    vip_fail(\"Step of a for loop can not be 0.\");");
+                }
+                for (auto &&name : owned)
+                    line("vip_release(" + name + ");");
+                owned.clear();
+
+                auto &name = value->getName()->getValue();
+                scopes.emplace_back();
+                auto var = create(value, name, true, false);
+                scopes.back()[name] = var;
+                line((var->number ? "double " : "vip_value ") + var->cname + (var->number ? " = 0;" : " = {0};"));
+
+                auto i = temp();
+                auto condition = direction.empty() ? "(" + step + " > 0 ? " + i + " < " + to + " : " + i + " > " + to + ")" : i + direction + to;
+                line("for (double " + i + " = " + from + "; " + condition + "; " + i + " += " + step + ")");
+                open();
+                if (var->number)
+                    line(var->cname + " = " + i + ";");
+                else
+                    line("vip_assign(&" + var->cname + ", vip_number(" + i + "));");
+                genBlock(value->getBody()->getStatements());
+                indent--;
+                line("}");
+
+                releaseScope(scopes.back());
+                scopes.pop_back();
+                close();
+            }
+
+            /// @brief a match on a number with integer cases is a c switch on the value, anything
+            /// else looks the value up in a sorted table of its cases and switches on the position.
+            void genMatch(ast::MatchStatement *value)
+            {
+                open();
+                auto subject = genExpression(value->getExpression());
+                auto &values = value->getValues();
+                auto t = temp();
+
+                bool integral = isNumeric(subject.type) && !values.empty();
+                for (auto &&node : values)
+                {
+                    if (node->getKind() != ast::consts::NUMBERIC_LITERAL)
+                    {
+                        integral = false;
+                        continue;
+                    }
+                    double number = numeric(static_cast<ast::NumericLiteral *>(node));
+                    integral = integral && number == std::floor(number) && std::fabs(number) < 2147483648.0;
+                }
+
+                // label of the c case each body is generated under.
+                std::vector<std::size_t> labels(values.size());
+                if (values.empty())
+                {
+                    line("int " + t + " = -1;");
+                }
+                else if (integral)
+                {
+                    double low = 0;
+                    double high = 0;
+                    for (std::size_t i = 0; i < values.size(); i++)
+                    {
+                        double number = numeric(static_cast<ast::NumericLiteral *>(values[i]));
+                        low = i == 0 ? number : std::min(low, number);
+                        high = i == 0 ? number : std::max(high, number);
+                    }
+
+                    auto v = temp();
+                    line("double " + v + " = " + subject.code + ";");
+                    line("int " + t + " = -1;");
+                    line("if (" + v + " >= " + literal(low) + " && " + v + " <= " + literal(high) + " && " + v + " == (double)(long long)" + v + ")");
+                    open();
+                    line("switch ((long long)" + v + ")");
+                    open();
+                    for (std::size_t i = 0; i < values.size(); i++)
+                    {
+                        labels[i] = i;
+                        auto number = (long long)numeric(static_cast<ast::NumericLiteral *>(values[i]));
+                        line("case " + std::to_string(number) + ": " + t + " = " + std::to_string(i) + "; break;");
+                    }
+                    indent--;
+                    line("}");
+                    indent--;
+                    line("}");
+                }
+                else
+                {
+                    // sorted the way vip_match searches: by kind, then value.
+                    std::vector<std::tuple<int, double, std::string, std::size_t>> cases;
+                    for (std::size_t i = 0; i < values.size(); i++)
+                    {
+                        if (values[i]->getKind() == ast::consts::NUMBERIC_LITERAL)
+                            cases.emplace_back(2, numeric(static_cast<ast::NumericLiteral *>(values[i])), "", i);
+                        else
+                            cases.emplace_back(1, 0.0, static_cast<ast::StringLiteral *>(values[i])->getValue(), i);
+                    }
+                    std::sort(cases.begin(), cases.end());
+
+                    auto table = temp();
+                    line("static const vip_case " + table + "[] = {");
+                    indent++;
+                    for (std::size_t i = 0; i < cases.size(); i++)
+                    {
+                        auto &[kind, number, text, body] = cases[i];
+                        labels[body] = i;
+                        if (kind == 2)
+                            line("{VIP_NUMBER, " + literal(number) + ", NULL, 0},");
+                        else
+                            line("{VIP_STRING, 0.0, " + quote(text) + ", " + std::to_string(text.size()) + "},");
+                    }
+                    indent--;
+                    line("};");
+                    line("int " + t + " = vip_match(" + box(subject) + ", " + table + ", " + std::to_string(cases.size()) + ");");
+                }
+
+                for (auto &&name : owned)
+                    line("vip_release(" + name + ");");
+                owned.clear();
+
+                line("switch (" + t + ")");
+                open();
+                for (std::size_t i = 0; i < values.size(); i++)
+                {
+                    line("case " + std::to_string(labels[i]) + ":");
+                    genBlock(value->getBodies()[i]->getStatements());
+                    line("break;");
+                }
+                if (value->getElse() != nullptr)
+                {
+                    line("default:");
+                    genBlock(value->getElse()->getStatements());
+                }
+                indent--;
+                line("}");
+                close();
+            }
+
+            void genStatement(ast::Node *statement)
+            {
+                switch (statement->getKind())
+                {
+                case ast::consts::VARIABLE_STATEMENT:
+                {
+                    for (auto &&decl : static_cast<ast::VariableStatement *>(statement)->getDeclarations())
+                    {
+                        auto init = decl->getInitalizer();
+                        auto type = decl->getType() != nullptr ? decl->getType()->getValue() : "";
+                        if (init == nullptr && type != "number" && type != "string")
+                            throw std::runtime_error("Unsupported type");
+
+                        // the c variable is declared up front, but the name only comes into scope
+                        // after the initializer so it still sees an outer variable of the same name.
+                        auto &name = decl->getName()->getValue();
+                        if (!isTopLevel() && scopes.back().find(name) == scopes.back().end())
+                        {
+                            auto local = create(decl, name, type == "number", false);
+                            line((local->number ? "double " : "vip_value ") + local->cname + (local->number ? " = 0;" : " = {0};"));
+                        }
+
+                        Operand value{"", TYPE_NUMBER};
+                        if (init != nullptr)
+                        {
+                            open();
+                            value = genExpression(init);
+                        }
+
+                        auto var = declare(decl);
+                        if (init == nullptr)
+                            continue;
+
+                        if (var != nullptr)
+                        {
+                            if (var->number)
+                                line(var->cname + " = " + value.code + ";");
+                            else
+                                line("vip_assign(&" + var->cname + ", " + box(value) + ");");
+                        }
+                        close();
+                    }
+                    return;
+                }
+                case ast::consts::EXPRESSION_STATEMENT:
+                    open();
+                    genExpression(static_cast<ast::ExpressionStatement *>(statement)->getExpression());
+                    close();
+                    return;
+                case ast::consts::RETURN_STATEMENT:
+                {
+                    open();
+                    auto value = genExpression(static_cast<ast::ReturnStatement *>(statement)->getExpression());
+                    if (current->numberReturn)
+                        line("double ret = " + value.code + ";");
+                    else
+                        line("vip_value ret = vip_retain(" + box(value) + ");");
+                    for (auto &&name : owned)
+                        line("vip_release(" + name + ");");
+                    owned.clear();
+                    for (auto it = scopes.rbegin(); it != scopes.rend(); it++)
+                        releaseScope(*it);
+                    line("return ret;");
+                    close();
+                    return;
+                }
+                case ast::consts::IF_STATEMENT:
+                    genIf(static_cast<ast::IfStatement *>(statement));
+                    return;
+                case ast::consts::MATCH_STATEMENT:
+                    genMatch(static_cast<ast::MatchStatement *>(statement));
+                    return;
+                case ast::consts::FOR_STATEMENT:
+                    genFor(static_cast<ast::ForStatement *>(statement));
+                    return;
+                case ast::consts::WHILE_EXRESSION:
+                {
+                    auto loop = static_cast<ast::WhileExpression *>(statement);
+                    line("for (;;)");
+                    open();
+                    auto condition = genExpression(loop->getExpression());
+                    auto t = temp();
+                    line("int " + t + " = " + truthy(condition) + ";");
+                    for (auto &&name : owned)
+                        line("vip_release(" + name + ");");
+                    owned.clear();
+                    line("if (!" + t + ")");
+                    line("    break;");
+                    genBlock(loop->getBody()->getStatements());
+                    close();
+                    return;
+                }
+                case ast::consts::FUNCTION_EXPRESSION:
+                    return;
+                default:
+                    throw std::runtime_error("Uncaught SyntaxError: Illegal statement");
+                }
+            }
+
+            /// @brief reject a function that reads a top level name a caller of it binds as a local,
+            /// the interpreter would read the local of the caller there.
+            void checkScoping()
+            {
+                for (auto &&[caller, names] : locals)
+                {
+                    // every function caller reaches through one call or more.
+                    std::set<const Fn *> reached;
+                    std::vector<const Fn *> pending(calls[caller].begin(), calls[caller].end());
+                    while (!pending.empty())
+                    {
+                        auto fn = pending.back();
+                        pending.pop_back();
+                        if (!reached.insert(fn).second)
+                            continue;
+                        pending.insert(pending.end(), calls[fn].begin(), calls[fn].end());
+                    }
+
+                    for (auto &&fn : reached)
+                    {
+                        for (auto &&name : reads[fn])
+                        {
+                            if (names.count(name) != 0)
+                                throw std::runtime_error("Compiled functions can not see the locals of their caller: " + fn->decl->getName() + " reads " + name + ".");
+                        }
+                    }
+                }
+            }
+
+            std::string signature(Fn &fn)
+            {
+                std::string params;
+                for (std::size_t i = 0; i < fn.params.size(); i++)
+                    params += (i == 0 ? "" : ", ") + std::string(fn.params[i]->number ? "double " : "vip_value ") + fn.params[i]->cname;
+                if (params.empty())
+                    params = "void";
+                return std::string("static ") + (fn.numberReturn ? "double " : "vip_value ") + fn.cname + "(" + params + ")";
+            }
+
+            void genFunction(Fn &fn)
+            {
+                line(signature(fn));
+                open();
+                scopes.clear();
+                scopes.emplace_back();
+                auto params = fn.decl->getParameters();
+                for (std::size_t i = 0; i < params.size(); i++)
+                {
+                    auto var = fn.params[i];
+                    scopes.back()[params[i]->getName()->getValue()] = var;
+                    if (var->number)
+                        continue;
+
+                    auto type = static_cast<ast::Identifier *>(params[i]->getType())->getValue();
+                    line(std::string("vip_check_param(") + var->cname + (type == "number" ? ", VIP_NUMBER);" : ", VIP_STRING);"));
+                    line(var->cname + " = vip_retain(" + var->cname + ");");
+                }
+
+                current = &fn;
+                for (auto &&statement : fn.decl->getBody())
+                    genStatement(statement);
+                releaseScope(scopes.back());
+                line(fn.numberReturn ? "return 0;" : "return vip_null();");
+                current = nullptr;
+                scopes.clear();
+                indent--;
+                line("}");
+                line("");
+            }
+
+        public:
+            Translator(ast::Program &program) : program(program) {}
+
+            std::string translate()
+            {
+                auto &statements = program.getStatements();
+
+                // top level names are visible to every function, whichever order they are declared in.
+                for (auto &&statement : statements)
+                {
+                    if (statement->getKind() == ast::consts::VARIABLE_STATEMENT)
+                    {
+                        for (auto &&decl : static_cast<ast::VariableStatement *>(statement)->getDeclarations())
+                        {
+                            auto &name = decl->getName()->getValue();
+                            bool number = decl->getType() != nullptr && decl->getType()->getValue() == "number";
+                            auto var = create(decl, name, number, true);
+                            if (globals.find(name) == globals.end())
+                                globals[name] = var;
+                        }
+                    }
+                }
+                for (auto &&statement : statements)
+                {
+                    if (statement->getKind() != ast::consts::FUNCTION_EXPRESSION)
+                        continue;
+
+                    auto decl = static_cast<ast::FunctionDeclartion *>(statement);
+                    auto &name = decl->getName();
+                    if (functions.find(name) != functions.end() || globals.find(name) != globals.end())
+                        throw std::runtime_error("A variable already exists with this name.");
+
+                    Fn fn{decl, "vipfn_" + mangle(name), definitelyReturns(decl->getBody()), {}};
+                    for (auto &&param : decl->getParameters())
+                    {
+                        auto type = ast::cast<ast::Identifier>(param->getType());
+                        if (type == nullptr || (type->getValue() != "number" && type->getValue() != "string"))
+                            throw std::runtime_error("Invalid type");
+                        fn.params.push_back(create(param, param->getName()->getValue(), type->getValue() == "number", false));
+                    }
+                    functions.emplace(name, fn);
+                }
+
+                do
+                {
+                    changed = false;
+                    for (auto &&statement : statements)
+                        inferStatement(statement);
+                } while (changed);
+                checkScoping();
+
+                std::string result = "#include \"vip_runtime.h\"\n#include <stdio.h>\n\n";
+
+                for (auto &&global : globals)
+                    result += global.second->number ? "static double " + global.second->cname + " = 0;\n" : "static vip_value " + global.second->cname + ";\n";
+
+                std::string prototypes;
+                for (auto &&fn : functions)
+                    prototypes += signature(fn.second) + ";\n";
+
+                for (auto &&fn : functions)
+                    genFunction(fn.second);
+                std::string body = out;
+
+                out.clear();
+                indent = 1;
+                for (auto &&statement : statements)
+                    genStatement(statement);
+                std::string main = out;
+
+                for (std::size_t i = 0; i < literals.size(); i++)
+                    result += "static vip_value vip_lit" + std::to_string(i) + ";\n";
+
+                result += "\n" + prototypes + "\n" + body;
+                result += "int main(void)\n{\n";
+                for (std::size_t i = 0; i < literals.size(); i++)
+                    result += "    vip_lit" + std::to_string(i) + " = vip_string_static(" + quote(literals[i]) + ", " + std::to_string(literals[i].size()) + ");\n";
+                result += main;
+                result += "    return 0;\n}\n";
+
+                return result;
+            }
+        };
+    } // namespace
+
+    std::string astToC(ast::Program &program)
+    {
+        return Translator(program).translate();
+    }
+} // namespace compile
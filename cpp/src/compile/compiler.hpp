@@ -1,9 +1,24 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <vip/ast/Program.hpp>
 
 namespace compile
 {
-    void compileCil(std::vector<std::string> files, std::vector<std::string> flags, std::string outdir);
+    /// @brief header of the c runtime generated programs link against.
+    extern const char *RUNTIME_HEADER;
+    /// @brief implementation of the c runtime generated programs link against.
+    extern const char *RUNTIME_SOURCE;
+
+    /// @brief translate a program into c source that includes "vip_runtime.h".
+    /// @param program the program to translate
+    /// @return c source code
+    std::string astToC(ast::Program &program);
+
+    /// @brief build c sources into an executable with the system c compiler.
+    /// @param files c source files
+    /// @param flags extra compiler flags
+    /// @param outfile path of the executable
+    void compileC(std::vector<std::string> files, std::vector<std::string> flags, std::string outfile);
 
 } // namespace compile
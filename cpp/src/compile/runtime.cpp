@@ -0,0 +1,417 @@
+#include "./compiler.hpp"
+
+namespace compile
+{
+    const char *RUNTIME_HEADER = R"VIP(#ifndef VIP_RUNTIME_H
+#define VIP_RUNTIME_H
+#include <stddef.h>
+
+enum vip_kind
+{
+    VIP_NULL = 0,
+    VIP_STRING = 1,
+    VIP_NUMBER = 2
+};
+
+enum vip_op
+{
+    VIP_ADD,
+    VIP_SUB,
+    VIP_MUL,
+    VIP_DIV,
+    VIP_LT,
+    VIP_GT,
+    VIP_LE,
+    VIP_GE,
+    VIP_EQ,
+    VIP_NE,
+    VIP_AND,
+    VIP_OR,
+    VIP_MOD,
+    VIP_BIT_AND,
+    VIP_BIT_OR,
+    VIP_BIT_XOR,
+    VIP_SHIFT_LEFT,
+    VIP_SHIFT_RIGHT
+};
+
+typedef struct vip_string
+{
+    long refs; /* negative for literals that live as long as the program */
+    size_t length;
+    size_t capacity; /* bytes data has room for, not counting the terminator */
+    char data[];
+} vip_string;
+
+typedef struct vip_value
+{
+    int kind;
+    int boolean;
+    double number;
+    vip_string *string;
+} vip_value;
+
+/* one case of a match statement, tables are sorted by kind, then value. */
+typedef struct vip_case
+{
+    int kind;
+    double number;
+    const char *data;
+    size_t length;
+} vip_case;
+
+vip_value vip_null(void);
+vip_value vip_number(double value);
+vip_value vip_bool(int value);
+vip_value vip_string_static(const char *data, size_t length);
+vip_value vip_retain(vip_value value);
+void vip_release(vip_value value);
+void vip_assign(vip_value *target, vip_value value);
+void vip_update(vip_value *target, int op, vip_value rhs);
+void vip_fail(const char *message);
+void vip_check_param(vip_value value, int kind);
+void vip_inexact(double lhs, double rhs);
+double vip_div(double lhs, double rhs);
+double vip_mod(double lhs, double rhs);
+double vip_bitwise(int op, double lhs, double rhs);
+double vip_bound(vip_value value);
+int vip_truthy(vip_value value);
+vip_value vip_binary(int op, vip_value lhs, vip_value rhs);
+int vip_match(vip_value value, const vip_case *cases, int count);
+void vip_println(int count, const vip_value *args);
+
+/* result of lhs + - * rhs, failing where the interpreter would keep an integer doubles can not hold. */
+static inline double vip_exact(double result, double lhs, double rhs)
+{
+    if (result >= 9007199254740992.0 || result <= -9007199254740992.0)
+        vip_inexact(lhs, rhs);
+    return result;
+}
+
+#endif
+)VIP";
+
+    const char *RUNTIME_SOURCE = R"VIP(#include "vip_runtime.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static vip_string *vip_string_alloc(size_t length)
+{
+    vip_string *str = (vip_string *)malloc(sizeof(vip_string) + length + 1);
+    if (str == NULL)
+        vip_fail("Out of memory");
+    str->refs = 1;
+    str->length = length;
+    str->capacity = length;
+    str->data[length] = '\0';
+    return str;
+}
+
+vip_value vip_null(void)
+{
+    vip_value value = {VIP_NULL, 0, 0.0, NULL};
+    return value;
+}
+
+vip_value vip_number(double number)
+{
+    vip_value value = {VIP_NUMBER, 0, number, NULL};
+    return value;
+}
+
+vip_value vip_bool(int boolean)
+{
+    vip_value value = {VIP_NUMBER, 1, boolean ? 1.0 : 0.0, NULL};
+    return value;
+}
+
+vip_value vip_string_static(const char *data, size_t length)
+{
+    vip_value value = {VIP_STRING, 0, 0.0, vip_string_alloc(length)};
+    memcpy(value.string->data, data, length);
+    value.string->refs = -1;
+    return value;
+}
+
+vip_value vip_retain(vip_value value)
+{
+    if (value.kind == VIP_STRING && value.string->refs > 0)
+        value.string->refs++;
+    return value;
+}
+
+void vip_release(vip_value value)
+{
+    if (value.kind == VIP_STRING && value.string->refs > 0 && --value.string->refs == 0)
+        free(value.string);
+}
+
+void vip_assign(vip_value *target, vip_value value)
+{
+    vip_retain(value);
+    vip_release(*target);
+    *target = value;
+}
+
+/* *target = *target op rhs, appending in place to a string nothing else holds. */
+void vip_update(vip_value *target, int op, vip_value rhs)
+{
+    vip_string *str = target->string;
+    if (op == VIP_ADD && target->kind == VIP_STRING && rhs.kind == VIP_STRING && str->refs == 1)
+    {
+        size_t length = str->length + rhs.string->length;
+        if (length > str->capacity)
+        {
+            /* doubling keeps appends in a loop amortized linear. */
+            size_t capacity = str->capacity * 2 > length ? str->capacity * 2 : length;
+            str = (vip_string *)realloc(str, sizeof(vip_string) + capacity + 1);
+            if (str == NULL)
+                vip_fail("Out of memory");
+            str->capacity = capacity;
+            target->string = str;
+        }
+        memcpy(str->data + str->length, rhs.string->data, rhs.string->length);
+        str->length = length;
+        str->data[length] = '\0';
+        return;
+    }
+
+    vip_value value = vip_binary(op, *target, rhs);
+    vip_release(*target);
+    *target = value;
+}
+
+void vip_fail(const char *message)
+{
+    fflush(stdout);
+    fprintf(stderr, "%s\n", message);
+    exit(1);
+}
+
+void vip_check_param(vip_value value, int kind)
+{
+    if (value.kind != kind)
+        vip_fail("Invalid type");
+}
+
+double vip_div(double lhs, double rhs)
+{
+    if (rhs == 0)
+        vip_fail("Divide by zero exception");
+    return lhs / rhs;
+}
+
+static int vip_whole(double value)
+{
+    return value > -9223372036854775808.0 && value < 9223372036854775808.0 && value == (double)(long long)value;
+}
+
+void vip_inexact(double lhs, double rhs)
+{
+    if (vip_whole(lhs) && vip_whole(rhs))
+        vip_fail("Integers past 2^53 are not supported by compiled programs.");
+}
+
+/* whole numbers use the integer remainder, anything else fmod. */
+double vip_mod(double lhs, double rhs)
+{
+    if (rhs == 0)
+        vip_fail("Divide by zero exception");
+    if (vip_whole(lhs) && vip_whole(rhs))
+        return rhs == -1 ? 0 : (double)((long long)lhs % (long long)rhs);
+    return fmod(lhs, rhs);
+}
+
+static long long vip_bits(double value)
+{
+    if (!vip_whole(value))
+        vip_fail("Bitwise operators only work on integers.");
+    return (long long)value;
+}
+
+double vip_bitwise(int op, double lhs, double rhs)
+{
+    long long a = vip_bits(lhs);
+    long long b = vip_bits(rhs);
+    long long result;
+    switch (op)
+    {
+    case VIP_BIT_AND:
+        result = a & b;
+        break;
+    case VIP_BIT_OR:
+        result = a | b;
+        break;
+    case VIP_BIT_XOR:
+        result = a ^ b;
+        break;
+    case VIP_SHIFT_LEFT:
+        result = (long long)((unsigned long long)a << (b & 63));
+        break;
+    default:
+        result = a >> (b & 63);
+        break;
+    }
+    if (result > 9007199254740992LL || result < -9007199254740992LL)
+        vip_fail("Integers past 2^53 are not supported by compiled programs.");
+    return (double)result;
+}
+
+double vip_bound(vip_value value)
+{
+    if (value.kind != VIP_NUMBER)
+        vip_fail("Range bounds must be numbers.");
+    return value.number;
+}
+
+int vip_truthy(vip_value value)
+{
+    return value.kind == VIP_NUMBER && value.number != 0;
+}
+
+/* byte wise order of two strings, like std::string::compare. */
+static int vip_compare(const vip_string *lhs, const vip_string *rhs)
+{
+    size_t length = lhs->length < rhs->length ? lhs->length : rhs->length;
+    int order = memcmp(lhs->data, rhs->data, length);
+    if (order != 0)
+        return order;
+    return lhs->length < rhs->length ? -1 : lhs->length > rhs->length;
+}
+
+vip_value vip_binary(int op, vip_value lhs, vip_value rhs)
+{
+    if (lhs.kind != rhs.kind)
+        vip_fail("Can not operate on two different types.");
+
+    if (lhs.kind == VIP_NUMBER)
+    {
+        double a = lhs.number;
+        double b = rhs.number;
+        switch (op)
+        {
+        case VIP_ADD:
+            return vip_number(vip_exact(a + b, a, b));
+        case VIP_SUB:
+            return vip_number(vip_exact(a - b, a, b));
+        case VIP_MUL:
+            return vip_number(vip_exact(a * b, a, b));
+        case VIP_DIV:
+            return vip_number(vip_div(a, b));
+        case VIP_LT:
+            return vip_bool(a < b);
+        case VIP_GT:
+            return vip_bool(a > b);
+        case VIP_LE:
+            return vip_bool(!(a > b));
+        case VIP_GE:
+            return vip_bool(!(a < b));
+        case VIP_EQ:
+            return vip_bool(a == b);
+        case VIP_NE:
+            return vip_bool(!(a == b));
+        case VIP_AND:
+            return vip_bool(a != 0 && b != 0);
+        case VIP_OR:
+            return vip_bool(a != 0 || b != 0);
+        case VIP_MOD:
+            return vip_number(vip_mod(a, b));
+        default:
+            return vip_number(vip_bitwise(op, a, b));
+        }
+    }
+
+    if (lhs.kind == VIP_STRING && op == VIP_ADD)
+    {
+        vip_string *str = vip_string_alloc(lhs.string->length + rhs.string->length);
+        memcpy(str->data, lhs.string->data, lhs.string->length);
+        memcpy(str->data + lhs.string->length, rhs.string->data, rhs.string->length);
+        vip_value value = {VIP_STRING, 0, 0.0, str};
+        return value;
+    }
+
+    if (lhs.kind == VIP_STRING)
+    {
+        int order = vip_compare(lhs.string, rhs.string);
+        switch (op)
+        {
+        case VIP_LT:
+            return vip_bool(order < 0);
+        case VIP_GT:
+            return vip_bool(order > 0);
+        case VIP_LE:
+            return vip_bool(order <= 0);
+        case VIP_GE:
+            return vip_bool(order >= 0);
+        case VIP_EQ:
+            return vip_bool(order == 0);
+        case VIP_NE:
+            return vip_bool(order != 0);
+        }
+    }
+
+    vip_fail("Invalid operation.");
+    return vip_null();
+}
+
+/* index of the case that has value, -1 if there is none. */
+int vip_match(vip_value value, const vip_case *cases, int count)
+{
+    int low = 0;
+    int high = count - 1;
+    if (value.kind == VIP_NUMBER && value.number != value.number)
+        return -1;
+    while (low <= high)
+    {
+        int middle = low + (high - low) / 2;
+        const vip_case *item = &cases[middle];
+        int order = value.kind - item->kind;
+        if (order == 0 && value.kind == VIP_NUMBER)
+            order = value.number < item->number ? -1 : value.number > item->number;
+        else if (order == 0 && value.kind == VIP_STRING)
+        {
+            size_t length = value.string->length < item->length ? value.string->length : item->length;
+            order = memcmp(value.string->data, item->data, length);
+            if (order == 0)
+                order = value.string->length < item->length ? -1 : value.string->length > item->length;
+        }
+
+        if (order == 0)
+            return middle;
+        if (order < 0)
+            high = middle - 1;
+        else
+            low = middle + 1;
+    }
+    return -1;
+}
+
+void vip_println(int count, const vip_value *args)
+{
+    for (int i = 0; i < count; i++)
+    {
+        switch (args[i].kind)
+        {
+        case VIP_NUMBER:
+            if (args[i].boolean)
+                fputs(args[i].number == 1 ? "true" : "false", stdout);
+            else if (args[i].number == floor(args[i].number) && fabs(args[i].number) < 9223372036854775808.0)
+                /* whole numbers print like the interpreter's integers. */
+                printf("%lld", (long long)args[i].number);
+            else
+                printf("%g", args[i].number);
+            break;
+        case VIP_STRING:
+            fwrite(args[i].string->data, 1, args[i].string->length, stdout);
+            break;
+        default:
+            fputs("null", stdout);
+            break;
+        }
+    }
+    fputc('\n', stdout);
+}
+)VIP";
+} // namespace compile
@@ -0,0 +1,225 @@
+#include <vip/jit/Builtins.hpp>
+#include <vip/jit/Kernels.hpp>
+#include <vip/jit/Intrinsics.hpp>
+#include <vip/jit/components/InternalFunction.hpp>
+#include <vip/jit/components/String.hpp>
+#include <vip/jit/components/Array.hpp>
+#include <vip/jit/components/Map.hpp>
+#include <vip/ast/Consts.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+#include <vector>
+
+namespace jit
+{
+    namespace
+    {
+        Array &array(const Value &value)
+        {
+            auto array = cast<Array>(value);
+            if (array == nullptr)
+                throw std::runtime_error("Invalid type");
+            return *array;
+        }
+
+        double number(const Value &value)
+        {
+            if (value.isEmpty() || value.getKind() != consts::ID_NUMBER)
+                throw std::runtime_error("Invalid type");
+            return value.asNumber();
+        }
+
+        Map &map(const Value &value)
+        {
+            auto map = cast<Map>(value);
+            if (map == nullptr)
+                throw std::runtime_error("Invalid type");
+            return *map;
+        }
+
+        /// @brief a count given as a number, like the length of an array or the size hint of a map.
+        std::size_t count(const Value &value, const char *error)
+        {
+            double whole = number(value);
+            if (whole < 0 || std::trunc(whole) != whole || whole >= 18446744073709551616.0)
+                throw std::runtime_error(error);
+            return (std::size_t)whole;
+        }
+
+        /// @brief two arrays a bulk function works on pairwise.
+        void matching(const Array &lhs, const Array &rhs)
+        {
+            if (lhs.size() != rhs.size())
+                throw std::runtime_error("Arrays must have the same length.");
+        }
+
+        /// @brief a number that holds every whole double exactly stays an integer.
+        inline Value result(double value) { return intrinsics::number(value); }
+
+        /// @brief the builtin behind an intrinsic, reached when a call can not be evaluated in place.
+        template <unsigned int ID>
+        Value intrinsic(Arguments args)
+        {
+            Value value;
+            if (!intrinsics::apply(ID, args.begin(), args.size(), value))
+                throw std::runtime_error("Given params does not function sig.");
+            return value;
+        }
+
+        // array(length) and array(length, value), a new array with every element set to value or 0.
+        Value makeArray(Arguments args)
+        {
+            if (args.size() != 1 && args.size() != 2)
+                throw std::runtime_error("Given params does not function sig.");
+
+            auto length = count(args[0], "Array length must be a whole number.");
+            return Value(new Array(length, args.size() == 2 ? number(args[1]) : 0));
+        }
+
+        // map() and map(expected), a new map that takes expected entries before it grows.
+        Value makeMap(Arguments args)
+        {
+            if (args.size() > 1)
+                throw std::runtime_error("Given params does not function sig.");
+            return Value(new Map(args.empty() ? 0 : count(args[0], "Map size must be a whole number.")));
+        }
+
+        Value has(Arguments args)
+        {
+            return Value::boolean(map(args[0]).find(args[1]) != nullptr);
+        }
+
+        Value remove(Arguments args)
+        {
+            return Value::boolean(map(args[0]).remove(args[1]));
+        }
+
+        Value reserve(Arguments args)
+        {
+            map(args[0]).reserve(count(args[1], "Map size must be a whole number."));
+            return args[0];
+        }
+
+        Value len(Arguments args)
+        {
+            if (auto text = cast<String>(args[0]); text != nullptr)
+                return Value::integer((int64_t)text->size());
+            if (auto entries = cast<Map>(args[0]); entries != nullptr)
+                return Value::integer((int64_t)entries->size());
+            return Value::integer((int64_t)array(args[0]).size());
+        }
+
+        Value sum(Arguments args)
+        {
+            auto &values = array(args[0]);
+            return result(kernels::best().sum(values.getData(), values.size()));
+        }
+
+        // min(array) and max(array) run a kernel over the buffer, min(a, b, ...) picks a number.
+        Value min(Arguments args)
+        {
+            Value value;
+            if (!(args.size() == 1 && cast<Array>(args[0]) != nullptr))
+            {
+                if (!intrinsics::apply(ast::consts::INTRINSIC_MIN, args.begin(), args.size(), value))
+                    throw std::runtime_error("Invalid type");
+                return value;
+            }
+            auto &values = array(args[0]);
+            if (values.size() == 0)
+                throw std::runtime_error("Array is empty.");
+            return result(kernels::best().min(values.getData(), values.size()));
+        }
+
+        Value max(Arguments args)
+        {
+            Value value;
+            if (!(args.size() == 1 && cast<Array>(args[0]) != nullptr))
+            {
+                if (!intrinsics::apply(ast::consts::INTRINSIC_MAX, args.begin(), args.size(), value))
+                    throw std::runtime_error("Invalid type");
+                return value;
+            }
+            auto &values = array(args[0]);
+            if (values.size() == 0)
+                throw std::runtime_error("Array is empty.");
+            return result(kernels::best().max(values.getData(), values.size()));
+        }
+
+        Value dot(Arguments args)
+        {
+            auto &lhs = array(args[0]);
+            auto &rhs = array(args[1]);
+            matching(lhs, rhs);
+            return result(kernels::best().dot(lhs.getData(), rhs.getData(), lhs.size()));
+        }
+
+        Value scale(Arguments args)
+        {
+            auto &values = array(args[0]);
+            kernels::best().scale(values.getData(), values.size(), number(args[1]));
+            return args[0];
+        }
+
+        Value add(Arguments args)
+        {
+            auto &target = array(args[0]);
+            auto &source = array(args[1]);
+            matching(target, source);
+            kernels::best().add(target.getData(), source.getData(), target.size());
+            return args[0];
+        }
+
+        Value fill(Arguments args)
+        {
+            auto &values = array(args[0]);
+            kernels::best().fill(values.getData(), values.size(), number(args[1]));
+            return args[0];
+        }
+
+        Value sort(Arguments args)
+        {
+            auto &values = array(args[0]);
+            // NaN compares false with everything, so it is ordered last to keep the order strict.
+            std::sort(values.getData(), values.getData() + values.size(), [](double lhs, double rhs)
+                      { return lhs < rhs || (rhs != rhs && lhs == lhs); });
+            return args[0];
+        }
+    } // namespace
+
+    Builtins::Builtins()
+    {
+        auto define = [this](const char *name, Signature signature, Value (*function)(Arguments))
+        {
+            functions.emplace(name, Value(new InternalFunction(name, std::move(signature), function)));
+        };
+
+        const auto ANY = Signature::ANY;
+        const auto NUMBER = consts::ID_NUMBER;
+        const auto STRING = consts::ID_STRING;
+        const auto ARRAY = consts::ID_ARRAY;
+        const auto MAP = consts::ID_MAP;
+
+        // the signature checks the arguments, the functions only check what it can not say.
+        define("array", {{NUMBER}, true}, makeArray);
+        define("len", {{ANY}}, len);
+        define("sum", {{ARRAY}}, sum);
+        define("min", {{ANY}, true}, min);
+        define("max", {{ANY}, true}, max);
+        define("dot", {{ARRAY, ARRAY}}, dot);
+        define("scale", {{ARRAY, NUMBER}}, scale);
+        define("add", {{ARRAY, ARRAY}}, add);
+        define("fill", {{ARRAY, NUMBER}}, fill);
+        define("sort", {{ARRAY}}, sort);
+        define("sqrt", {{NUMBER}}, intrinsic<ast::consts::INTRINSIC_SQRT>);
+        define("abs", {{NUMBER}}, intrinsic<ast::consts::INTRINSIC_ABS>);
+        define("floor", {{NUMBER}}, intrinsic<ast::consts::INTRINSIC_FLOOR>);
+        define("substr", {{STRING, NUMBER}, true}, intrinsic<ast::consts::INTRINSIC_SUBSTR>);
+        define("charAt", {{STRING, NUMBER}}, intrinsic<ast::consts::INTRINSIC_CHAR_AT>);
+        define("map", {{}, true}, makeMap);
+        define("has", {{MAP, ANY}}, has);
+        define("remove", {{MAP, ANY}}, remove);
+        define("reserve", {{MAP, NUMBER}}, reserve);
+    }
+} // namespace jit
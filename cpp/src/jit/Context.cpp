@@ -3,10 +3,49 @@
 
 namespace jit
 {
+    std::atomic<unsigned long> Context::stamps{0};
+
+    Context::Context(std::unique_ptr<Region> region, const char *name, Context *ctx, bool returnable, const std::string *detail)
+        : name(name), detail(detail), parent(ctx), root(ctx == nullptr ? this : ctx->root), region(std::move(region)), variables(RegionAllocator<Variables::value_type>(this->region.get())), returnable(returnable), version(++stamps)
+    {
+    }
+
     Context::~Context()
     {
         variables.clear();
     }
+    void Context::reset(const char *name, Context *ctx, bool returnable, const std::string *detail)
+    {
+        this->name = name;
+        this->detail = detail;
+        this->returnable = returnable;
+        parent = ctx;
+        root = ctx == nullptr ? this : ctx->root;
+        clear();
+    }
+
+    void Context::clear()
+    {
+        variables.clear();
+        if (region != nullptr)
+            region->reset();
+    }
+
+    void Context::forEach(const std::function<void(const std::string &, const Value &)> &visit) const
+    {
+        for (auto &&binding : variables)
+            visit(binding.first, binding.second);
+    }
+
+    std::string Context::getName() const
+    {
+        // "<function>" about main reads "<function main>".
+        std::string value = name;
+        if (detail != nullptr && !value.empty())
+            value.insert(value.size() - 1, " " + *detail);
+        return value;
+    }
+
     Context *Context::getParentContext()
     {
         return parent;
@@ -14,36 +53,47 @@ namespace jit
 
     bool Context::remove(std::string key)
     {
-        return variables.erase(key) == 1;
+        if (variables.erase(key) == 0)
+            return false;
+
+        if (root == this)
+            version = ++stamps;
+        return true;
     }
     bool Context::has(std::string key)
     {
         return variables.find(key) != variables.end();
     }
 
-    std::shared_ptr<Object> Context::set(std::string key, std::shared_ptr<Object> value)
+    Value Context::set(std::string key, Value value)
     {
-        variables.insert({key, std::move(value)});
+        // a local binding hides the root one from everything that runs below this context.
+        if (root != this && root->has(key))
+            root->version = ++stamps;
+
+        // a new root binding may take a name that was unbound so far, like the name of an intrinsic.
+        if (variables.insert({key, std::move(value)}).second && root == this)
+            version = ++stamps;
         return variables.at(key);
     }
 
-    std::shared_ptr<Object> Context::update(std::string key, std::shared_ptr<Object> value)
+    Value Context::update(std::string key, Value value)
     {
         if (has(key))
         {
             variables[key] = value;
-            return variables.at(key);
+            return value;
         }
 
         if (parent != nullptr)
         {
-            return parent->update(key, value);
+            return parent->update(key, std::move(value));
         }
 
-        return nullptr;
+        return Value();
     }
 
-    std::shared_ptr<Object> Context::get(std::string key)
+    Value Context::get(std::string key)
     {
         if (has(key))
         {
@@ -55,6 +105,50 @@ namespace jit
             return parent->get(key);
         }
 
+        return Value();
+    }
+
+    void Context::absorb(Context &scope)
+    {
+        for (auto &&entry : scope.variables)
+        {
+            if (root != this ? root->has(entry.first) : !has(entry.first))
+                root->version = ++stamps;
+
+            variables[entry.first] = entry.second;
+        }
+    }
+
+    Value *Context::lookup(const std::string &key, bool &global)
+    {
+        for (auto scope = this; scope != nullptr; scope = scope->parent)
+        {
+            if (auto it = scope->variables.find(key); it != scope->variables.end())
+            {
+                global = scope == root;
+                return &it->second;
+            }
+        }
+
         return nullptr;
     }
+
+    Context *ContextStack::push(const char *name, Context *parent, bool returnable, const std::string *detail)
+    {
+        if (depth == contexts.size())
+        {
+            contexts.emplace_back(new Context(std::make_unique<Region>(), name, parent, returnable, detail));
+            return contexts[depth++].get();
+        }
+
+        auto context = contexts[depth++].get();
+        context->reset(name, parent, returnable, detail);
+        return context;
+    }
+
+    void ContextStack::pop()
+    {
+        // values are released as soon as their scope ends, not when the context is reused.
+        contexts[--depth]->clear();
+    }
 } // namespace jit
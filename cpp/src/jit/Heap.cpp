@@ -0,0 +1,195 @@
+#include <vip/jit/Heap.hpp>
+#include <vip/jit/Value.hpp>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace jit
+{
+    thread_local Heap *Heap::active = nullptr;
+
+    /// @brief takes the references the collected objects hold to each other off their counts.
+    class Heap::Subtract : public Tracer
+    {
+    private:
+        Heap &heap;
+        unsigned int upto;
+
+    public:
+        Subtract(Heap &heap, unsigned int upto) : heap(heap), upto(upto) {}
+        void visit(Value &child) override
+        {
+            if (auto object = child.getObject(); heap.owns(object, upto))
+                object->scratch--;
+        }
+    };
+
+    /// @brief marks what a reachable object holds as reachable too.
+    class Heap::Reach : public Tracer
+    {
+    private:
+        Heap &heap;
+        unsigned int upto;
+        std::vector<Object *> &work;
+
+    public:
+        Reach(Heap &heap, unsigned int upto, std::vector<Object *> &work) : heap(heap), upto(upto), work(work) {}
+        void visit(Value &child) override
+        {
+            if (auto object = child.getObject(); heap.owns(object, upto) && object->scratch == 0)
+            {
+                object->scratch = 1;
+                work.push_back(object);
+            }
+        }
+    };
+
+    /// @brief lets go of everything an object holds, which breaks the cycles it is part of.
+    class Heap::Clear : public Tracer
+    {
+    public:
+        void visit(Value &child) override { child = Value(); }
+    };
+
+    Heap::~Heap()
+    {
+        collect(true);
+
+        // what is left is held from outside, like a value handed out through the api, and lives on untracked.
+        for (auto generation : {YOUNG, OLD, ACYCLIC})
+        {
+            while (auto object = generations[generation])
+            {
+                unlink(object);
+                object->heap = nullptr;
+            }
+        }
+    }
+
+    void Heap::link(Object *object, unsigned int generation)
+    {
+        object->generation = generation;
+        object->prev = nullptr;
+        object->next = generations[generation];
+        if (object->next != nullptr)
+            object->next->prev = object;
+        generations[generation] = object;
+        counts[generation]++;
+    }
+
+    void Heap::unlink(Object *object)
+    {
+        if (object->prev != nullptr)
+            object->prev->next = object->next;
+        else
+            generations[object->generation] = object->next;
+        if (object->next != nullptr)
+            object->next->prev = object->prev;
+        object->prev = nullptr;
+        object->next = nullptr;
+        counts[object->generation]--;
+    }
+
+    void Heap::track(Object *object)
+    {
+        object->heap = this;
+        link(object, object->cyclic ? YOUNG : ACYCLIC);
+        stats.allocated++;
+    }
+
+    void Heap::untrack(Object *object)
+    {
+        unlink(object);
+    }
+
+    void Heap::collect(bool major)
+    {
+        auto start = std::chrono::steady_clock::now();
+        unsigned int upto = major ? OLD : YOUNG;
+
+        // an object no value holds yet is still being set up by C++ code, so it counts as held.
+        for (unsigned int generation = YOUNG; generation <= upto; generation++)
+        {
+            for (auto object = generations[generation]; object != nullptr; object = object->next)
+                object->scratch = object->refs == 0 ? 1 : object->refs;
+        }
+
+        Subtract subtract(*this, upto);
+        for (unsigned int generation = YOUNG; generation <= upto; generation++)
+        {
+            for (auto object = generations[generation]; object != nullptr; object = object->next)
+                object->trace(subtract);
+        }
+
+        // references left over come from outside the collected generations, those objects are the roots.
+        std::vector<Object *> work;
+        for (unsigned int generation = YOUNG; generation <= upto; generation++)
+        {
+            for (auto object = generations[generation]; object != nullptr; object = object->next)
+            {
+                if (object->scratch > 0)
+                    work.push_back(object);
+            }
+        }
+        Reach reach(*this, upto, work);
+        while (!work.empty())
+        {
+            auto object = work.back();
+            work.pop_back();
+            object->trace(reach);
+        }
+
+        std::vector<Object *> garbage;
+        for (unsigned int generation = YOUNG; generation <= upto; generation++)
+        {
+            for (auto object = generations[generation]; object != nullptr; object = object->next)
+            {
+                if (object->scratch == 0)
+                    garbage.push_back(object);
+            }
+        }
+
+        // the garbage is held while it is broken up, so none of it is freed while it is still being cleared.
+        for (auto object : garbage)
+            object->retain();
+        Clear clear;
+        for (auto object : garbage)
+            object->trace(clear);
+        for (auto object : garbage)
+            object->release();
+        stats.collected += garbage.size();
+
+        // what is still young survived, so it moves to the old generation.
+        while (auto object = generations[YOUNG])
+        {
+            unlink(object);
+            link(object, OLD);
+            stats.promoted++;
+        }
+
+        if (major)
+        {
+            stats.majorCollections++;
+            minorsSinceMajor = 0;
+            oldAfterMajor = counts[OLD];
+        }
+        else
+        {
+            stats.minorCollections++;
+            minorsSinceMajor++;
+        }
+
+        double pause = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        stats.totalPause += pause;
+        stats.maxPause = std::max(stats.maxPause, pause);
+    }
+
+    HeapStats Heap::getStats() const
+    {
+        auto current = stats;
+        current.young = counts[YOUNG];
+        current.old = counts[OLD];
+        current.acyclic = counts[ACYCLIC];
+        return current;
+    }
+} // namespace jit
@@ -0,0 +1,54 @@
+#include <vip/jit/Interner.hpp>
+#include <vip/jit/components/String.hpp>
+#include <functional>
+#include <utility>
+
+namespace jit
+{
+    std::atomic<unsigned long> Interner::ids{0};
+
+    void Interner::grow()
+    {
+        std::vector<Value> old(slots.size() * 2);
+        old.swap(slots);
+        for (auto &&value : old)
+        {
+            if (value.isEmpty())
+                continue;
+            auto index = cast<String>(value)->hash() & (slots.size() - 1);
+            while (!slots[index].isEmpty())
+                index = (index + 1) & (slots.size() - 1);
+            slots[index] = std::move(value);
+        }
+    }
+
+    const Value &Interner::intern(std::string_view text)
+    {
+        // kept at most half full, so a probe ends at a free slot soon.
+        if (2 * (count + 1) > slots.size())
+            grow();
+
+        auto hash = std::hash<std::string_view>{}(text);
+        auto index = hash & (slots.size() - 1);
+        while (!slots[index].isEmpty())
+        {
+            auto string = cast<String>(slots[index]);
+            if (string->hash() == hash && string->view() == text)
+                return slots[index];
+            index = (index + 1) & (slots.size() - 1);
+        }
+
+        auto string = new String(std::string(text));
+        string->internedBy = id;
+        slots[index] = Value(string);
+        count++;
+        return slots[index];
+    }
+
+    void Interner::forEach(const std::function<void(const Value &)> &visit) const
+    {
+        for (auto &&slot : slots)
+            if (!slot.isEmpty())
+                visit(slot);
+    }
+} // namespace jit
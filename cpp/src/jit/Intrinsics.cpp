@@ -0,0 +1,138 @@
+#include <vip/jit/Intrinsics.hpp>
+#include <vip/jit/components/String.hpp>
+#include <vip/jit/components/Array.hpp>
+#include <vip/jit/components/Map.hpp>
+#include <vip/jit/Consts.hpp>
+#include <vip/ast/Consts.hpp>
+#include <stdexcept>
+#include <cstdint>
+#include <cmath>
+
+namespace jit
+{
+    namespace intrinsics
+    {
+        namespace
+        {
+            inline bool isNumber(const Value &value) { return value.getKind() == consts::ID_NUMBER; }
+
+            /// @brief a position in a string of length chars, end may be length itself.
+            std::size_t position(const Value &value, std::size_t length, bool end)
+            {
+                double at = value.asNumber();
+                if (std::trunc(at) != at || at < 0 || at > (double)length || (!end && at == (double)length))
+                    throw std::runtime_error("Index out of range.");
+                return (std::size_t)at;
+            }
+
+            /// @brief length chars of base from offset on, short text is copied instead of sliced.
+            Value slice(const Value &base, std::size_t offset, std::size_t length)
+            {
+                auto &text = *static_cast<String *>(base.getObject());
+                if (length == text.size())
+                    return base;
+                if (length < consts::ROPE_MIN_LENGTH)
+                    return Value(new String(text.view().substr(offset, length)));
+                return Value(new String(base, offset, length));
+            }
+
+            /// @brief min or max of numbers, the value itself is kept so integers stay integers. NaN
+            /// anywhere makes the result NaN, like the kernels for arrays.
+            bool pick(const Value *args, std::size_t count, bool max, Value &result)
+            {
+                if (count == 0)
+                    return false;
+                for (std::size_t i = 0; i < count; i++)
+                    if (!isNumber(args[i]))
+                        return false;
+
+                auto best = &args[0];
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    auto number = args[i].asNumber();
+                    if (std::isnan(number))
+                    {
+                        best = &args[i];
+                        break;
+                    }
+                    if (max ? number > best->asNumber() : number < best->asNumber())
+                        best = &args[i];
+                }
+                result = *best;
+                return true;
+            }
+        } // namespace
+
+        Value number(double value)
+        {
+            if (value == std::trunc(value) && std::fabs(value) <= 9007199254740992.0 && !(value == 0 && std::signbit(value)))
+                return Value::integer((int64_t)value);
+            return Value(value);
+        }
+
+        bool apply(unsigned int id, const Value *args, std::size_t count, Value &result)
+        {
+            switch (id)
+            {
+            case ast::consts::INTRINSIC_SQRT:
+                if (count != 1 || !isNumber(args[0]))
+                    return false;
+                result = number(std::sqrt(args[0].asNumber()));
+                return true;
+            case ast::consts::INTRINSIC_ABS:
+                if (count != 1 || !isNumber(args[0]))
+                    return false;
+                if (args[0].isInteger() && args[0].asInteger() != INT64_MIN)
+                    result = args[0].asInteger() < 0 ? Value::integer(-args[0].asInteger()) : args[0];
+                else
+                    result = Value(std::fabs(args[0].asNumber()));
+                return true;
+            case ast::consts::INTRINSIC_FLOOR:
+                if (count != 1 || !isNumber(args[0]))
+                    return false;
+                result = args[0].isInteger() ? args[0] : number(std::floor(args[0].asNumber()));
+                return true;
+            case ast::consts::INTRINSIC_MIN:
+                return pick(args, count, false, result);
+            case ast::consts::INTRINSIC_MAX:
+                return pick(args, count, true, result);
+            case ast::consts::INTRINSIC_LEN:
+            {
+                if (count != 1)
+                    return false;
+                if (auto text = cast<String>(args[0]); text != nullptr)
+                    result = Value::integer((int64_t)text->size());
+                else if (auto values = cast<Array>(args[0]); values != nullptr)
+                    result = Value::integer((int64_t)values->size());
+                else if (auto entries = cast<Map>(args[0]); entries != nullptr)
+                    result = Value::integer((int64_t)entries->size());
+                else
+                    return false;
+                return true;
+            }
+            case ast::consts::INTRINSIC_SUBSTR:
+            {
+                // substr(text, start) runs to the end, substr(text, start, length) takes length chars.
+                if ((count != 2 && count != 3) || cast<String>(args[0]) == nullptr || !isNumber(args[1]) || (count == 3 && !isNumber(args[2])))
+                    return false;
+                auto size = cast<String>(args[0])->size();
+                auto start = position(args[1], size, true);
+                auto length = count == 3 ? position(args[2], size - start, true) : size - start;
+                result = slice(args[0], start, length);
+                return true;
+            }
+            case ast::consts::INTRINSIC_CHAR_AT:
+            {
+                if (count != 2 || cast<String>(args[0]) == nullptr || !isNumber(args[1]))
+                    return false;
+                auto &text = *cast<String>(args[0]);
+                auto at = position(args[1], text.size(), false);
+                result = slice(args[0], at, 1);
+                return true;
+            }
+            default:
+                return false;
+            }
+        }
+    } // namespace intrinsics
+} // namespace jit
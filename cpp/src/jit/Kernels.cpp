@@ -0,0 +1,315 @@
+#include <vip/jit/Kernels.hpp>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define VIP_KERNELS_SSE2
+#if defined(__GNUC__) || defined(__clang__)
+#define VIP_KERNELS_AVX2
+#endif
+#endif
+
+namespace jit
+{
+    namespace kernels
+    {
+        namespace
+        {
+            double sumScalar(const double *data, std::size_t count)
+            {
+                double sum = 0;
+                for (std::size_t i = 0; i < count; i++)
+                    sum += data[i];
+                return sum;
+            }
+            const double NOT_A_NUMBER = std::numeric_limits<double>::quiet_NaN();
+
+            // min and max are NaN as soon as an element is, like any other arithmetic on NaN.
+            double minScalar(const double *data, std::size_t count)
+            {
+                double min = data[0];
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    if (std::isnan(data[i]))
+                        return NOT_A_NUMBER;
+                    min = data[i] < min ? data[i] : min;
+                }
+                return min;
+            }
+            double maxScalar(const double *data, std::size_t count)
+            {
+                double max = data[0];
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    if (std::isnan(data[i]))
+                        return NOT_A_NUMBER;
+                    max = data[i] > max ? data[i] : max;
+                }
+                return max;
+            }
+            double dotScalar(const double *lhs, const double *rhs, std::size_t count)
+            {
+                double sum = 0;
+                for (std::size_t i = 0; i < count; i++)
+                    sum += lhs[i] * rhs[i];
+                return sum;
+            }
+            void scaleScalar(double *data, std::size_t count, double factor)
+            {
+                for (std::size_t i = 0; i < count; i++)
+                    data[i] *= factor;
+            }
+            void addScalar(double *target, const double *source, std::size_t count)
+            {
+                for (std::size_t i = 0; i < count; i++)
+                    target[i] += source[i];
+            }
+            void fillScalar(double *data, std::size_t count, double value)
+            {
+                for (std::size_t i = 0; i < count; i++)
+                    data[i] = value;
+            }
+
+            const Table SCALAR = {"scalar", sumScalar, minScalar, maxScalar, dotScalar, scaleScalar, addScalar, fillScalar};
+
+#ifdef VIP_KERNELS_SSE2
+            // sse2 is part of x86-64, so these need no check. Two registers per step keep two adds in flight.
+            inline double lanes(__m128d vector, double (*combine)(double, double))
+            {
+                double parts[2];
+                _mm_storeu_pd(parts, vector);
+                return combine(parts[0], parts[1]);
+            }
+            inline double plus(double lhs, double rhs) { return lhs + rhs; }
+            // a NaN on either side wins, the vector min and max only keep one of their operands.
+            inline double less(double lhs, double rhs) { return rhs < lhs || std::isnan(rhs) ? rhs : lhs; }
+            inline double greater(double lhs, double rhs) { return rhs > lhs || std::isnan(rhs) ? rhs : lhs; }
+
+            double sumSse2(const double *data, std::size_t count)
+            {
+                __m128d first = _mm_setzero_pd(), second = _mm_setzero_pd();
+                std::size_t i = 0;
+                for (; i + 4 <= count; i += 4)
+                {
+                    first = _mm_add_pd(first, _mm_loadu_pd(data + i));
+                    second = _mm_add_pd(second, _mm_loadu_pd(data + i + 2));
+                }
+                double sum = lanes(_mm_add_pd(first, second), plus);
+                for (; i < count; i++)
+                    sum += data[i];
+                return sum;
+            }
+            double minSse2(const double *data, std::size_t count)
+            {
+                __m128d result = _mm_set1_pd(data[0]);
+                __m128d unordered = _mm_setzero_pd();
+                std::size_t i = 0;
+                for (; i + 2 <= count; i += 2)
+                {
+                    __m128d values = _mm_loadu_pd(data + i);
+                    result = _mm_min_pd(result, values);
+                    unordered = _mm_or_pd(unordered, _mm_cmpunord_pd(values, values));
+                }
+                if (_mm_movemask_pd(unordered) != 0)
+                    return NOT_A_NUMBER;
+                double min = lanes(result, less);
+                for (; i < count; i++)
+                    min = less(min, data[i]);
+                return min;
+            }
+            double maxSse2(const double *data, std::size_t count)
+            {
+                __m128d result = _mm_set1_pd(data[0]);
+                __m128d unordered = _mm_setzero_pd();
+                std::size_t i = 0;
+                for (; i + 2 <= count; i += 2)
+                {
+                    __m128d values = _mm_loadu_pd(data + i);
+                    result = _mm_max_pd(result, values);
+                    unordered = _mm_or_pd(unordered, _mm_cmpunord_pd(values, values));
+                }
+                if (_mm_movemask_pd(unordered) != 0)
+                    return NOT_A_NUMBER;
+                double max = lanes(result, greater);
+                for (; i < count; i++)
+                    max = greater(max, data[i]);
+                return max;
+            }
+            double dotSse2(const double *lhs, const double *rhs, std::size_t count)
+            {
+                __m128d first = _mm_setzero_pd(), second = _mm_setzero_pd();
+                std::size_t i = 0;
+                for (; i + 4 <= count; i += 4)
+                {
+                    first = _mm_add_pd(first, _mm_mul_pd(_mm_loadu_pd(lhs + i), _mm_loadu_pd(rhs + i)));
+                    second = _mm_add_pd(second, _mm_mul_pd(_mm_loadu_pd(lhs + i + 2), _mm_loadu_pd(rhs + i + 2)));
+                }
+                double sum = lanes(_mm_add_pd(first, second), plus);
+                for (; i < count; i++)
+                    sum += lhs[i] * rhs[i];
+                return sum;
+            }
+            void scaleSse2(double *data, std::size_t count, double factor)
+            {
+                __m128d by = _mm_set1_pd(factor);
+                std::size_t i = 0;
+                for (; i + 2 <= count; i += 2)
+                    _mm_storeu_pd(data + i, _mm_mul_pd(_mm_loadu_pd(data + i), by));
+                for (; i < count; i++)
+                    data[i] *= factor;
+            }
+            void addSse2(double *target, const double *source, std::size_t count)
+            {
+                std::size_t i = 0;
+                for (; i + 2 <= count; i += 2)
+                    _mm_storeu_pd(target + i, _mm_add_pd(_mm_loadu_pd(target + i), _mm_loadu_pd(source + i)));
+                for (; i < count; i++)
+                    target[i] += source[i];
+            }
+            void fillSse2(double *data, std::size_t count, double value)
+            {
+                __m128d fill = _mm_set1_pd(value);
+                std::size_t i = 0;
+                for (; i + 2 <= count; i += 2)
+                    _mm_storeu_pd(data + i, fill);
+                for (; i < count; i++)
+                    data[i] = value;
+            }
+
+            const Table SSE2 = {"sse2", sumSse2, minSse2, maxSse2, dotSse2, scaleSse2, addSse2, fillSse2};
+#endif
+
+#ifdef VIP_KERNELS_AVX2
+            // compiled for avx2 whatever the flags of the build, only called once the cpu reported it.
+#define VIP_AVX2 __attribute__((target("avx2")))
+
+            VIP_AVX2 inline __m128d fold(__m256d vector)
+            {
+                return _mm_add_pd(_mm256_castpd256_pd128(vector), _mm256_extractf128_pd(vector, 1));
+            }
+
+            VIP_AVX2 double sumAvx2(const double *data, std::size_t count)
+            {
+                __m256d first = _mm256_setzero_pd(), second = _mm256_setzero_pd();
+                std::size_t i = 0;
+                for (; i + 8 <= count; i += 8)
+                {
+                    first = _mm256_add_pd(first, _mm256_loadu_pd(data + i));
+                    second = _mm256_add_pd(second, _mm256_loadu_pd(data + i + 4));
+                }
+                double sum = lanes(fold(_mm256_add_pd(first, second)), plus);
+                for (; i < count; i++)
+                    sum += data[i];
+                return sum;
+            }
+            VIP_AVX2 double minAvx2(const double *data, std::size_t count)
+            {
+                __m256d result = _mm256_set1_pd(data[0]);
+                __m256d unordered = _mm256_setzero_pd();
+                std::size_t i = 0;
+                for (; i + 4 <= count; i += 4)
+                {
+                    __m256d values = _mm256_loadu_pd(data + i);
+                    result = _mm256_min_pd(result, values);
+                    unordered = _mm256_or_pd(unordered, _mm256_cmp_pd(values, values, _CMP_UNORD_Q));
+                }
+                if (_mm256_movemask_pd(unordered) != 0)
+                    return NOT_A_NUMBER;
+                __m128d half = _mm_min_pd(_mm256_castpd256_pd128(result), _mm256_extractf128_pd(result, 1));
+                double min = lanes(half, less);
+                for (; i < count; i++)
+                    min = less(min, data[i]);
+                return min;
+            }
+            VIP_AVX2 double maxAvx2(const double *data, std::size_t count)
+            {
+                __m256d result = _mm256_set1_pd(data[0]);
+                __m256d unordered = _mm256_setzero_pd();
+                std::size_t i = 0;
+                for (; i + 4 <= count; i += 4)
+                {
+                    __m256d values = _mm256_loadu_pd(data + i);
+                    result = _mm256_max_pd(result, values);
+                    unordered = _mm256_or_pd(unordered, _mm256_cmp_pd(values, values, _CMP_UNORD_Q));
+                }
+                if (_mm256_movemask_pd(unordered) != 0)
+                    return NOT_A_NUMBER;
+                __m128d half = _mm_max_pd(_mm256_castpd256_pd128(result), _mm256_extractf128_pd(result, 1));
+                double max = lanes(half, greater);
+                for (; i < count; i++)
+                    max = greater(max, data[i]);
+                return max;
+            }
+            VIP_AVX2 double dotAvx2(const double *lhs, const double *rhs, std::size_t count)
+            {
+                // no fused multiply add, so every product rounds like it does in the other sets.
+                __m256d first = _mm256_setzero_pd(), second = _mm256_setzero_pd();
+                std::size_t i = 0;
+                for (; i + 8 <= count; i += 8)
+                {
+                    first = _mm256_add_pd(first, _mm256_mul_pd(_mm256_loadu_pd(lhs + i), _mm256_loadu_pd(rhs + i)));
+                    second = _mm256_add_pd(second, _mm256_mul_pd(_mm256_loadu_pd(lhs + i + 4), _mm256_loadu_pd(rhs + i + 4)));
+                }
+                double sum = lanes(fold(_mm256_add_pd(first, second)), plus);
+                for (; i < count; i++)
+                    sum += lhs[i] * rhs[i];
+                return sum;
+            }
+            VIP_AVX2 void scaleAvx2(double *data, std::size_t count, double factor)
+            {
+                __m256d by = _mm256_set1_pd(factor);
+                std::size_t i = 0;
+                for (; i + 4 <= count; i += 4)
+                    _mm256_storeu_pd(data + i, _mm256_mul_pd(_mm256_loadu_pd(data + i), by));
+                for (; i < count; i++)
+                    data[i] *= factor;
+            }
+            VIP_AVX2 void addAvx2(double *target, const double *source, std::size_t count)
+            {
+                std::size_t i = 0;
+                for (; i + 4 <= count; i += 4)
+                    _mm256_storeu_pd(target + i, _mm256_add_pd(_mm256_loadu_pd(target + i), _mm256_loadu_pd(source + i)));
+                for (; i < count; i++)
+                    target[i] += source[i];
+            }
+            VIP_AVX2 void fillAvx2(double *data, std::size_t count, double value)
+            {
+                __m256d fill = _mm256_set1_pd(value);
+                std::size_t i = 0;
+                for (; i + 4 <= count; i += 4)
+                    _mm256_storeu_pd(data + i, fill);
+                for (; i < count; i++)
+                    data[i] = value;
+            }
+#undef VIP_AVX2
+
+            const Table AVX2 = {"avx2", sumAvx2, minAvx2, maxAvx2, dotAvx2, scaleAvx2, addAvx2, fillAvx2};
+#endif
+
+            const Table &select()
+            {
+#ifdef VIP_KERNELS_AVX2
+                if (__builtin_cpu_supports("avx2"))
+                    return AVX2;
+#endif
+#ifdef VIP_KERNELS_SSE2
+                return SSE2;
+#else
+                return SCALAR;
+#endif
+            }
+        } // namespace
+
+        const Table &scalar()
+        {
+            return SCALAR;
+        }
+
+        const Table &best()
+        {
+            static const Table &table = select();
+            return table;
+        }
+    } // namespace kernels
+} // namespace jit
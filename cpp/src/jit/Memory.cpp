@@ -0,0 +1,180 @@
+#include <vip/jit/Memory.hpp>
+#include <vip/jit/Consts.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+namespace jit
+{
+    struct Memory::Account
+    {
+        std::size_t current = 0;
+        std::size_t peak = 0;
+        std::size_t soft = 0;
+        std::size_t hard = 0;
+        unsigned long refused = 0;
+        std::function<void(std::size_t)> onSoftLimit;
+        Allocator allocator;
+        /// @brief has the soft limit been reported since usage last was below it.
+        bool overSoft = false;
+        /// @brief the memory is gone, the account is freed with the last allocation charged to it.
+        bool closed = false;
+    };
+
+    thread_local Memory::Account *Memory::active = nullptr;
+
+    namespace
+    {
+        /// @brief in front of every allocation. The account is tagged with the log2 of the padding
+        /// in front of the allocation over 16, the padding is the alignment or the header if that is larger.
+        struct Header
+        {
+            std::uintptr_t account;
+            std::size_t bytes;
+        };
+
+        static_assert(sizeof(Header) == 16, "The header has to leave allocations aligned for any type.");
+
+        constexpr std::uintptr_t TAG = 7;
+
+        inline std::size_t padding(std::size_t align) { return std::max(align, sizeof(Header)); }
+
+        inline Header *header(void *pointer) { return static_cast<Header *>(pointer) - 1; }
+        inline const Header *header(const void *pointer) { return static_cast<const Header *>(pointer) - 1; }
+    } // namespace
+
+    Memory::Memory() : account(new Account()) {}
+
+    Memory::~Memory()
+    {
+        account->closed = true;
+        account->onSoftLimit = nullptr;
+        if (account->current == 0)
+            delete account;
+    }
+
+    void Memory::setSoftLimit(std::size_t bytes, std::function<void(std::size_t)> callback)
+    {
+        account->soft = bytes;
+        account->onSoftLimit = std::move(callback);
+        account->overSoft = bytes != 0 && account->current >= bytes;
+    }
+
+    void Memory::setHardLimit(std::size_t bytes)
+    {
+        account->hard = bytes;
+    }
+
+    void Memory::setAllocator(Allocator allocator)
+    {
+        if (account->current != 0)
+            throw std::runtime_error("The allocator can only be set before anything is allocated.");
+        if (!allocator.allocate != !allocator.deallocate)
+            throw std::runtime_error("An allocator needs both allocate and deallocate.");
+        account->allocator = std::move(allocator);
+    }
+
+    MemoryStats Memory::getStats() const
+    {
+        MemoryStats stats;
+        stats.current = account->current;
+        stats.peak = account->peak;
+        stats.softLimit = account->soft;
+        stats.hardLimit = account->hard;
+        stats.refused = account->refused;
+        return stats;
+    }
+
+    void Memory::charge(Account *account, std::size_t bytes)
+    {
+        if (account->hard != 0 && (bytes > account->hard || account->current > account->hard - bytes))
+        {
+            account->refused++;
+            throw MemoryLimitError();
+        }
+
+        account->current += bytes;
+        account->peak = std::max(account->peak, account->current);
+        if (account->soft != 0 && !account->overSoft && account->current >= account->soft)
+        {
+            account->overSoft = true;
+            if (account->onSoftLimit)
+                account->onSoftLimit(account->current);
+        }
+    }
+
+    void Memory::credit(Account *account, std::size_t bytes) noexcept
+    {
+        account->current -= bytes;
+        if (account->overSoft && account->current < account->soft)
+            account->overSoft = false;
+        if (account->closed && account->current == 0)
+            delete account;
+    }
+
+    void *Memory::allocate(std::size_t bytes, std::size_t align)
+    {
+        if (align > consts::MEMORY_MAX_ALIGNMENT || (align & (align - 1)) != 0)
+            throw std::bad_alloc();
+
+        auto pad = padding(align);
+        if (bytes > SIZE_MAX - pad)
+            throw std::bad_alloc();
+        auto total = bytes + pad;
+
+        auto account = active;
+        if (account != nullptr)
+            charge(account, total);
+
+        void *base;
+        try
+        {
+            if (account != nullptr && account->allocator.allocate)
+            {
+                base = account->allocator.allocate(total, pad);
+                if (base == nullptr)
+                    throw std::bad_alloc();
+            }
+            else
+                base = pad > __STDCPP_DEFAULT_NEW_ALIGNMENT__ ? ::operator new(total, std::align_val_t(pad)) : ::operator new(total);
+        }
+        catch (...)
+        {
+            if (account != nullptr)
+                credit(account, total);
+            throw;
+        }
+
+        std::uintptr_t log = 0;
+        while ((sizeof(Header) << log) < pad)
+            log++;
+
+        auto pointer = static_cast<char *>(base) + pad;
+        *header(pointer) = Header{reinterpret_cast<std::uintptr_t>(account) | log, total};
+        return pointer;
+    }
+
+    void Memory::deallocate(void *pointer) noexcept
+    {
+        if (pointer == nullptr)
+            return;
+
+        auto found = *header(pointer);
+        auto pad = sizeof(Header) << (found.account & TAG);
+        auto base = static_cast<char *>(pointer) - pad;
+        auto account = reinterpret_cast<Account *>(found.account & ~TAG);
+        if (account != nullptr && account->allocator.deallocate)
+            account->allocator.deallocate(base, found.bytes, pad);
+        else if (pad > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            ::operator delete(base, std::align_val_t(pad));
+        else
+            ::operator delete(base);
+
+        if (account != nullptr)
+            credit(account, found.bytes);
+    }
+
+    std::size_t Memory::size(const void *pointer) noexcept
+    {
+        return pointer != nullptr ? header(pointer)->bytes : 0;
+    }
+} // namespace jit
@@ -0,0 +1,23 @@
+#include <vip/jit/Object.hpp>
+#include <vip/jit/Heap.hpp>
+
+namespace jit
+{
+    Object::Object(unsigned int kind, bool cyclic) : kind(kind), cyclic(cyclic)
+    {
+        if (auto heap = Heap::current(); heap != nullptr)
+            heap->track(this);
+    }
+
+    Object::Object(const Object &other) : kind(other.kind), cyclic(other.cyclic)
+    {
+        if (auto heap = Heap::current(); heap != nullptr)
+            heap->track(this);
+    }
+
+    Object::~Object()
+    {
+        if (heap != nullptr)
+            heap->untrack(this);
+    }
+} // namespace jit
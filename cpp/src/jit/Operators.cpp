@@ -0,0 +1,353 @@
+#include <vip/jit/Operators.hpp>
+#include <stdexcept>
+#include <cstdint>
+#include <cmath>
+
+#include <vip/jit/components/String.hpp>
+#include <vip/jit/components/Array.hpp>
+#include <vip/jit/components/Map.hpp>
+
+namespace jit
+{
+    namespace operators
+    {
+        namespace
+        {
+            typedef std::array<Kernel, consts::ID_COUNT * consts::ID_COUNT * OP_COUNT> Table;
+
+            inline const String &text(const Value &value) { return *static_cast<String *>(value.getObject()); }
+
+            /// @brief checked integer arithmetic, false if the result does not fit 64 bits.
+            inline bool add(int64_t lhs, int64_t rhs, int64_t &result)
+            {
+#if defined(__GNUC__) || defined(__clang__)
+                return !__builtin_add_overflow(lhs, rhs, &result);
+#else
+                if ((rhs > 0 && lhs > INT64_MAX - rhs) || (rhs < 0 && lhs < INT64_MIN - rhs))
+                    return false;
+                result = lhs + rhs;
+                return true;
+#endif
+            }
+            inline bool subtract(int64_t lhs, int64_t rhs, int64_t &result)
+            {
+#if defined(__GNUC__) || defined(__clang__)
+                return !__builtin_sub_overflow(lhs, rhs, &result);
+#else
+                if ((rhs < 0 && lhs > INT64_MAX + rhs) || (rhs > 0 && lhs < INT64_MIN + rhs))
+                    return false;
+                result = lhs - rhs;
+                return true;
+#endif
+            }
+            inline bool multiply(int64_t lhs, int64_t rhs, int64_t &result)
+            {
+#if defined(__GNUC__) || defined(__clang__)
+                return !__builtin_mul_overflow(lhs, rhs, &result);
+#else
+                if (lhs != 0 && rhs != 0 && ((lhs == -1 && rhs == INT64_MIN) || (rhs == -1 && lhs == INT64_MIN) || (lhs != -1 && rhs != -1 && (lhs * rhs) / rhs != lhs)))
+                    return false;
+                result = lhs * rhs;
+                return true;
+#endif
+            }
+
+            // integers stay exact until a result overflows, then they become doubles.
+            Value numberPlus(const Value &lhs, const Value &rhs)
+            {
+                if (int64_t result; lhs.isInteger() && rhs.isInteger() && add(lhs.asInteger(), rhs.asInteger(), result))
+                    return Value::integer(result);
+                return Value(lhs.asNumber() + rhs.asNumber());
+            }
+            Value numberMinus(const Value &lhs, const Value &rhs)
+            {
+                if (int64_t result; lhs.isInteger() && rhs.isInteger() && subtract(lhs.asInteger(), rhs.asInteger(), result))
+                    return Value::integer(result);
+                return Value(lhs.asNumber() - rhs.asNumber());
+            }
+            Value numberMult(const Value &lhs, const Value &rhs)
+            {
+                if (int64_t result; lhs.isInteger() && rhs.isInteger() && multiply(lhs.asInteger(), rhs.asInteger(), result))
+                    return Value::integer(result);
+                return Value(lhs.asNumber() * rhs.asNumber());
+            }
+            Value numberDiv(const Value &lhs, const Value &rhs)
+            {
+                if (rhs.asNumber() == 0)
+                    throw std::overflow_error("Divide by zero exception");
+
+                // a quotient that is a whole number stays an integer, anything else is a double as before.
+                if (lhs.isInteger() && rhs.isInteger())
+                {
+                    int64_t a = lhs.asInteger();
+                    int64_t b = rhs.asInteger();
+                    if (!(a == INT64_MIN && b == -1) && a % b == 0)
+                        return Value::integer(a / b);
+                }
+                return Value(lhs.asNumber() / rhs.asNumber());
+            }
+            Value numberMod(const Value &lhs, const Value &rhs)
+            {
+                if (rhs.asNumber() == 0)
+                    throw std::overflow_error("Divide by zero exception");
+
+                if (lhs.isInteger() && rhs.isInteger())
+                {
+                    int64_t b = rhs.asInteger();
+                    return Value::integer(b == -1 ? 0 : lhs.asInteger() % b);
+                }
+                return Value(std::fmod(lhs.asNumber(), rhs.asNumber()));
+            }
+            Value numberAnd(const Value &lhs, const Value &rhs)
+            {
+                return Value::boolean(lhs.truthy() && rhs.truthy());
+            }
+            Value numberOr(const Value &lhs, const Value &rhs)
+            {
+                return Value::boolean(lhs.truthy() || rhs.truthy());
+            }
+
+            /// @brief operand of a bitwise operator, doubles are accepted when they hold a whole number.
+            int64_t bits(const Value &value)
+            {
+                if (value.isInteger())
+                    return value.asInteger();
+
+                double number = value.asNumber();
+                if (value.isBoolean() || number != std::trunc(number) || number < -9223372036854775808.0 || number >= 9223372036854775808.0)
+                    throw std::runtime_error("Bitwise operators only work on integers.");
+                return (int64_t)number;
+            }
+
+            Value bitAnd(const Value &lhs, const Value &rhs) { return Value::integer(bits(lhs) & bits(rhs)); }
+            Value bitOr(const Value &lhs, const Value &rhs) { return Value::integer(bits(lhs) | bits(rhs)); }
+            Value bitXor(const Value &lhs, const Value &rhs) { return Value::integer(bits(lhs) ^ bits(rhs)); }
+            // shifts wrap like the machine instruction, only the low 6 bits of the count are used.
+            Value shiftLeft(const Value &lhs, const Value &rhs) { return Value::integer((int64_t)((uint64_t)bits(lhs) << (bits(rhs) & 63))); }
+            Value shiftRight(const Value &lhs, const Value &rhs) { return Value::integer(bits(lhs) >> (bits(rhs) & 63)); }
+
+            Value stringPlus(const Value &lhs, const Value &rhs) { return String::concat(lhs, rhs); }
+
+            /// @brief a number that compares exactly, also an integer against a double.
+            struct Exact
+            {
+                const Value &value;
+            };
+
+            /// @brief -1, 0 or 1 like a three way compare, 2 when a double is NaN.
+            inline int order(int64_t integer, double number)
+            {
+                if (number != number)
+                    return 2;
+                if (number >= 9223372036854775808.0)
+                    return -1;
+                if (number < -9223372036854775808.0)
+                    return 1;
+                // compare the whole parts first, the fraction only breaks a tie.
+                auto whole = (int64_t)number;
+                if (integer != whole)
+                    return integer < whole ? -1 : 1;
+                double fraction = number - (double)whole;
+                return fraction > 0 ? -1 : fraction < 0 ? 1 : 0;
+            }
+            inline int order(Exact lhs, Exact rhs)
+            {
+                bool left = lhs.value.isInteger(), right = rhs.value.isInteger();
+                if (left && right)
+                {
+                    auto a = lhs.value.asInteger(), b = rhs.value.asInteger();
+                    return a < b ? -1 : a > b ? 1 : 0;
+                }
+                if (left)
+                    return order(lhs.value.asInteger(), rhs.value.asNumber());
+                if (right)
+                {
+                    int result = order(rhs.value.asInteger(), lhs.value.asNumber());
+                    return result == 2 ? 2 : -result;
+                }
+                double a = lhs.value.asNumber(), b = rhs.value.asNumber();
+                return a < b ? -1 : a > b ? 1 : a == b ? 0 : 2;
+            }
+
+            inline bool operator<(Exact lhs, Exact rhs) { return order(lhs, rhs) == -1; }
+            inline bool operator==(Exact lhs, Exact rhs) { return order(lhs, rhs) == 0; }
+            inline bool operator>(Exact lhs, Exact rhs) { return rhs < lhs; }
+            inline bool operator<=(Exact lhs, Exact rhs) { return !(lhs > rhs); }
+            inline bool operator>=(Exact lhs, Exact rhs) { return !(lhs < rhs); }
+            inline bool operator!=(Exact lhs, Exact rhs) { return !(lhs == rhs); }
+
+            /// @brief what the comparison kernels compare, numbers by value and strings by their text.
+            struct Numbers
+            {
+                static inline Exact read(const Value &value) { return Exact{value}; }
+            };
+            struct Strings
+            {
+                static inline const String &read(const Value &value) { return text(value); }
+            };
+
+            /// @brief comparison kernels, T reads the operands of the kind they are known to have.
+            template <typename T>
+            Value lessThen(const Value &lhs, const Value &rhs) { return Value::boolean(T::read(lhs) < T::read(rhs)); }
+            template <typename T>
+            Value greaterThen(const Value &lhs, const Value &rhs) { return Value::boolean(T::read(lhs) > T::read(rhs)); }
+            template <typename T>
+            Value lessThenOrEqual(const Value &lhs, const Value &rhs) { return Value::boolean(T::read(lhs) <= T::read(rhs)); }
+            template <typename T>
+            Value greaterThenOrEqual(const Value &lhs, const Value &rhs) { return Value::boolean(T::read(lhs) >= T::read(rhs)); }
+            template <typename T>
+            Value equal(const Value &lhs, const Value &rhs) { return Value::boolean(T::read(lhs) == T::read(rhs)); }
+            template <typename T>
+            Value notEqual(const Value &lhs, const Value &rhs) { return Value::boolean(T::read(lhs) != T::read(rhs)); }
+
+            Value mismatch(const Value &, const Value &)
+            {
+                throw std::runtime_error("Can not operate on two different types.");
+            }
+            Value invalid(const Value &, const Value &)
+            {
+                throw std::runtime_error("Invalid operation.");
+            }
+            Value unknown(const Value &, const Value &)
+            {
+                throw std::runtime_error("Unknown operation");
+            }
+
+            constexpr std::size_t slot(unsigned int lhs, unsigned int rhs, unsigned int op)
+            {
+                return (lhs * consts::ID_COUNT + rhs) * OP_COUNT + op;
+            }
+
+            template <typename T>
+            constexpr void comparisons(Table &table, unsigned int id)
+            {
+                table[slot(id, id, OP_LESS_THEN)] = lessThen<T>;
+                table[slot(id, id, OP_GREATER_THEN)] = greaterThen<T>;
+                table[slot(id, id, OP_LESS_THEN_OR_EQUAL)] = lessThenOrEqual<T>;
+                table[slot(id, id, OP_GREATER_THEN_OR_EQUAL)] = greaterThenOrEqual<T>;
+                table[slot(id, id, OP_EQUAL_EQUAL)] = equal<T>;
+                table[slot(id, id, OP_NOT_EQUAL)] = notEqual<T>;
+            }
+
+            constexpr Table build()
+            {
+                Table table{};
+
+                // the order of these errors matches the checks the interpreter used to make.
+                for (unsigned int lhs = 0; lhs < consts::ID_COUNT; lhs++)
+                {
+                    for (unsigned int rhs = 0; rhs < consts::ID_COUNT; rhs++)
+                    {
+                        for (unsigned int op = 0; op < OP_COUNT; op++)
+                        {
+                            if (lhs != rhs)
+                                table[slot(lhs, rhs, op)] = mismatch;
+                            else if (op == OP_UNKNOWN)
+                                table[slot(lhs, rhs, op)] = unknown;
+                            else
+                                table[slot(lhs, rhs, op)] = invalid;
+                        }
+                    }
+                }
+
+                table[slot(consts::ID_NUMBER, consts::ID_NUMBER, OP_PLUS)] = numberPlus;
+                table[slot(consts::ID_NUMBER, consts::ID_NUMBER, OP_MINUS)] = numberMinus;
+                table[slot(consts::ID_NUMBER, consts::ID_NUMBER, OP_MULT)] = numberMult;
+                table[slot(consts::ID_NUMBER, consts::ID_NUMBER, OP_DIV)] = numberDiv;
+                table[slot(consts::ID_NUMBER, consts::ID_NUMBER, OP_AND)] = numberAnd;
+                table[slot(consts::ID_NUMBER, consts::ID_NUMBER, OP_OR)] = numberOr;
+                table[slot(consts::ID_NUMBER, consts::ID_NUMBER, OP_MOD)] = numberMod;
+                table[slot(consts::ID_NUMBER, consts::ID_NUMBER, OP_BIT_AND)] = bitAnd;
+                table[slot(consts::ID_NUMBER, consts::ID_NUMBER, OP_BIT_OR)] = bitOr;
+                table[slot(consts::ID_NUMBER, consts::ID_NUMBER, OP_BIT_XOR)] = bitXor;
+                table[slot(consts::ID_NUMBER, consts::ID_NUMBER, OP_SHIFT_LEFT)] = shiftLeft;
+                table[slot(consts::ID_NUMBER, consts::ID_NUMBER, OP_SHIFT_RIGHT)] = shiftRight;
+                comparisons<Numbers>(table, consts::ID_NUMBER);
+
+                table[slot(consts::ID_STRING, consts::ID_STRING, OP_PLUS)] = stringPlus;
+                comparisons<Strings>(table, consts::ID_STRING);
+
+                return table;
+            }
+        } // namespace
+
+        extern constexpr Table TABLE = build();
+
+        Value apply(unsigned int op, const Value &lhs, const Value &rhs)
+        {
+            if (lhs.isEmpty() || rhs.isEmpty())
+                throw std::runtime_error("Unable to operate on given types.");
+
+            return lookup(lhs.getKind(), rhs.getKind(), op)(lhs, rhs);
+        }
+
+        const Value &assign(unsigned int op, Value &target, const Value &rhs)
+        {
+            // numbers are immediates, only a string can be changed in place. rhs being the target
+            // itself also shows up as a second holder.
+            if (op == OP_PLUS && target.isUnique() && target.getKind() == consts::ID_STRING && rhs.getKind() == consts::ID_STRING)
+            {
+                static_cast<String *>(target.getObject())->append(*static_cast<String *>(rhs.getObject()));
+                return target;
+            }
+
+            target = apply(op, target, rhs);
+            return target;
+        }
+
+        Value element(const Value &object, const Value &index)
+        {
+            if (auto array = cast<Array>(object); array != nullptr)
+                return array->get(index);
+            if (auto map = cast<Map>(object); map != nullptr)
+            {
+                if (auto value = map->find(index); value != nullptr)
+                    return *value;
+                throw std::runtime_error("No such key in map.");
+            }
+            throw std::runtime_error("Only arrays and maps can be indexed.");
+        }
+
+        Value setElement(const Value &object, const Value &index, unsigned int op, const Value &value)
+        {
+            if (auto array = cast<Array>(object); array != nullptr)
+            {
+                if (op == OP_UNKNOWN)
+                {
+                    array->set(index, value);
+                    return value;
+                }
+                auto result = apply(op, array->get(index), value);
+                array->set(index, result);
+                return result;
+            }
+
+            if (auto map = cast<Map>(object); map != nullptr)
+            {
+                if (op == OP_UNKNOWN)
+                    return map->insert(index) = value;
+
+                auto target = map->find(index);
+                if (target == nullptr)
+                    throw std::runtime_error("No such key in map.");
+                return assign(op, *target, value);
+            }
+
+            throw std::runtime_error("Only arrays and maps can be indexed.");
+        }
+
+        Value shortCircuit(unsigned int op, const Value &lhs)
+        {
+            // only a number decides the result, anything else is left for the kernel to reject.
+            if (lhs.isEmpty() || lhs.getKind() != consts::ID_NUMBER)
+                return Value();
+
+            bool value = lhs.truthy();
+            if (op == OP_AND && !value)
+                return Value::boolean(false);
+            if (op == OP_OR && value)
+                return Value::boolean(true);
+            return Value();
+        }
+    } // namespace operators
+} // namespace jit
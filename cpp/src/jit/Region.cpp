@@ -0,0 +1,47 @@
+#include <vip/jit/Region.hpp>
+#include <algorithm>
+#include <vip/jit/Memory.hpp>
+
+namespace jit
+{
+    Region::~Region()
+    {
+        while (first != nullptr)
+        {
+            auto next = first->next;
+            Memory::deallocate(first);
+            first = next;
+        }
+    }
+
+    void *Region::grow(std::size_t size, std::size_t align)
+    {
+        // chunks after the current one are left from before a release, they are used before asking for more.
+        auto previous = current;
+        auto chunk = current != nullptr ? current->next : first;
+        while (chunk != nullptr && chunk->size < size + align)
+        {
+            previous = chunk;
+            chunk = chunk->next;
+        }
+
+        if (chunk == nullptr)
+        {
+            auto bytes = std::max(chunkSize, size + align);
+            chunk = static_cast<Chunk *>(Memory::allocate(sizeof(Chunk) + bytes));
+            chunk->size = bytes;
+            chunk->next = nullptr;
+            if (previous != nullptr)
+                previous->next = chunk;
+            else
+                first = chunk;
+            // a region that keeps growing gets fewer, bigger chunks.
+            chunkSize = std::min(chunkSize * 2, consts::REGION_CHUNK_LIMIT);
+        }
+
+        current = chunk;
+        cursor = chunk->data();
+        limit = cursor + chunk->size;
+        return allocate(size, align);
+    }
+} // namespace jit
@@ -0,0 +1,359 @@
+#include <vip/jit/Snapshot.hpp>
+#include <vip/jit/components/String.hpp>
+#include <vip/jit/components/Function.hpp>
+#include <vip/ast/ArrayLiteral.hpp>
+#include <vip/ast/BinaryExpression.hpp>
+#include <vip/ast/CallExpression.hpp>
+#include <vip/ast/ExpressionStatement.hpp>
+#include <vip/ast/ForStatement.hpp>
+#include <vip/ast/FunctionDeclaration.hpp>
+#include <vip/ast/IfStatement.hpp>
+#include <vip/ast/IndexExpression.hpp>
+#include <vip/ast/MatchStatement.hpp>
+#include <vip/ast/MemberExpression.hpp>
+#include <vip/ast/ReturnStatement.hpp>
+#include <vip/ast/StructDeclaration.hpp>
+#include <vip/ast/VariableStatement.hpp>
+#include <vip/ast/WhileExpression.hpp>
+#include <vip/ast/Consts.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <unordered_set>
+
+namespace jit
+{
+    namespace
+    {
+        const char *const KIND_NAMES[] = {"null", "string", "number", "function", "internal function", "integer", "shape", "record", "array", "map"};
+
+        static_assert(sizeof(KIND_NAMES) / sizeof(KIND_NAMES[0]) == consts::ID_COUNT, "Every kind needs a name.");
+
+        inline const char *kindName(unsigned int kind) { return kind < consts::ID_COUNT ? KIND_NAMES[kind] : "object"; }
+
+        std::string escape(const std::string &text)
+        {
+            std::string escaped;
+            for (unsigned char c : text)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    escaped.push_back('\\');
+                    escaped.push_back((char)c);
+                }
+                else if (c < 0x20)
+                {
+                    char code[8];
+                    std::snprintf(code, sizeof(code), "\\u%04x", c);
+                    escaped += code;
+                }
+                else
+                    escaped.push_back((char)c);
+            }
+            return escaped;
+        }
+
+        void measure(ast::Node *node, std::size_t &nodes, std::size_t &bytes);
+
+        template <typename T>
+        void measureAll(std::vector<T *> &list, std::size_t &nodes, std::size_t &bytes)
+        {
+            for (auto &&node : list)
+                measure(node, nodes, bytes);
+        }
+
+        /// @brief count the nodes of the tree below node and the bytes Memory charged for them.
+        void measure(ast::Node *node, std::size_t &nodes, std::size_t &bytes)
+        {
+            if (node == nullptr)
+                return;
+            nodes++;
+            bytes += Memory::size(node);
+
+            switch (node->getKind())
+            {
+            case ast::consts::BINARY_EXPRESSION:
+            {
+                auto bin = static_cast<ast::BinaryExpression *>(node);
+                measure(bin->getLhs(), nodes, bytes);
+                measure(bin->getRhs(), nodes, bytes);
+                break;
+            }
+            case ast::consts::BLOCK_EXPRESSION:
+                measureAll(static_cast<ast::Block *>(node)->getStatements(), nodes, bytes);
+                break;
+            case ast::consts::CALL_EXPRESSION:
+            {
+                auto call = static_cast<ast::CallExpression *>(node);
+                measure(call->getExpression(), nodes, bytes);
+                measureAll(call->getArguments(), nodes, bytes);
+                break;
+            }
+            case ast::consts::EXPRESSION_STATEMENT:
+                measure(static_cast<ast::ExpressionStatement *>(node)->getExpression(), nodes, bytes);
+                break;
+            case ast::consts::FUNCTION_EXPRESSION:
+            {
+                auto fn = static_cast<ast::FunctionDeclartion *>(node);
+                auto params = fn->getParameters();
+                measureAll(params, nodes, bytes);
+                measure(fn->getBodyBlock(), nodes, bytes);
+                break;
+            }
+            case ast::consts::IF_STATEMENT:
+            {
+                auto branch = static_cast<ast::IfStatement *>(node);
+                measure(branch->getExpression(), nodes, bytes);
+                measure(branch->getThen(), nodes, bytes);
+                measure(branch->getElse(), nodes, bytes);
+                break;
+            }
+            case ast::consts::RETURN_STATEMENT:
+                measure(static_cast<ast::ReturnStatement *>(node)->getExpression(), nodes, bytes);
+                break;
+            case ast::consts::VARIABLE_DECLARATION:
+            {
+                auto decl = static_cast<ast::VariableDeclaration *>(node);
+                measure(decl->getName(), nodes, bytes);
+                measure(decl->getType(), nodes, bytes);
+                measure(decl->getInitalizer(), nodes, bytes);
+                break;
+            }
+            case ast::consts::VARIABLE_STATEMENT:
+                measureAll(static_cast<ast::VariableStatement *>(node)->getDeclarations(), nodes, bytes);
+                break;
+            case ast::consts::PARAMETER_EXRESSION:
+            {
+                auto param = static_cast<ast::Parameter *>(node);
+                measure(param->getName(), nodes, bytes);
+                measure(param->getType(), nodes, bytes);
+                measure(param->getInitializer(), nodes, bytes);
+                break;
+            }
+            case ast::consts::WHILE_EXRESSION:
+            {
+                auto loop = static_cast<ast::WhileExpression *>(node);
+                measure(loop->getExpression(), nodes, bytes);
+                measure(loop->getBody(), nodes, bytes);
+                break;
+            }
+            case ast::consts::MATCH_STATEMENT:
+            {
+                auto match = static_cast<ast::MatchStatement *>(node);
+                measure(match->getExpression(), nodes, bytes);
+                measureAll(match->getValues(), nodes, bytes);
+                measureAll(match->getBodies(), nodes, bytes);
+                measure(match->getElse(), nodes, bytes);
+                break;
+            }
+            case ast::consts::FOR_STATEMENT:
+            {
+                auto loop = static_cast<ast::ForStatement *>(node);
+                measure(loop->getName(), nodes, bytes);
+                measure(loop->getFrom(), nodes, bytes);
+                measure(loop->getTo(), nodes, bytes);
+                measure(loop->getStep(), nodes, bytes);
+                measure(loop->getBody(), nodes, bytes);
+                break;
+            }
+            case ast::consts::STRUCT_DECLARATION:
+                measureAll(static_cast<ast::StructDeclaration *>(node)->getFields(), nodes, bytes);
+                break;
+            case ast::consts::MEMBER_EXPRESSION:
+                measure(static_cast<ast::MemberExpression *>(node)->getObject(), nodes, bytes);
+                break;
+            case ast::consts::INDEX_EXPRESSION:
+            {
+                auto index = static_cast<ast::IndexExpression *>(node);
+                measure(index->getObject(), nodes, bytes);
+                measure(index->getIndex(), nodes, bytes);
+                break;
+            }
+            case ast::consts::ARRAY_LITERAL:
+                measureAll(static_cast<ast::ArrayLiteral *>(node)->getElements(), nodes, bytes);
+                break;
+            default:
+                break;
+            }
+        }
+
+        /// @brief after minus before, as a signed number.
+        inline long long change(std::size_t before, std::size_t after) { return (long long)after - (long long)before; }
+    } // namespace
+
+    /// @brief objects in the order the walk found them, each with the one it was found from.
+    class Snapshot::Walk : public Tracer
+    {
+    public:
+        static constexpr std::size_t NONE = (std::size_t)-1;
+
+        struct Visit
+        {
+            Object *object;
+            std::size_t parent;
+            const std::string *root;
+        };
+
+        std::vector<Visit> visits;
+        std::unordered_set<const Object *> seen;
+        /// @brief visit whose children are being traced.
+        std::size_t current = 0;
+
+        void add(Object *object, std::size_t parent, const std::string *root)
+        {
+            if (object == nullptr || !seen.insert(object).second)
+                return;
+            visits.push_back({object, parent, root});
+        }
+
+        void visit(Value &child) override
+        {
+            add(child.getObject(), current, visits[current].root);
+        }
+
+        std::string path(std::size_t index) const
+        {
+            std::vector<std::size_t> chain;
+            for (; index != NONE; index = visits[index].parent)
+                chain.push_back(index);
+
+            // the root object is named by its binding, everything after it by its kind.
+            std::string text = *visits[chain.back()].root;
+            for (auto step = chain.rbegin() + 1; step != chain.rend(); ++step)
+                text += std::string(" > ") + kindName(visits[*step].object->getKind());
+            return text;
+        }
+    };
+
+    Snapshot Snapshot::take(const std::vector<std::pair<std::string, Value>> &roots, const Heap *heap)
+    {
+        // every root goes in first, so paths through other roots are never preferred over them.
+        Walk walk;
+        for (auto &&root : roots)
+            walk.add(root.second.getObject(), Walk::NONE, &root.first);
+        for (walk.current = 0; walk.current < walk.visits.size(); walk.current++)
+            walk.visits[walk.current].object->trace(walk);
+
+        Snapshot snapshot;
+        std::size_t tracked = 0;
+        // rankings hold sizes with the index of the visit, ties go to the one found first.
+        std::vector<std::pair<std::size_t, std::size_t>> sizes, lengths, asts;
+        std::vector<std::pair<std::size_t, std::size_t>> astNodes(walk.visits.size());
+        for (std::size_t i = 0; i < walk.visits.size(); i++)
+        {
+            auto object = walk.visits[i].object;
+            auto kind = object->getKind();
+            auto size = object->footprint();
+
+            snapshot.objects++;
+            snapshot.bytes += size;
+            if (kind < consts::ID_COUNT)
+            {
+                snapshot.kinds[kind].count++;
+                snapshot.kinds[kind].bytes += size;
+            }
+            if (heap != nullptr && object->heap == heap)
+                tracked++;
+
+            sizes.emplace_back(size, i);
+            if (kind == consts::ID_STRING)
+                lengths.emplace_back(static_cast<String *>(object)->size(), i);
+            if (kind == consts::ID_FUNCTION)
+            {
+                auto fn = static_cast<Function *>(object);
+                std::size_t nodes = 0, bytes = 0;
+                measureAll(fn->getParams(), nodes, bytes);
+                measure(fn->getBody(), nodes, bytes);
+                astNodes[i] = {nodes, bytes};
+                asts.emplace_back(bytes, i);
+            }
+        }
+
+        if (heap != nullptr)
+        {
+            auto stats = heap->getStats();
+            auto alive = stats.young + stats.old + stats.acyclic;
+            snapshot.unreached = alive > tracked ? alive - tracked : 0;
+        }
+
+        auto top = [](std::vector<std::pair<std::size_t, std::size_t>> &ranking)
+        {
+            auto count = std::min(ranking.size(), consts::SNAPSHOT_TOP);
+            std::partial_sort(ranking.begin(), ranking.begin() + count, ranking.end(), [](const auto &lhs, const auto &rhs)
+                              { return lhs.first != rhs.first ? lhs.first > rhs.first : lhs.second < rhs.second; });
+            ranking.resize(count);
+        };
+        top(sizes);
+        top(lengths);
+        top(asts);
+
+        for (auto &&entry : sizes)
+            snapshot.largest.push_back({walk.visits[entry.second].object->getKind(), entry.first, walk.path(entry.second)});
+        for (auto &&entry : lengths)
+        {
+            auto string = static_cast<String *>(walk.visits[entry.second].object);
+            snapshot.strings.push_back({entry.first, string->footprint(), string->prefix(consts::SNAPSHOT_PREVIEW), walk.path(entry.second)});
+        }
+        for (auto &&entry : asts)
+        {
+            auto fn = static_cast<Function *>(walk.visits[entry.second].object);
+            snapshot.functions.push_back({fn->getName(), astNodes[entry.second].first, entry.first, walk.path(entry.second)});
+        }
+        return snapshot;
+    }
+
+    std::string Snapshot::toJson() const
+    {
+        std::ostringstream json;
+        json << "{\"objects\":" << objects << ",\"bytes\":" << bytes << ",\"unreached\":" << unreached << ",\"kinds\":{";
+        for (unsigned int kind = consts::ID_STRING; kind < consts::ID_COUNT; kind++)
+        {
+            json << (kind == consts::ID_STRING ? "" : ",") << '"' << kindName(kind) << "\":{\"count\":" << kinds[kind].count
+                 << ",\"bytes\":" << kinds[kind].bytes << '}';
+        }
+
+        json << "},\"largest\":[";
+        for (std::size_t i = 0; i < largest.size(); i++)
+        {
+            json << (i == 0 ? "" : ",") << "{\"kind\":\"" << kindName(largest[i].kind) << "\",\"bytes\":" << largest[i].bytes
+                 << ",\"path\":\"" << escape(largest[i].path) << "\"}";
+        }
+
+        json << "],\"strings\":[";
+        for (std::size_t i = 0; i < strings.size(); i++)
+        {
+            json << (i == 0 ? "" : ",") << "{\"length\":" << strings[i].length << ",\"bytes\":" << strings[i].bytes
+                 << ",\"preview\":\"" << escape(strings[i].preview) << "\",\"path\":\"" << escape(strings[i].path) << "\"}";
+        }
+
+        json << "],\"functions\":[";
+        for (std::size_t i = 0; i < functions.size(); i++)
+        {
+            json << (i == 0 ? "" : ",") << "{\"name\":\"" << escape(functions[i].name) << "\",\"astNodes\":" << functions[i].astNodes
+                 << ",\"astBytes\":" << functions[i].astBytes << ",\"path\":\"" << escape(functions[i].path) << "\"}";
+        }
+        json << "]}";
+        return json.str();
+    }
+
+    std::string Snapshot::diff(const Snapshot &before, const Snapshot &after)
+    {
+        std::ostringstream json;
+        json << "{\"objects\":" << change(before.objects, after.objects) << ",\"bytes\":" << change(before.bytes, after.bytes)
+             << ",\"unreached\":" << change(before.unreached, after.unreached) << ",\"kinds\":{";
+
+        // only the kinds that changed, so a diff of a steady heap is short.
+        bool first = true;
+        for (unsigned int kind = consts::ID_STRING; kind < consts::ID_COUNT; kind++)
+        {
+            auto count = change(before.kinds[kind].count, after.kinds[kind].count);
+            auto bytes = change(before.kinds[kind].bytes, after.kinds[kind].bytes);
+            if (count == 0 && bytes == 0)
+                continue;
+            json << (first ? "" : ",") << '"' << kindName(kind) << "\":{\"count\":" << count << ",\"bytes\":" << bytes << '}';
+            first = false;
+        }
+        json << "}}";
+        return json.str();
+    }
+} // namespace jit
@@ -0,0 +1,87 @@
+#include <vip/jit/Value.hpp>
+#include <stdexcept>
+
+#include <vip/jit/components/String.hpp>
+#include <vip/jit/components/Number.hpp>
+#include <vip/jit/components/Null.hpp>
+#include <vip/jit/components/Record.hpp>
+#include <vip/jit/components/Array.hpp>
+#include <vip/jit/components/Map.hpp>
+
+namespace jit
+{
+    std::ostream &operator<<(std::ostream &out, const Value &value)
+    {
+        if (value.isObject())
+            out << *value.getObject();
+        else if (value.isBoolean())
+            out << (value.truthy() ? "true" : "false");
+        else if (value.isInteger())
+            out << value.asInteger();
+        else if (value.isNumber())
+            out << value.asNumber();
+        else
+            out << "null";
+        return out;
+    }
+
+    void printHeld(std::ostream &out, const Value &value)
+    {
+        if (auto record = cast<Record>(value); record != nullptr)
+            out << "[" << record->getShape().getName() << "]";
+        else if (cast<Map>(value) != nullptr)
+            out << "[map]";
+        else if (cast<Array>(value) != nullptr)
+            out << "[array]";
+        else
+            out << value;
+    }
+
+    std::shared_ptr<Object> box(const Value &value)
+    {
+        if (value.isEmpty())
+            return nullptr;
+        if (value.isBoolean())
+            return std::shared_ptr<Number>(new Number(value.truthy()));
+        if (value.isNumber())
+            return std::shared_ptr<Number>(new Number(value.asNumber()));
+        if (value.isNull())
+            return std::shared_ptr<Null>(new Null());
+
+        // the shared_ptr takes a reference of its own and gives it back when the last copy is gone.
+        auto object = value.getObject();
+        object->retain();
+        return std::shared_ptr<Object>(object, [](Object *held)
+                                       { held->release(); });
+    }
+
+    Value unbox(const std::shared_ptr<Object> &object)
+    {
+        if (object == nullptr)
+            return Value();
+
+        switch (object->getKind())
+        {
+        case consts::ID_NULL:
+            return Value::null();
+        case consts::ID_NUMBER:
+        {
+            auto &number = static_cast<Number &>(*object);
+            if (number.isBoolean())
+                return Value::boolean(number.asBool());
+            return Value(number.getValue());
+        }
+        default:
+            break;
+        }
+
+        // objects that came out of box are counted already and can be shared.
+        if (object->getRefs() != 0)
+            return Value(object.get());
+
+        if (object->getKind() == consts::ID_STRING)
+            return Value(new String(static_cast<String &>(*object).getValue()));
+
+        throw std::runtime_error("Unable to use the object returned by a callback.");
+    }
+} // namespace jit
@@ -0,0 +1,1178 @@
+#include <vip/jit/closure/Engine.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+
+#include <vip/jit/components/InternalFunction.hpp>
+#include <vip/jit/components/Function.hpp>
+#include <vip/jit/components/String.hpp>
+#include <vip/jit/components/Record.hpp>
+#include <vip/jit/components/Shape.hpp>
+#include <vip/jit/components/Array.hpp>
+#include <vip/ast/StructDeclaration.hpp>
+#include <vip/ast/MemberExpression.hpp>
+#include <vip/ast/IndexExpression.hpp>
+#include <vip/ast/ArrayLiteral.hpp>
+#include <vip/ast/FunctionDeclaration.hpp>
+#include <vip/ast/ExpressionStatement.hpp>
+#include <vip/ast/VariableStatement.hpp>
+#include <vip/ast/BinaryExpression.hpp>
+#include <vip/ast/ReturnStatement.hpp>
+#include <vip/ast/WhileExpression.hpp>
+#include <vip/ast/CallExpression.hpp>
+#include <vip/ast/NumericLiteral.hpp>
+#include <vip/ast/MatchStatement.hpp>
+#include <vip/ast/ForStatement.hpp>
+#include <vip/ast/StringLiteral.hpp>
+#include <vip/ast/IfStatement.hpp>
+#include <vip/ast/Identifier.hpp>
+#include <vip/ast/Consts.hpp>
+#include <vip/jit/Consts.hpp>
+#include <vip/jit/Operators.hpp>
+#include <vip/jit/Intrinsics.hpp>
+
+namespace jit
+{
+    namespace closure
+    {
+        namespace
+        {
+            /// @brief procedure of a function that is called with count arguments.
+            Procedure &procedure(const Value &fn, std::size_t count)
+            {
+                auto proc = cast<Function>(fn)->getProcedure();
+                if (proc == nullptr)
+                    throw std::runtime_error("Failed to execute function");
+
+                if (count != proc->params.size())
+                    throw std::runtime_error("Given params does not function sig.");
+                return *proc;
+            }
+
+            /// @brief the local of a caller that has the name of var where the call was made, nullptr if none has.
+            Value *dynamic(Global *var, Frame &frame)
+            {
+                for (auto callee = &frame; callee->caller != nullptr; callee = callee->caller)
+                {
+                    for (auto &&[global, value] : *callee->replaced)
+                    {
+                        if (global == var)
+                            return &value;
+                    }
+                    for (auto &&[global, slot] : *callee->site)
+                    {
+                        if (global == var)
+                            return &callee->caller->slots[slot];
+                    }
+                }
+                return nullptr;
+            }
+
+            /// @brief the value a global name refers to from frame.
+            inline Value &resolve(Global *var, Frame &frame)
+            {
+                if (var->shadowed)
+                {
+                    if (auto local = dynamic(var, frame); local != nullptr)
+                        return *local;
+                }
+                return var->value;
+            }
+
+            /// @brief run a function, the tail calls it makes reuse its frame.
+            /// @param site locals of caller the function sees.
+            Value invoke(Value fn, Values &values, Frame &caller, const Visible *site)
+            {
+                Frame callee(0, caller.region);
+                Replaced replaced;
+                callee.caller = &caller;
+                callee.site = site;
+                callee.replaced = &replaced;
+                while (true)
+                {
+                    // recursion and tail call loops may never reach a loop, so calls are safepoints too.
+                    if (auto heap = Heap::current(); heap != nullptr)
+                        heap->safepoint();
+
+                    auto &proc = procedure(fn, values.size());
+                    for (std::size_t i = 0; i < values.size(); i++)
+                    {
+                        auto &value = values[i];
+                        if (value.isEmpty() || value.getKind() != proc.params[i])
+                            throw std::runtime_error("Invalid type");
+                        if (proc.params[i] == consts::ID_RECORD && cast<Record>(value)->getShape().getName() != proc.structs[i])
+                            throw std::runtime_error("Invalid type");
+                    }
+
+                    callee.slots.assign(proc.slots, Value());
+                    std::move(values.begin(), values.end(), callee.slots.begin());
+
+                    if (!proc.body(callee))
+                        return Value::null();
+                    if (callee.tail.isEmpty())
+                        return callee.result;
+
+                    // swapped rather than moved, so the next tail call fills a buffer it already has.
+                    fn = std::move(callee.tail);
+                    values.swap(callee.arguments);
+                }
+            }
+
+            Value call(Value fn, const std::vector<Expression> &args, Frame &frame, const Visible *site)
+            {
+                if (fn.isEmpty())
+                    throw std::runtime_error("No function with give name exists.");
+
+                switch (fn.getKind())
+                {
+                case consts::ID_FUNCTION:
+                {
+                    procedure(fn, args.size());
+
+                    // everything the call allocates in the region is given back when it returns.
+                    Region::Scope scope(*frame.region);
+                    Values values(RegionAllocator<Value>(frame.region));
+                    values.reserve(args.size());
+                    for (auto &&arg : args)
+                        values.push_back(arg(frame));
+
+                    return invoke(std::move(fn), values, frame, site);
+                }
+                case consts::ID_INTERNAL_FUNCTION:
+                {
+                    Region::Scope scope(*frame.region);
+                    Values values(RegionAllocator<Value>(frame.region));
+                    values.reserve(args.size());
+                    for (auto &&arg : args)
+                        values.push_back(arg(frame));
+
+                    return cast<InternalFunction>(fn)->call(values.data(), values.size());
+                }
+                case consts::ID_SHAPE:
+                {
+                    Region::Scope scope(*frame.region);
+                    Values values(RegionAllocator<Value>(frame.region));
+                    values.reserve(args.size());
+                    for (auto &&arg : args)
+                        values.push_back(arg(frame));
+
+                    return Record::make(fn, values.data(), values.size());
+                }
+                default:
+                    throw std::runtime_error("Failed to execute function");
+                }
+            }
+
+            /// @brief check a bound or step of a for loop.
+            const Value &bound(const Value &value)
+            {
+                if (value.isEmpty() || value.getKind() != consts::ID_NUMBER)
+                    throw std::runtime_error("Range bounds must be numbers.");
+                return value;
+            }
+
+            Statement sequence(std::vector<Statement> statements)
+            {
+                if (statements.size() == 1)
+                    return statements.front();
+
+                return [statements](Frame &frame)
+                {
+                    for (auto &&statement : statements)
+                    {
+                        if (statement(frame))
+                            return true;
+                    }
+                    return false;
+                };
+            }
+        } // namespace
+
+        /// @brief lowers the statements of one procedure, resolving every name to a slot or a global.
+        class Lowering
+        {
+        private:
+            Engine &engine;
+            std::vector<std::map<std::string, std::size_t>> scopes;
+            /// @brief the locals in scope, shared by the call sites until a scope changes.
+            std::shared_ptr<const Visible> visible;
+            std::size_t slots = 0;
+            bool inFunction;
+            bool returnLast;
+
+            bool isTopLevel() const { return !inFunction && scopes.empty(); }
+
+            Global *global(const std::string &name)
+            {
+                return &engine.globals[name];
+            }
+
+            /// @brief bring a local into the innermost scope.
+            void bind(const std::string &name, std::size_t slot)
+            {
+                scopes.back()[name] = slot;
+                global(name)->shadowed = true;
+                visible.reset();
+            }
+
+            void enter()
+            {
+                scopes.emplace_back();
+                visible.reset();
+            }
+
+            void leave()
+            {
+                scopes.pop_back();
+                visible.reset();
+            }
+
+            /// @brief the locals a function called from here sees.
+            std::shared_ptr<const Visible> site()
+            {
+                if (visible == nullptr)
+                {
+                    std::map<std::string, std::size_t> names;
+                    for (auto &&scope : scopes)
+                        for (auto &&[name, slot] : scope)
+                            names[name] = slot;
+
+                    auto locals = std::make_shared<Visible>();
+                    for (auto &&[name, slot] : names)
+                        locals->emplace_back(global(name), slot);
+                    visible = std::move(locals);
+                }
+                return visible;
+            }
+
+            /// @brief find the slot of a local.
+            /// @return true if the name is a local, false if it refers to a global.
+            bool lookup(const std::string &name, std::size_t &slot)
+            {
+                for (auto it = scopes.rbegin(); it != scopes.rend(); it++)
+                {
+                    if (auto found = it->find(name); found != it->end())
+                    {
+                        slot = found->second;
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            /// @brief read a name, empty values are handed to the caller.
+            Expression load(const std::string &name)
+            {
+                std::size_t slot;
+                if (lookup(name, slot))
+                {
+                    return [slot](Frame &frame)
+                    { return frame.slots[slot]; };
+                }
+
+                auto var = global(name);
+                if (auto builtin = engine.builtins.find(name); builtin != nullptr)
+                {
+                    Value fn = *builtin;
+                    return [var, fn](Frame &frame)
+                    {
+                        if (auto local = var->shadowed ? dynamic(var, frame) : nullptr; local != nullptr)
+                            return *local;
+                        return var->declared ? var->value : fn;
+                    };
+                }
+                return [var](Frame &frame)
+                { return resolve(var, frame); };
+            }
+
+            Expression lowerIdentifier(ast::Identifier *ident)
+            {
+                std::size_t slot;
+                if (lookup(ident->getValue(), slot))
+                {
+                    return [slot](Frame &frame)
+                    {
+                        auto &value = frame.slots[slot];
+                        if (value.isEmpty())
+                            throw std::runtime_error("No variable exsists");
+                        return value;
+                    };
+                }
+
+                auto var = global(ident->getValue());
+                if (auto builtin = engine.builtins.find(ident->getValue()); builtin != nullptr)
+                {
+                    Value fn = *builtin;
+                    return [var, fn](Frame &frame)
+                    {
+                        auto local = var->shadowed ? dynamic(var, frame) : nullptr;
+                        if (local == nullptr && !var->declared)
+                            return fn;
+                        auto &value = local != nullptr ? *local : var->value;
+                        if (value.isEmpty())
+                            throw std::runtime_error("No variable exsists");
+                        return value;
+                    };
+                }
+                return [var](Frame &frame)
+                {
+                    auto &value = resolve(var, frame);
+                    if (value.isEmpty())
+                        throw std::runtime_error("No variable exsists");
+                    return value;
+                };
+            }
+
+            /// @brief the value a member expression reads its field from.
+            /// @param local set to the slot when that is a local, which can be read without copying it.
+            /// @return the expression or nothing for a local.
+            Expression lowerObject(ast::MemberExpression *member, std::size_t &local)
+            {
+                local = SIZE_MAX;
+                if (auto ident = ast::cast<ast::Identifier>(member->getObject()); ident != nullptr && lookup(ident->getValue(), local))
+                    return Expression();
+                local = SIZE_MAX;
+                return lowerExpression(member->getObject());
+            }
+
+            /// @brief `object.field`, every site caches the shape it saw last and the slot of the field in it.
+            Expression lowerMember(ast::MemberExpression *member)
+            {
+                std::size_t local;
+                auto object = lowerObject(member, local);
+                auto field = member->getField();
+                ast::FieldCache cache;
+
+                // a record in a variable is read in place, like the variable itself would be.
+                if (!object)
+                {
+                    return [local, field, cache](Frame &frame) mutable
+                    { return Record::at(frame.slots[local], field, cache.shape, cache.slot); };
+                }
+                if (auto ident = ast::cast<ast::Identifier>(member->getObject()); ident != nullptr)
+                {
+                    auto var = global(ident->getValue());
+                    return [var, field, cache](Frame &frame) mutable
+                    { return Record::at(resolve(var, frame), field, cache.shape, cache.slot); };
+                }
+
+                return [object, field, cache](Frame &frame) mutable
+                {
+                    auto record = object(frame);
+                    return Record::at(record, field, cache.shape, cache.slot);
+                };
+            }
+
+            /// @brief `object.field = rhs` and the compound assignments to a field.
+            /// @param op operator index of a compound assignment, OP_UNKNOWN for a plain one.
+            Expression lowerFieldAssignment(ast::MemberExpression *member, ast::Node *value, unsigned int op)
+            {
+                std::size_t local;
+                auto object = lowerObject(member, local);
+                auto rhs = lowerExpression(value);
+                auto field = member->getField();
+                ast::FieldCache cache;
+
+                return [object, local, rhs, field, op, cache](Frame &frame) mutable
+                {
+                    // the record is held until the field is written, whatever the rhs does to the variable.
+                    Value record = object ? object(frame) : frame.slots[local];
+                    auto value = rhs(frame);
+                    if (value.isEmpty())
+                        throw std::runtime_error("No value on rhs.");
+
+                    return Record::write(record, field, cache.shape, cache.slot, op, value);
+                };
+            }
+
+            /// @brief `object[index]`, an array or map in a variable is read in place like a record is.
+            Expression lowerIndex(ast::IndexExpression *element)
+            {
+                auto index = lowerExpression(element->getIndex());
+
+                std::size_t local;
+                if (auto ident = ast::cast<ast::Identifier>(element->getObject()); ident != nullptr)
+                {
+                    if (lookup(ident->getValue(), local))
+                    {
+                        return [local, index](Frame &frame)
+                        {
+                            auto at = index(frame);
+                            return operators::element(frame.slots[local], at);
+                        };
+                    }
+
+                    auto var = global(ident->getValue());
+                    return [var, index](Frame &frame)
+                    {
+                        auto at = index(frame);
+                        return operators::element(resolve(var, frame), at);
+                    };
+                }
+
+                auto object = lowerExpression(element->getObject());
+                return [object, index](Frame &frame)
+                {
+                    auto target = object(frame);
+                    auto at = index(frame);
+                    return operators::element(target, at);
+                };
+            }
+
+            /// @brief `object[index] = rhs` and the compound assignments to an element.
+            /// @param op operator index of a compound assignment, OP_UNKNOWN for a plain one.
+            Expression lowerIndexAssignment(ast::IndexExpression *element, ast::Node *value, unsigned int op)
+            {
+                auto object = lowerExpression(element->getObject());
+                auto index = lowerExpression(element->getIndex());
+                auto rhs = lowerExpression(value);
+
+                return [object, index, rhs, op](Frame &frame)
+                {
+                    // the array or map is held until the element is written, whatever the rhs does to the variable.
+                    auto target = object(frame);
+                    auto at = index(frame);
+                    auto value = rhs(frame);
+                    if (value.isEmpty())
+                        throw std::runtime_error("No value on rhs.");
+                    return operators::setElement(target, at, op, value);
+                };
+            }
+
+            Expression lowerArray(ast::ArrayLiteral *literal)
+            {
+                std::vector<Expression> elements;
+                for (auto &&element : literal->getElements())
+                    elements.push_back(lowerExpression(element));
+
+                return [elements](Frame &frame)
+                {
+                    Value array(new Array(elements.size()));
+                    auto data = static_cast<Array *>(array.getObject())->getData();
+                    for (std::size_t i = 0; i < elements.size(); i++)
+                    {
+                        auto element = elements[i](frame);
+                        if (element.isEmpty() || element.getKind() != consts::ID_NUMBER)
+                            throw std::runtime_error("Invalid type");
+                        data[i] = element.asNumber();
+                    }
+                    return array;
+                };
+            }
+
+            Expression lowerAssignment(ast::BinaryExpression *bin)
+            {
+                if (auto member = ast::cast<ast::MemberExpression>(bin->getLhs()); member != nullptr)
+                    return lowerFieldAssignment(member, bin->getRhs(), operators::OP_UNKNOWN);
+                if (auto element = ast::cast<ast::IndexExpression>(bin->getLhs()); element != nullptr)
+                    return lowerIndexAssignment(element, bin->getRhs(), operators::OP_UNKNOWN);
+                if (bin->getLhs()->getKind() != ast::consts::IDENTIFIER)
+                    throw std::runtime_error("Can not assign to value.");
+
+                auto &name = static_cast<ast::Identifier *>(bin->getLhs())->getValue();
+                auto rhs = lowerExpression(bin->getRhs());
+
+                std::size_t slot;
+                if (lookup(name, slot))
+                {
+                    return [slot, rhs](Frame &frame)
+                    {
+                        auto value = rhs(frame);
+                        if (value.isEmpty())
+                            throw std::runtime_error("No value on rhs.");
+                        frame.slots[slot] = value;
+                        return value;
+                    };
+                }
+
+                auto var = global(name);
+                return [var, rhs](Frame &frame)
+                {
+                    auto value = rhs(frame);
+                    if (value.isEmpty())
+                        throw std::runtime_error("No value on rhs.");
+                    if (auto local = var->shadowed ? dynamic(var, frame) : nullptr; local != nullptr)
+                        return *local = value;
+                    if (!var->declared)
+                        return Value();
+                    var->value = value;
+                    return value;
+                };
+            }
+
+            Expression lowerCompound(ast::BinaryExpression *bin, unsigned int op)
+            {
+                if (auto member = ast::cast<ast::MemberExpression>(bin->getLhs()); member != nullptr)
+                    return lowerFieldAssignment(member, bin->getRhs(), op);
+                if (auto element = ast::cast<ast::IndexExpression>(bin->getLhs()); element != nullptr)
+                    return lowerIndexAssignment(element, bin->getRhs(), op);
+                if (bin->getLhs()->getKind() != ast::consts::IDENTIFIER)
+                    throw std::runtime_error("Can not assign to value.");
+
+                auto &name = static_cast<ast::Identifier *>(bin->getLhs())->getValue();
+                auto rhs = lowerExpression(bin->getRhs());
+
+                std::size_t slot;
+                if (lookup(name, slot))
+                {
+                    return [slot, rhs, op](Frame &frame)
+                    {
+                        auto value = rhs(frame);
+                        auto &target = frame.slots[slot];
+                        if (target.isEmpty())
+                            throw std::runtime_error("No variable exsists");
+                        return operators::assign(op, target, value);
+                    };
+                }
+
+                auto var = global(name);
+                return [var, rhs, op](Frame &frame)
+                {
+                    auto value = rhs(frame);
+                    auto &target = resolve(var, frame);
+                    if (target.isEmpty())
+                        throw std::runtime_error("No variable exsists");
+                    return operators::assign(op, target, value);
+                };
+            }
+
+            Expression lowerBinary(ast::BinaryExpression *bin)
+            {
+                if (bin->getOp() == ast::consts::EQUAL)
+                    return lowerAssignment(bin);
+                if (auto base = operators::compound(bin->getOp()); base != 0)
+                    return lowerCompound(bin, operators::index(base));
+
+                auto lhs = lowerExpression(bin->getLhs());
+                auto rhs = lowerExpression(bin->getRhs());
+                auto op = operators::index(bin->getOp());
+
+                if (operators::isLogical(bin->getOp()))
+                {
+                    return [lhs, rhs, op](Frame &frame)
+                    {
+                        auto left = lhs(frame);
+                        if (auto result = operators::shortCircuit(op, left); !result.isEmpty())
+                            return result;
+                        return operators::apply(op, left, rhs(frame));
+                    };
+                }
+
+                return [lhs, rhs, op](Frame &frame)
+                { return operators::apply(op, lhs(frame), rhs(frame)); };
+            }
+
+            Expression lowerCall(ast::CallExpression *value)
+            {
+                std::vector<Expression> args;
+                for (auto &&arg : value->getArguments())
+                    args.push_back(lowerExpression(arg));
+
+                if (value->getExpression()->getKind() != ast::consts::IDENTIFIER)
+                {
+                    return [](Frame &) -> Value
+                    { throw std::runtime_error("Failed to execute function"); };
+                }
+
+                auto &name = static_cast<ast::Identifier *>(value->getExpression())->getValue();
+                auto fn = load(name);
+                auto locals = site();
+
+                // an intrinsic is evaluated in place until a global takes its name, a local one never gets here.
+                std::size_t slot;
+                auto id = value->getIntrinsic();
+                if (id != ast::consts::INTRINSIC_NONE && args.size() <= consts::HOST_INLINE_ARGUMENTS && !lookup(name, slot))
+                {
+                    auto var = global(name);
+                    Value builtin = *engine.builtins.find(name);
+                    return [var, builtin, fn, args, id, locals](Frame &frame)
+                    {
+                        if (var->declared || (var->shadowed && dynamic(var, frame) != nullptr))
+                            return call(fn(frame), args, frame, locals.get());
+
+                        Value values[consts::HOST_INLINE_ARGUMENTS];
+                        for (std::size_t i = 0; i < args.size(); i++)
+                            values[i] = args[i](frame);
+
+                        Value result;
+                        if (intrinsics::apply(id, values, args.size(), result))
+                            return result;
+                        return static_cast<InternalFunction *>(builtin.getObject())->call(values, args.size());
+                    };
+                }
+
+                return [fn, args, locals](Frame &frame)
+                { return call(fn(frame), args, frame, locals.get()); };
+            }
+
+            Expression lowerExpression(ast::Node *value)
+            {
+                switch (value->getKind())
+                {
+                case ast::consts::BINARY_EXPRESSION:
+                    return lowerBinary(static_cast<ast::BinaryExpression *>(value));
+                case ast::consts::CALL_EXPRESSION:
+                    return lowerCall(static_cast<ast::CallExpression *>(value));
+                case ast::consts::NUMBERIC_LITERAL:
+                {
+                    auto number = static_cast<ast::NumericLiteral *>(value);
+                    auto literal = number->isInteger() ? Value::integer(number->getInteger()) : Value(number->getValue());
+                    return [literal](Frame &)
+                    { return literal; };
+                }
+                case ast::consts::STRING_LITERAL:
+                {
+                    // literals are immutable, so every evaluation can share one interned string.
+                    Value literal = engine.strings.intern(static_cast<ast::StringLiteral *>(value)->getValue());
+                    return [literal](Frame &)
+                    { return literal; };
+                }
+                case ast::consts::IDENTIFIER:
+                    return lowerIdentifier(static_cast<ast::Identifier *>(value));
+                case ast::consts::MEMBER_EXPRESSION:
+                    return lowerMember(static_cast<ast::MemberExpression *>(value));
+                case ast::consts::INDEX_EXPRESSION:
+                    return lowerIndex(static_cast<ast::IndexExpression *>(value));
+                case ast::consts::ARRAY_LITERAL:
+                    return lowerArray(static_cast<ast::ArrayLiteral *>(value));
+                default:
+                    return [](Frame &) -> Value
+                    { throw std::runtime_error("Unknown expression."); };
+                }
+            }
+
+            Statement lowerDeclaration(ast::VariableDeclaration *decl)
+            {
+                auto &name = decl->getName()->getValue();
+                std::string type = decl->getType() != nullptr ? decl->getType()->getValue() : "";
+                bool supported = type == "string" || type == "number" || type == "number[]" || type == "map";
+
+                // the initializer is lowered before the name comes into scope so it still sees an outer variable of the same name.
+                Expression init;
+                if (decl->getInitalizer() != nullptr)
+                    init = lowerExpression(decl->getInitalizer());
+
+                if (isTopLevel())
+                {
+                    auto var = global(name);
+                    return [var, init, supported](Frame &frame)
+                    {
+                        Value value;
+                        if (init)
+                            value = init(frame);
+                        else if (!supported)
+                            throw std::runtime_error("Unsupported type");
+
+                        // like Context::set an existing variable keeps its value.
+                        if (!var->declared)
+                        {
+                            var->value = value;
+                            var->declared = true;
+                        }
+                        return false;
+                    };
+                }
+
+                auto &scope = scopes.back();
+                if (scope.find(name) != scope.end())
+                {
+                    return [init, supported](Frame &frame)
+                    {
+                        if (init)
+                            init(frame);
+                        else if (!supported)
+                            throw std::runtime_error("Unsupported type");
+                        return false;
+                    };
+                }
+
+                auto slot = slots++;
+                bind(name, slot);
+                return [slot, init, supported](Frame &frame)
+                {
+                    if (init)
+                        frame.slots[slot] = init(frame);
+                    else if (!supported)
+                        throw std::runtime_error("Unsupported type");
+                    else
+                        frame.slots[slot] = Value();
+                    return false;
+                };
+            }
+
+            Statement lowerFunction(ast::FunctionDeclartion *decl)
+            {
+                engine.procedures.emplace_back();
+                auto proc = &engine.procedures.back();
+                proc->name = decl->getName();
+
+                Lowering body(engine, true, false);
+                body.enter();
+                for (auto &&param : decl->getParameters())
+                {
+                    unsigned int kind = consts::ID_NULL;
+                    std::string record;
+                    if (param->getType()->getKind() == ast::consts::IDENTIFIER)
+                    {
+                        auto &type = static_cast<ast::Identifier *>(param->getType())->getValue();
+                        if (type == "string")
+                            kind = consts::ID_STRING;
+                        else if (type == "number")
+                            kind = consts::ID_NUMBER;
+                        else if (type == "number[]")
+                            kind = consts::ID_ARRAY;
+                        else if (type == "map")
+                            kind = consts::ID_MAP;
+                        else
+                        {
+                            // any other name is a struct, which does not have to be declared yet.
+                            kind = consts::ID_RECORD;
+                            record = type;
+                        }
+                    }
+                    proc->params.push_back(kind);
+                    proc->structs.push_back(record);
+                    body.bind(param->getName()->getValue(), body.slots++);
+                }
+
+                proc->body = body.lowerStatements(decl->getBody());
+                proc->slots = body.slots;
+
+                auto name = proc->name;
+                if (isTopLevel())
+                {
+                    auto var = global(name);
+                    return [var, proc, name](Frame &)
+                    {
+                        if (var->declared)
+                            throw std::runtime_error("A variable already exists with this name.");
+
+                        auto fn = new Function(name, nullptr, {});
+                        fn->setProcedure(proc);
+                        var->value = Value(fn);
+                        var->declared = true;
+                        return false;
+                    };
+                }
+
+                auto &scope = scopes.back();
+                if (scope.find(name) != scope.end())
+                {
+                    return [](Frame &) -> bool
+                    { throw std::runtime_error("A variable already exists with this name."); };
+                }
+
+                auto slot = slots++;
+                bind(name, slot);
+                return [slot, proc, name](Frame &frame)
+                {
+                    auto fn = new Function(name, nullptr, {});
+                    fn->setProcedure(proc);
+                    frame.slots[slot] = Value(fn);
+                    return false;
+                };
+            }
+
+            /// @brief the shape is laid out once here, every run of the declaration binds the same one.
+            Statement lowerStruct(ast::StructDeclaration *decl)
+            {
+                Value shape(new Shape(*decl));
+                auto &name = decl->getName();
+
+                if (isTopLevel())
+                {
+                    auto var = global(name);
+                    return [var, shape](Frame &)
+                    {
+                        if (var->declared)
+                            throw std::runtime_error("A variable already exists with this name.");
+
+                        var->value = shape;
+                        var->declared = true;
+                        return false;
+                    };
+                }
+
+                auto &scope = scopes.back();
+                if (scope.find(name) != scope.end())
+                {
+                    return [](Frame &) -> bool
+                    { throw std::runtime_error("A variable already exists with this name."); };
+                }
+
+                auto slot = slots++;
+                bind(name, slot);
+                return [slot, shape](Frame &frame)
+                {
+                    frame.slots[slot] = shape;
+                    return false;
+                };
+            }
+
+            Statement lowerIf(ast::IfStatement *value)
+            {
+                auto condition = lowerExpression(value->getExpression());
+                auto then = lowerBlock(value->getThen()->getStatements());
+
+                Statement otherwise;
+                if (auto elseBlock = value->getElse(); elseBlock != nullptr)
+                {
+                    if (elseBlock->getKind() == ast::consts::BLOCK_EXPRESSION)
+                        otherwise = lowerBlock(static_cast<ast::Block *>(elseBlock)->getStatements());
+                    else if (elseBlock->getKind() == ast::consts::IF_STATEMENT)
+                        otherwise = lowerIf(static_cast<ast::IfStatement *>(elseBlock));
+                }
+
+                if (!otherwise)
+                {
+                    return [condition, then](Frame &frame)
+                    { return condition(frame).truthy() && then(frame); };
+                }
+
+                return [condition, then, otherwise](Frame &frame)
+                {
+                    if (condition(frame).truthy())
+                        return then(frame);
+                    return otherwise(frame);
+                };
+            }
+
+            Statement lowerMatch(ast::MatchStatement *value)
+            {
+                auto subject = lowerExpression(value->getExpression());
+                auto table = value->getTable();
+
+                std::vector<Statement> bodies;
+                for (auto &&body : value->getBodies())
+                    bodies.push_back(lowerBlock(body->getStatements()));
+
+                Statement otherwise;
+                if (auto elseBlock = value->getElse(); elseBlock != nullptr)
+                    otherwise = lowerBlock(elseBlock->getStatements());
+
+                return [subject, table, bodies, otherwise](Frame &frame)
+                {
+                    auto result = subject(frame);
+
+                    int index = ast::CaseTable::NO_CASE;
+                    if (!result.isEmpty() && result.getKind() == consts::ID_NUMBER)
+                        index = table->find(result.asNumber());
+                    else if (auto text = cast<String>(result); text != nullptr)
+                        index = table->find(text->view(), text->hash());
+
+                    if (index != ast::CaseTable::NO_CASE)
+                        return bodies[index](frame);
+                    return otherwise && otherwise(frame);
+                };
+            }
+
+            Statement lowerWhile(ast::WhileExpression *value)
+            {
+                auto condition = lowerExpression(value->getExpression());
+                auto body = lowerBlock(value->getBody()->getStatements());
+                auto heap = &engine.heap;
+
+                return [condition, body, heap](Frame &frame)
+                {
+                    while (condition(frame).truthy())
+                    {
+                        heap->safepoint();
+                        if (body(frame))
+                            return true;
+                    }
+                    return false;
+                };
+            }
+
+            Statement lowerFor(ast::ForStatement *value)
+            {
+                auto from = lowerExpression(value->getFrom());
+                auto to = lowerExpression(value->getTo());
+                Expression step;
+                if (value->getStep() != nullptr)
+                    step = lowerExpression(value->getStep());
+
+                // the counter gets a slot in a scope of its own, so the loop also works at the top level.
+                enter();
+                auto slot = slots++;
+                bind(value->getName()->getValue(), slot);
+                auto body = lowerBlock(value->getBody()->getStatements());
+                leave();
+                auto heap = &engine.heap;
+
+                return [from, to, step, slot, body, heap](Frame &frame)
+                {
+                    auto first = bound(from(frame));
+                    auto end = bound(to(frame));
+                    auto increment = step ? bound(step(frame)) : Value::integer(1);
+                    if (increment.asNumber() == 0)
+                        throw std::runtime_error("Step of a for loop can not be 0.");
+
+                    auto &counter = frame.slots[slot];
+                    // integer bounds give an exact integer counter, anything else counts in doubles.
+                    if (first.isInteger() && end.isInteger() && increment.isInteger())
+                    {
+                        int64_t last = end.asInteger();
+                        int64_t by = increment.asInteger();
+                        for (int64_t i = first.asInteger(); by > 0 ? i < last : i > last; i += by)
+                        {
+                            counter = Value::integer(i);
+                            heap->safepoint();
+                            if (body(frame))
+                                return true;
+                            // the next counter would not fit, so it would be past the end anyway.
+                            if (by > 0 ? i > INT64_MAX - by : i < INT64_MIN - by)
+                                break;
+                        }
+                    }
+                    else
+                    {
+                        double last = end.asNumber();
+                        double by = increment.asNumber();
+                        for (double i = first.asNumber(); by > 0 ? i < last : i > last; i += by)
+                        {
+                            counter = Value(i);
+                            heap->safepoint();
+                            if (body(frame))
+                                return true;
+                        }
+                    }
+                    counter = Value();
+                    return false;
+                };
+            }
+
+            Statement lowerReturn(ast::ReturnStatement *value)
+            {
+                if (inFunction && value->getExpression()->getKind() == ast::consts::CALL_EXPRESSION)
+                {
+                    if (auto call = static_cast<ast::CallExpression *>(value->getExpression()); call->getExpression()->getKind() == ast::consts::IDENTIFIER)
+                        return lowerTailCall(call);
+                }
+
+                auto expr = lowerExpression(value->getExpression());
+
+                if (inFunction || (returnLast && isTopLevel()))
+                {
+                    return [expr](Frame &frame)
+                    {
+                        frame.result = expr(frame);
+                        return true;
+                    };
+                }
+
+                return [expr](Frame &frame) -> bool
+                {
+                    expr(frame);
+                    throw std::runtime_error("Uncaught SyntaxError: Illegal return statement");
+                };
+            }
+
+            /// @brief `return f(...)` hands a call to another function back to the caller, which runs it in the same frame.
+            Statement lowerTailCall(ast::CallExpression *value)
+            {
+                std::vector<Expression> args;
+                for (auto &&arg : value->getArguments())
+                    args.push_back(lowerExpression(arg));
+
+                auto fn = load(static_cast<ast::Identifier *>(value->getExpression())->getValue());
+                auto locals = site();
+                return [fn, args, locals](Frame &frame)
+                {
+                    auto target = fn(frame);
+                    if (target.isEmpty() || target.getKind() != consts::ID_FUNCTION)
+                    {
+                        frame.result = call(std::move(target), args, frame, locals.get());
+                        return true;
+                    }
+
+                    procedure(target, args.size());
+                    frame.arguments.clear();
+                    for (auto &&arg : args)
+                        frame.arguments.push_back(arg(frame));
+
+                    // the next callee still sees the locals of the frame it replaces, like it would see its caller's.
+                    for (auto &&[global, slot] : *locals)
+                    {
+                        auto &value = frame.slots[slot];
+                        if (value.isEmpty())
+                            continue;
+                        auto found = std::find_if(frame.replaced->begin(), frame.replaced->end(), [global = global](auto &entry)
+                                                  { return entry.first == global; });
+                        if (found != frame.replaced->end())
+                            found->second = value;
+                        else
+                            frame.replaced->emplace_back(global, value);
+                    }
+                    frame.tail = std::move(target);
+                    return true;
+                };
+            }
+
+            Statement lowerStatement(ast::Node *statement)
+            {
+                switch (statement->getKind())
+                {
+                case ast::consts::VARIABLE_STATEMENT:
+                {
+                    std::vector<Statement> declarations;
+                    for (auto &&decl : static_cast<ast::VariableStatement *>(statement)->getDeclarations())
+                        declarations.push_back(lowerDeclaration(decl));
+                    if (declarations.empty())
+                    {
+                        return [](Frame &)
+                        { return false; };
+                    }
+                    return sequence(declarations);
+                }
+                case ast::consts::IF_STATEMENT:
+                    return lowerIf(static_cast<ast::IfStatement *>(statement));
+                case ast::consts::MATCH_STATEMENT:
+                    return lowerMatch(static_cast<ast::MatchStatement *>(statement));
+                case ast::consts::FUNCTION_EXPRESSION:
+                    return lowerFunction(static_cast<ast::FunctionDeclartion *>(statement));
+                case ast::consts::EXPRESSION_STATEMENT:
+                {
+                    auto expr = lowerExpression(static_cast<ast::ExpressionStatement *>(statement)->getExpression());
+                    return [expr](Frame &frame)
+                    {
+                        expr(frame);
+                        return false;
+                    };
+                }
+                case ast::consts::RETURN_STATEMENT:
+                    return lowerReturn(static_cast<ast::ReturnStatement *>(statement));
+                case ast::consts::WHILE_EXRESSION:
+                    return lowerWhile(static_cast<ast::WhileExpression *>(statement));
+                case ast::consts::FOR_STATEMENT:
+                    return lowerFor(static_cast<ast::ForStatement *>(statement));
+                case ast::consts::STRUCT_DECLARATION:
+                    return lowerStruct(static_cast<ast::StructDeclaration *>(statement));
+                default:
+                    return [](Frame &) -> bool
+                    { throw std::runtime_error("Uncaught SyntaxError: Illegal statement"); };
+                }
+            }
+
+            Statement lowerStatements(std::vector<ast::Node *> &statements)
+            {
+                std::vector<Statement> lowered;
+                for (auto &&statement : statements)
+                    lowered.push_back(lowerStatement(statement));
+
+                if (lowered.empty())
+                {
+                    return [](Frame &)
+                    { return false; };
+                }
+                return sequence(lowered);
+            }
+
+            Statement lowerBlock(std::vector<ast::Node *> &statements)
+            {
+                enter();
+                auto block = lowerStatements(statements);
+                leave();
+                return block;
+            }
+
+        public:
+            Lowering(Engine &engine, bool inFunction, bool returnLast) : engine(engine), inFunction(inFunction), returnLast(returnLast) {}
+
+            inline std::size_t getSlots() const { return slots; }
+
+            /// @brief lower the top level statements of a program.
+            Statement lowerProgram(std::vector<ast::Node *> &statements)
+            {
+                std::vector<Statement> lowered;
+                for (std::size_t i = 0; i < statements.size(); i++)
+                {
+                    auto statement = statements[i];
+                    if (!returnLast || i + 1 != statements.size())
+                    {
+                        lowered.push_back(lowerStatement(statement));
+                        continue;
+                    }
+
+                    // the last statement leaves its value behind for the caller.
+                    if (statement->getKind() == ast::consts::EXPRESSION_STATEMENT)
+                    {
+                        auto expr = lowerExpression(static_cast<ast::ExpressionStatement *>(statement)->getExpression());
+                        lowered.push_back([expr](Frame &frame)
+                        {
+                            frame.result = expr(frame);
+                            return true;
+                        });
+                        continue;
+                    }
+
+                    auto last = lowerStatement(statement);
+                    lowered.push_back([last](Frame &frame)
+                    {
+                        if (!last(frame))
+                            frame.result = Value::null();
+                        return true;
+                    });
+                }
+
+                if (lowered.empty())
+                {
+                    return [](Frame &)
+                    { return false; };
+                }
+                return sequence(lowered);
+            }
+        };
+
+        Engine::Engine()
+        {
+            declare("false", Value::boolean(false));
+            declare("true", Value::boolean(true));
+        }
+
+        void Engine::declare(std::string key, Value value)
+        {
+            auto &var = globals[key];
+            if (var.declared)
+                return;
+
+            var.value = std::move(value);
+            var.declared = true;
+        }
+
+        void Engine::drop(std::string key)
+        {
+            // code lowered earlier holds the address of the global, so it is only emptied.
+            if (auto found = globals.find(key); found != globals.end())
+            {
+                found->second.value = Value();
+                found->second.declared = false;
+            }
+        }
+
+        Snapshot Engine::snapshot()
+        {
+            std::vector<std::pair<std::string, Value>> roots;
+            for (auto &&global : globals)
+                if (global.second.declared)
+                    roots.emplace_back(global.first, global.second.value);
+            strings.forEach([&](const Value &value)
+                            { roots.emplace_back("<literal>", value); });
+            return Snapshot::take(roots, &heap);
+        }
+
+        Value Engine::execute(ast::Program &program, bool returnLast)
+        {
+            Memory::Use charge(memory);
+            Heap::Use use(heap);
+            Lowering lowering(*this, false, returnLast);
+            auto body = lowering.lowerProgram(program.getStatements());
+
+            Region::Scope scope(frames);
+            Frame frame(lowering.getSlots(), &frames);
+            if (!body(frame))
+                return Value::null();
+            return frame.result;
+        }
+    } // namespace closure
+} // namespace jit
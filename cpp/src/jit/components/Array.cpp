@@ -0,0 +1,49 @@
+#include <vip/jit/components/Array.hpp>
+#include <vip/jit/Kernels.hpp>
+#include <stdexcept>
+#include <cmath>
+
+namespace jit
+{
+    Array::Array(std::size_t length, double value) : Object(KIND), data(nullptr), length(length)
+    {
+        if (length > SIZE_MAX / sizeof(double))
+            throw std::runtime_error("Array is too large.");
+        data = static_cast<double *>(Memory::allocate(length * sizeof(double), consts::ARRAY_ALIGNMENT));
+        kernels::best().fill(data, length, value);
+    }
+
+    Array::~Array()
+    {
+        Memory::deallocate(data);
+    }
+
+    std::size_t Array::slowSlot(const Value &index, std::size_t length)
+    {
+        if (index.isEmpty() || index.getKind() != consts::ID_NUMBER || index.isBoolean())
+            throw std::runtime_error("Array index must be a whole number.");
+
+        double at = index.asNumber();
+        if (std::trunc(at) != at)
+            throw std::runtime_error("Array index must be a whole number.");
+        if (at < 0 || at >= (double)length)
+            throw std::runtime_error("Index out of range.");
+        return (std::size_t)at;
+    }
+
+    void Array::set(const Value &index, const Value &value)
+    {
+        auto at = slot(index);
+        if (value.isEmpty() || value.getKind() != consts::ID_NUMBER)
+            throw std::runtime_error("Invalid type");
+        data[at] = value.asNumber();
+    }
+
+    void Array::print(std::ostream &where) const
+    {
+        where << "[";
+        for (std::size_t i = 0; i < length; i++)
+            where << (i == 0 ? "" : ", ") << data[i];
+        where << "]";
+    }
+} // namespace jit
@@ -2,6 +2,8 @@
 
 namespace jit
 {
+    std::atomic<unsigned long> Function::ids{0};
+
     Function::~Function()
     {
         if (body != nullptr)
@@ -1,11 +1,46 @@
 #include <vip/jit/components/InternalFunction.hpp>
+#include <stdexcept>
 
 namespace jit
 {
-    std::shared_ptr<Object> InternalFunction::execute(std::vector<std::shared_ptr<Object>> args)
+    InternalFunction::InternalFunction(std::string name, Signature signature, HostFunction callback)
+        : Object(KIND), name(name), func(nullptr), host(std::move(callback)), signature(std::move(signature))
     {
-        return func(args);
+        if (!host)
+            throw std::runtime_error("Host function " + this->name + " is empty.");
+
+        // wide integers are reported as numbers, so no value has ID_INTEGER as its kind.
+        for (auto &&kind : this->signature.params)
+            if (kind != Signature::ANY && (kind >= consts::ID_COUNT || kind == consts::ID_INTEGER))
+                throw std::runtime_error("Host function " + this->name + " takes a param of unknown kind.");
+    }
+
+    void InternalFunction::check(const Value *args, std::size_t count) const
+    {
+        auto &params = signature.params;
+        if (count < params.size() || (!signature.variadic && count != params.size()))
+            throw std::runtime_error("Given params does not function sig.");
+
+        for (std::size_t i = 0; i < params.size(); i++)
+            if (params[i] != Signature::ANY && args[i].getKind() != params[i])
+                throw std::runtime_error("Invalid type");
     }
+
+    Value InternalFunction::call(const Value *args, std::size_t count)
+    {
+        if (host)
+        {
+            check(args, count);
+            return host(Arguments(args, count));
+        }
+
+        std::vector<std::shared_ptr<Object>> boxed;
+        boxed.reserve(count);
+        for (std::size_t i = 0; i < count; i++)
+            boxed.push_back(box(args[i]));
+        return unbox(func(std::move(boxed)));
+    }
+
     void InternalFunction::print(std::ostream &out) const
     {
         out << "[function " << name << "]";
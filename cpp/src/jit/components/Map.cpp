@@ -0,0 +1,296 @@
+#include <vip/jit/components/Map.hpp>
+#include <vip/jit/components/String.hpp>
+#include <vip/jit/components/Record.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <cmath>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define VIP_MAP_SSE2
+#endif
+
+namespace jit
+{
+    namespace
+    {
+        static_assert(consts::MAP_GROUP == 16, "A group is compared in one sse2 register.");
+
+        /// @brief bit i is set for every control byte i of a group that equals byte.
+        inline uint32_t match(const int8_t *group, int8_t byte)
+        {
+#ifdef VIP_MAP_SSE2
+            auto controls = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+            return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(controls, _mm_set1_epi8(byte)));
+#else
+            uint32_t bits = 0;
+            for (std::size_t i = 0; i < consts::MAP_GROUP; i++)
+                bits |= (uint32_t)(group[i] == byte) << i;
+            return bits;
+#endif
+        }
+
+        /// @brief bit i is set for every slot of a group that is free or a tombstone, the ones with the high bit set.
+        inline uint32_t vacant(const int8_t *group)
+        {
+#ifdef VIP_MAP_SSE2
+            return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(group)));
+#else
+            uint32_t bits = 0;
+            for (std::size_t i = 0; i < consts::MAP_GROUP; i++)
+                bits |= (uint32_t)(group[i] < 0) << i;
+            return bits;
+#endif
+        }
+
+        inline unsigned int lowest(uint32_t bits)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return (unsigned int)__builtin_ctz(bits);
+#else
+            unsigned int index = 0;
+            while ((bits & 1) == 0)
+            {
+                bits >>= 1;
+                index++;
+            }
+            return index;
+#endif
+        }
+
+        /// @brief spread the bits of a hash, integer keys hash to themselves and would all share their low bits.
+        inline std::size_t mix(uint64_t hash)
+        {
+            hash ^= hash >> 33;
+            hash *= 0xff51afd7ed558ccdull;
+            hash ^= hash >> 33;
+            return (std::size_t)hash;
+        }
+
+        inline int8_t tag(std::size_t hash) { return (int8_t)(hash & 0x7f); }
+
+        /// @brief smallest number of slots that takes expected entries while staying 7/8 full at most.
+        std::size_t slotsFor(std::size_t expected)
+        {
+            std::size_t slots = consts::MAP_GROUP;
+            while (slots / 8 * 7 < expected)
+            {
+                if (slots > SIZE_MAX / 2 / sizeof(Value))
+                    throw std::runtime_error("Map is too large.");
+                slots *= 2;
+            }
+            return slots;
+        }
+    } // namespace
+
+    Map::Map(std::size_t expected) : Object(KIND, true)
+    {
+        reserve(expected);
+    }
+
+    Value Map::normalize(const Value &key, std::size_t &hash)
+    {
+        if (auto text = cast<String>(key); text != nullptr)
+        {
+            hash = mix(text->hash());
+            return key;
+        }
+        if (key.isEmpty() || key.getKind() != consts::ID_NUMBER)
+            throw std::runtime_error("Map keys must be numbers or strings.");
+
+        if (key.isInteger())
+        {
+            hash = mix((uint64_t)key.asInteger());
+            return key;
+        }
+
+        // a whole double is stored as the integer it equals, -0 included.
+        double number = key.asNumber();
+        if (number != number)
+            throw std::runtime_error("Map keys must be numbers or strings.");
+        if (std::trunc(number) == number && number >= -9223372036854775808.0 && number < 9223372036854775808.0)
+        {
+            hash = mix((uint64_t)(int64_t)number);
+            return Value::integer((int64_t)number);
+        }
+
+        uint64_t bits;
+        std::memcpy(&bits, &number, sizeof(bits));
+        hash = mix(bits);
+        return Value(number);
+    }
+
+    bool Map::same(const Value &lhs, const Value &rhs)
+    {
+        auto left = cast<String>(lhs), right = cast<String>(rhs);
+        if (left != nullptr || right != nullptr)
+            return left != nullptr && right != nullptr && *left == *right;
+
+        // both are normalized numbers, so an integer never equals a double.
+        if (lhs.isInteger() != rhs.isInteger())
+            return false;
+        if (lhs.isInteger())
+            return lhs.asInteger() == rhs.asInteger();
+        return lhs.asNumber() == rhs.asNumber();
+    }
+
+    std::size_t Map::probe(const Value &key, std::size_t hash) const
+    {
+        if (capacity == 0)
+            return capacity;
+
+        // groups are probed triangularly, which visits every group of a power of two table.
+        std::size_t groups = capacity / consts::MAP_GROUP;
+        std::size_t group = (hash >> 7) & (groups - 1);
+        for (std::size_t step = 1;; step++)
+        {
+            auto bytes = controls.data() + group * consts::MAP_GROUP;
+            for (auto bits = match(bytes, tag(hash)); bits != 0; bits &= bits - 1)
+            {
+                auto slot = group * consts::MAP_GROUP + lowest(bits);
+                if (same(entries[slot].key, key))
+                    return slot;
+            }
+            // a key is never put past a group with a free slot.
+            if (match(bytes, EMPTY) != 0)
+                return capacity;
+            group = (group + step) & (groups - 1);
+        }
+    }
+
+    std::size_t Map::vacancy(std::size_t hash) const
+    {
+        std::size_t groups = capacity / consts::MAP_GROUP;
+        std::size_t group = (hash >> 7) & (groups - 1);
+        for (std::size_t step = 1;; step++)
+        {
+            if (auto bits = vacant(controls.data() + group * consts::MAP_GROUP); bits != 0)
+                return group * consts::MAP_GROUP + lowest(bits);
+            group = (group + step) & (groups - 1);
+        }
+    }
+
+    void Map::rehash(std::size_t slots)
+    {
+        decltype(controls) newControls(slots, EMPTY);
+        decltype(entries) newEntries(slots);
+
+        newControls.swap(controls);
+        newEntries.swap(entries);
+        std::swap(capacity, slots);
+        growthLeft = capacity / 8 * 7 - count;
+
+        for (std::size_t i = 0; i < slots; i++)
+        {
+            if (newControls[i] < 0)
+                continue;
+
+            std::size_t hash;
+            normalize(newEntries[i].key, hash);
+            auto slot = vacancy(hash);
+            controls[slot] = tag(hash);
+            entries[slot] = std::move(newEntries[i]);
+        }
+    }
+
+    void Map::reserve(std::size_t expected)
+    {
+        if (expected == 0 && capacity == 0)
+            return;
+        if (auto slots = slotsFor(expected); slots > capacity)
+            rehash(slots);
+    }
+
+    Value *Map::find(const Value &key)
+    {
+        std::size_t hash;
+        auto stored = normalize(key, hash);
+        auto slot = probe(stored, hash);
+        return slot != capacity ? &entries[slot].value : nullptr;
+    }
+
+    Value &Map::insert(const Value &key)
+    {
+        std::size_t hash;
+        auto stored = normalize(key, hash);
+        if (auto slot = probe(stored, hash); slot != capacity)
+            return entries[slot].value;
+
+        if (growthLeft == 0)
+        {
+            // a map that is mostly tombstones is cleaned up in place, one that is mostly live doubles.
+            rehash(capacity != 0 && count < capacity / 16 * 7 ? capacity : slotsFor(count + 1));
+        }
+
+        auto slot = vacancy(hash);
+        if (controls[slot] == EMPTY)
+            growthLeft--;
+        controls[slot] = tag(hash);
+        entries[slot].key = std::move(stored);
+        count++;
+        return entries[slot].value;
+    }
+
+    bool Map::remove(const Value &key)
+    {
+        std::size_t hash;
+        auto stored = normalize(key, hash);
+        auto slot = probe(stored, hash);
+        if (slot == capacity)
+            return false;
+
+        entries[slot] = Entry();
+        count--;
+
+        // a group that has a free slot never made a probe move on, so the slot can be free again.
+        auto group = controls.data() + slot / consts::MAP_GROUP * consts::MAP_GROUP;
+        if (match(group, EMPTY) != 0)
+        {
+            controls[slot] = EMPTY;
+            growthLeft++;
+        }
+        else
+            controls[slot] = DELETED;
+        return true;
+    }
+
+    void Map::trace(Tracer &tracer)
+    {
+        for (std::size_t i = 0; i < capacity; i++)
+        {
+            if (controls[i] < 0)
+                continue;
+            tracer.visit(entries[i].key);
+            if (!entries[i].value.isEmpty())
+                tracer.visit(entries[i].value);
+        }
+    }
+
+    std::size_t Map::footprint() const
+    {
+        return Object::footprint() + Memory::size(controls.data()) + Memory::size(entries.data());
+    }
+
+    void Map::print(std::ostream &where) const
+    {
+        if (count == 0)
+        {
+            where << "{}";
+            return;
+        }
+
+        bool first = true;
+        where << "{";
+        for (std::size_t i = 0; i < capacity; i++)
+        {
+            if (controls[i] < 0)
+                continue;
+            where << (first ? " " : ", ") << entries[i].key << ": ";
+            printHeld(where, entries[i].value);
+            first = false;
+        }
+        where << " }";
+    }
+} // namespace jit
@@ -32,7 +32,7 @@ namespace jit
 
     Number operator/(Number &lhs, const Number &rhs)
     {
-        if (rhs.getValue() < 0)
+        if (rhs.getValue() == 0)
             throw std::overflow_error("Divide by zero exception");
         return Number(lhs.getValue() / rhs.getValue());
     }
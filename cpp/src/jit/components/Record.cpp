@@ -0,0 +1,93 @@
+#include <vip/jit/components/Record.hpp>
+#include <vip/jit/Operators.hpp>
+#include <stdexcept>
+#include <new>
+#include <utility>
+
+namespace jit
+{
+    static_assert(sizeof(Record) % alignof(Value) == 0, "The fields of a record have to start aligned.");
+
+    Record::Record(const Value &shape) : Object(KIND, true), shape(shape), shapeId(getShape().getId()), count(getShape().size())
+    {
+        for (std::size_t i = 0; i < count; i++)
+            new (getFields() + i) Value();
+    }
+
+    Record::~Record()
+    {
+        for (std::size_t i = 0; i < count; i++)
+            getFields()[i].~Value();
+    }
+
+    Value Record::make(const Value &shape, Value *values, std::size_t count)
+    {
+        auto layout = cast<Shape>(shape);
+        if (layout == nullptr)
+            throw std::runtime_error("Failed to execute function");
+        if (count != layout->size())
+            throw std::runtime_error("Given params does not function sig.");
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (!layout->accepts(i, values[i]))
+                throw std::runtime_error("Invalid type");
+        }
+
+        auto record = new (Fields{count}) Record(shape);
+        for (std::size_t i = 0; i < count; i++)
+            record->getFields()[i] = std::move(values[i]);
+        return Value(record);
+    }
+
+    Value &Record::miss(const Value &value, const std::string &field, unsigned long &cachedShape, std::size_t &cachedSlot)
+    {
+        if (value.isEmpty())
+            throw std::runtime_error("No variable exsists");
+
+        auto record = cast<Record>(value);
+        if (record == nullptr)
+            throw std::runtime_error("Only records have fields.");
+
+        auto slot = record->getShape().find(field);
+        if (slot == Shape::NO_FIELD)
+            throw std::runtime_error("No field " + field + " on struct " + record->getShape().getName() + ".");
+
+        cachedShape = record->shapeId;
+        cachedSlot = slot;
+        return record->getFields()[slot];
+    }
+
+    const Value &Record::write(const Value &value, const std::string &field, unsigned long &cachedShape, std::size_t &cachedSlot, unsigned int op, const Value &rhs)
+    {
+        auto &target = at(value, field, cachedShape, cachedSlot);
+        // operators only combine values of the same kind and keep it, so a compound result is of the
+        // field's type whenever rhs is.
+        if (!static_cast<Record *>(value.getObject())->getShape().accepts(cachedSlot, rhs))
+            throw std::runtime_error("Invalid type");
+        if (op == operators::OP_UNKNOWN)
+            return target = rhs;
+        return operators::assign(op, target, rhs);
+    }
+
+    void Record::trace(Tracer &tracer)
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (!getFields()[i].isEmpty())
+                tracer.visit(getFields()[i]);
+        }
+    }
+
+    void Record::print(std::ostream &where) const
+    {
+        auto &fields = getShape().getFields();
+        where << getShape().getName() << " {";
+        for (std::size_t i = 0; i < count; i++)
+        {
+            where << (i == 0 ? " " : ", ") << fields[i] << ": ";
+            printHeld(where, getFields()[i]);
+        }
+        where << " }";
+    }
+} // namespace jit
@@ -0,0 +1,64 @@
+#include <vip/jit/components/Shape.hpp>
+#include <vip/jit/components/Record.hpp>
+#include <vip/ast/Identifier.hpp>
+#include <stdexcept>
+
+namespace jit
+{
+    std::atomic<unsigned long> Shape::ids{0};
+
+    Shape::Shape(ast::StructDeclaration &declaration) : Object(KIND), name(declaration.getName()), id(++ids)
+    {
+        for (auto &&field : declaration.getFields())
+        {
+            auto &fieldName = field->getName()->getValue();
+            if (find(fieldName) != NO_FIELD)
+                throw std::runtime_error("A field already exists with this name.");
+
+            auto type = ast::cast<ast::Identifier>(field->getType());
+            if (type == nullptr)
+                throw std::runtime_error("Unable to detrmine type");
+
+            fields.push_back(fieldName);
+            types.push_back(type->getValue());
+        }
+    }
+
+    std::size_t Shape::find(const std::string &field) const
+    {
+        // structs have a handful of fields, a scan beats hashing the name.
+        for (std::size_t i = 0; i < fields.size(); i++)
+        {
+            if (fields[i] == field)
+                return i;
+        }
+        return NO_FIELD;
+    }
+
+    bool Shape::accepts(std::size_t slot, const Value &value) const
+    {
+        return isOfType(value, types[slot]);
+    }
+
+    bool Shape::isOfType(const Value &value, const std::string &type)
+    {
+        if (value.isEmpty())
+            return false;
+        if (type == "number")
+            return value.getKind() == consts::ID_NUMBER;
+        if (type == "string")
+            return value.getKind() == consts::ID_STRING;
+        if (type == "number[]")
+            return value.getKind() == consts::ID_ARRAY;
+        if (type == "map")
+            return value.getKind() == consts::ID_MAP;
+
+        auto record = cast<Record>(value);
+        return record != nullptr && record->getShape().getName() == type;
+    }
+
+    void Shape::print(std::ostream &where) const
+    {
+        where << "[struct " << name << "]";
+    }
+} // namespace jit
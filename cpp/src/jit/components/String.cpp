@@ -1,19 +1,180 @@
 #include <vip/jit/components/String.hpp>
+#include <vector>
 
 namespace jit
 {
+    namespace
+    {
+        inline const String &text(const Value &value) { return *static_cast<String *>(value.getObject()); }
+    } // namespace
+
+    String::String(Value lhs, Value rhs) : Object(KIND), left(std::move(lhs)), right(std::move(rhs)), offset(0), flat(false)
+    {
+        length = text(left).size() + text(right).size();
+    }
+
+    String::String(Value base, std::size_t offset, std::size_t length) : Object(KIND), offset(offset), length(length), flat(false)
+    {
+        // a slice views flat text, a slice of a slice views the text the first one does.
+        auto &of = text(base);
+        if (!of.flat && of.right.isEmpty())
+        {
+            this->offset += of.offset;
+            left = of.left;
+        }
+        else
+        {
+            of.getValue();
+            left = std::move(base);
+        }
+    }
+
+    String::~String()
+    {
+        dismantle(left);
+        dismantle(right);
+    }
+
+    void String::dismantle(Value &part)
+    {
+        std::vector<Value> parts;
+        parts.push_back(std::move(part));
+        while (!parts.empty())
+        {
+            auto next = std::move(parts.back());
+            parts.pop_back();
+
+            // the parts of a string only this one holds would go with it, take them over first.
+            if (next.isUnique())
+            {
+                auto &string = static_cast<String &>(*next.getObject());
+                if (!string.left.isEmpty())
+                    parts.push_back(std::move(string.left));
+                if (!string.right.isEmpty())
+                    parts.push_back(std::move(string.right));
+            }
+        }
+    }
+
+    void String::flatten() const
+    {
+        Text flattened;
+        flattened.reserve(length);
+
+        // parts are visited left to right without recursion, a rope can be thousands of parts deep.
+        std::vector<const String *> pending = {this};
+        while (!pending.empty())
+        {
+            auto part = pending.back();
+            pending.pop_back();
+            if (part->flat || part->right.isEmpty())
+            {
+                flattened += part->view();
+                continue;
+            }
+            pending.push_back(&text(part->right));
+            pending.push_back(&text(part->left));
+        }
+
+        value = std::move(flattened);
+        flat = true;
+        dismantle(left);
+        dismantle(right);
+    }
+
+    std::string_view String::view() const
+    {
+        if (flat)
+            return value;
+        if (right.isEmpty())
+            return std::string_view(text(left).value).substr(offset, length);
+        flatten();
+        return value;
+    }
+
+    std::string String::prefix(std::size_t count) const
+    {
+        std::string head;
+        std::vector<const String *> pending = {this};
+        while (!pending.empty() && head.size() < count)
+        {
+            auto part = pending.back();
+            pending.pop_back();
+            if (part->flat || part->right.isEmpty())
+            {
+                head += part->view().substr(0, count - head.size());
+                continue;
+            }
+            pending.push_back(&text(part->right));
+            pending.push_back(&text(part->left));
+        }
+        return head;
+    }
+
+    void String::append(const String &rhs)
+    {
+        if (!flat)
+            flatten();
+        value += rhs.view();
+        length = value.size();
+        hashed = false;
+    }
+
+    Value String::concat(const Value &lhs, const Value &rhs)
+    {
+        auto &a = text(lhs);
+        auto &b = text(rhs);
+        if (b.size() == 0)
+            return lhs;
+        if (a.size() == 0)
+            return rhs;
+
+        // short text is cheaper to copy than to keep as parts.
+        if (a.size() + b.size() < consts::ROPE_MIN_LENGTH)
+        {
+            Text joined;
+            joined.reserve(a.size() + b.size());
+            joined += a.view();
+            joined += b.view();
+            return Value(new String(std::move(joined)));
+        }
+        return Value(new String(lhs, rhs));
+    }
+
+    std::size_t String::footprint() const
+    {
+        // short text is kept inside the string itself.
+        auto buffer = value.capacity() > Text().capacity() ? value.capacity() + 1 : 0;
+        return Object::footprint() + buffer;
+    }
+
     void String::print(std::ostream &where) const
     {
-        where << value;
+        where << view();
+    }
+
+    void String::trace(Tracer &tracer)
+    {
+        if (!left.isEmpty())
+            tracer.visit(left);
+        if (!right.isEmpty())
+            tracer.visit(right);
     }
 
-    String operator+(String &lhs, const String &rhs)
+    bool operator<(const String &lhs, const String &rhs)
     {
-        return String(lhs.getValue() + rhs.getValue());
+        return lhs.view() < rhs.view();
     }
 
     bool operator==(const String &lhs, const String &rhs)
     {
-        return lhs.getValue() == rhs.getValue();
+        if (&lhs == &rhs)
+            return true;
+        // an interner keeps one string per text, so two different interned strings differ.
+        if (lhs.internedBy != 0 && lhs.internedBy == rhs.internedBy)
+            return false;
+        if (lhs.size() != rhs.size() || (lhs.hashed && rhs.hashed && lhs.hashCode != rhs.hashCode))
+            return false;
+        return lhs.view() == rhs.view();
     }
 } // namespace jit
@@ -0,0 +1,199 @@
+#include <vip/jit/native/Assembler.hpp>
+#include <cstring>
+
+namespace jit
+{
+    namespace native
+    {
+        static uint8_t modrm(uint8_t mod, uint8_t reg, uint8_t rm)
+        {
+            return (uint8_t)((mod << 6) | ((reg & 7) << 3) | (rm & 7));
+        }
+
+        void Assembler::int32(int32_t value)
+        {
+            uint8_t bytes[4];
+            std::memcpy(bytes, &value, 4);
+            code.insert(code.end(), bytes, bytes + 4);
+        }
+        void Assembler::int64(int64_t value)
+        {
+            uint8_t bytes[8];
+            std::memcpy(bytes, &value, 8);
+            code.insert(code.end(), bytes, bytes + 8);
+        }
+
+        void Assembler::sse(uint8_t prefix, uint8_t op, uint8_t dst, uint8_t src)
+        {
+            byte(prefix);
+            if (dst >= 8 || src >= 8)
+                byte((uint8_t)(0x40 | ((dst >= 8) << 2) | (src >= 8)));
+            byte(0x0F);
+            byte(op);
+            byte(modrm(3, dst, src));
+        }
+        void Assembler::sseFrame(uint8_t prefix, uint8_t op, uint8_t reg, int32_t disp)
+        {
+            byte(prefix);
+            if (reg >= 8)
+                byte(0x44);
+            byte(0x0F);
+            byte(op);
+            byte(modrm(2, reg, RBP));
+            int32(disp);
+        }
+
+        void Assembler::patch32(std::size_t at, int32_t value)
+        {
+            std::memcpy(&code[at], &value, 4);
+        }
+        void Assembler::bind(Label &label)
+        {
+            label.position = (int)code.size();
+            for (auto &&at : label.fixups)
+            {
+                int32_t rel = label.position - (int32_t)(at + 4);
+                std::memcpy(&code[at], &rel, 4);
+            }
+            label.fixups.clear();
+        }
+        void Assembler::jmp(Label &label)
+        {
+            byte(0xE9);
+            if (label.position >= 0)
+            {
+                int32(label.position - (int32_t)(code.size() + 4));
+                return;
+            }
+            label.fixups.push_back(code.size());
+            int32(0);
+        }
+        void Assembler::call(Label &label)
+        {
+            byte(0xE8);
+            if (label.position >= 0)
+            {
+                int32(label.position - (int32_t)(code.size() + 4));
+                return;
+            }
+            label.fixups.push_back(code.size());
+            int32(0);
+        }
+        void Assembler::jcc(Cond cond, Label &label)
+        {
+            byte(0x0F);
+            byte((uint8_t)(0x80 | cond));
+            if (label.position >= 0)
+            {
+                int32(label.position - (int32_t)(code.size() + 4));
+                return;
+            }
+            label.fixups.push_back(code.size());
+            int32(0);
+        }
+
+        void Assembler::push(Reg reg) { byte((uint8_t)(0x50 | reg)); }
+        void Assembler::pop(Reg reg) { byte((uint8_t)(0x58 | reg)); }
+        void Assembler::ret() { byte(0xC3); }
+        void Assembler::movRegReg(Reg dst, Reg src)
+        {
+            byte(0x48);
+            byte(0x89);
+            byte(modrm(3, src, dst));
+        }
+        void Assembler::movImm64(Reg dst, uint64_t value)
+        {
+            byte(0x48);
+            byte((uint8_t)(0xB8 | dst));
+            int64((int64_t)value);
+        }
+        std::size_t Assembler::subImm32(Reg dst, int32_t value)
+        {
+            byte(0x48);
+            byte(0x81);
+            byte(modrm(3, 5, dst));
+            int32(value);
+            return code.size() - 4;
+        }
+        void Assembler::cmpRspMem(Reg base)
+        {
+            byte(0x48);
+            byte(0x3B);
+            byte(modrm(0, RSP, base));
+        }
+        void Assembler::call(Reg reg)
+        {
+            byte(0xFF);
+            byte(modrm(3, 2, reg));
+        }
+        void Assembler::callMem(Reg reg)
+        {
+            byte(0xFF);
+            byte(modrm(0, 2, reg));
+        }
+
+        void Assembler::storeInt32(int32_t disp, Reg src)
+        {
+            byte(0x89);
+            byte(modrm(2, src, RBP));
+            int32(disp);
+        }
+        void Assembler::andInt32(Reg dst, int32_t disp)
+        {
+            byte(0x23);
+            byte(modrm(2, dst, RBP));
+            int32(disp);
+        }
+        void Assembler::orInt32(Reg dst, int32_t disp)
+        {
+            byte(0x0B);
+            byte(modrm(2, dst, RBP));
+            int32(disp);
+        }
+        void Assembler::testInt32(Reg reg)
+        {
+            byte(0x85);
+            byte(modrm(3, reg, reg));
+        }
+        void Assembler::setcc(Cond cond, Reg reg)
+        {
+            byte(0x0F);
+            byte((uint8_t)(0x90 | cond));
+            byte(modrm(3, 0, reg));
+        }
+        void Assembler::andByte(Reg dst, Reg src)
+        {
+            byte(0x20);
+            byte(modrm(3, src, dst));
+        }
+        void Assembler::orByte(Reg dst, Reg src)
+        {
+            byte(0x08);
+            byte(modrm(3, src, dst));
+        }
+        void Assembler::movzxByte(Reg dst, Reg src)
+        {
+            byte(0x0F);
+            byte(0xB6);
+            byte(modrm(3, dst, src));
+        }
+
+        void Assembler::movsdLoad(uint8_t xmm, int32_t disp) { sseFrame(0xF2, 0x10, xmm, disp); }
+        void Assembler::movsdStore(int32_t disp, uint8_t xmm) { sseFrame(0xF2, 0x11, xmm, disp); }
+        void Assembler::movsd(uint8_t dst, uint8_t src) { sse(0xF2, 0x10, dst, src); }
+        void Assembler::movqFromGp(uint8_t xmm, Reg src)
+        {
+            byte(0x66);
+            byte((uint8_t)(0x48 | ((xmm >= 8) << 2)));
+            byte(0x0F);
+            byte(0x6E);
+            byte(modrm(3, xmm, src));
+        }
+        void Assembler::addsd(uint8_t dst, uint8_t src) { sse(0xF2, 0x58, dst, src); }
+        void Assembler::subsd(uint8_t dst, uint8_t src) { sse(0xF2, 0x5C, dst, src); }
+        void Assembler::mulsd(uint8_t dst, uint8_t src) { sse(0xF2, 0x59, dst, src); }
+        void Assembler::divsd(uint8_t dst, uint8_t src) { sse(0xF2, 0x5E, dst, src); }
+        void Assembler::ucomisd(uint8_t lhs, uint8_t rhs) { sse(0x66, 0x2E, lhs, rhs); }
+        void Assembler::xorpd(uint8_t dst, uint8_t src) { sse(0x66, 0x57, dst, src); }
+    } // namespace native
+} // namespace jit
@@ -0,0 +1,928 @@
+#include <vip/jit/native/Compiler.hpp>
+#include <vip/jit/native/Assembler.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+
+#include <vip/jit/components/Function.hpp>
+#include <vip/ast/ExpressionStatement.hpp>
+#include <vip/ast/VariableStatement.hpp>
+#include <vip/ast/BinaryExpression.hpp>
+#include <vip/ast/ReturnStatement.hpp>
+#include <vip/ast/WhileExpression.hpp>
+#include <vip/ast/CallExpression.hpp>
+#include <vip/ast/NumericLiteral.hpp>
+#include <vip/ast/MatchStatement.hpp>
+#include <vip/ast/ForStatement.hpp>
+#include <vip/ast/IfStatement.hpp>
+#include <vip/ast/Identifier.hpp>
+#include <vip/ast/Consts.hpp>
+#include <vip/jit/Consts.hpp>
+
+#if defined(__x86_64__) && defined(__linux__)
+#define VIP_NATIVE_X64
+#include <sys/mman.h>
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+namespace jit
+{
+    namespace native
+    {
+#ifdef VIP_NATIVE_X64
+        namespace
+        {
+            const std::size_t MAX_ARGS = 8;
+            /// @brief numbers at or beyond this magnitude may be rounded as doubles.
+            const double EXACT_LIMIT = 9007199254740992.0;
+            /// @brief stack left for the interpreter once native code bails out for running out of stack.
+            const uintptr_t STACK_HEADROOM = 256 * 1024;
+
+            /// @brief thrown while generating code for a construct the compiler does not support.
+            struct Unsupported
+            {
+                Function *fn;
+            };
+
+            [[noreturn]] void bailout(State *state)
+            {
+                std::longjmp(*state->jump, 1);
+            }
+
+            uintptr_t stackLow()
+            {
+                static thread_local uintptr_t low = 0;
+                if (low != 0)
+                    return low;
+
+                pthread_attr_t attr;
+                if (pthread_getattr_np(pthread_self(), &attr) == 0)
+                {
+                    void *addr = nullptr;
+                    std::size_t size = 0;
+                    if (pthread_attr_getstack(&attr, &addr, &size) == 0)
+                        low = (uintptr_t)addr;
+                    pthread_attr_destroy(&attr);
+                }
+
+                if (low == 0)
+                {
+                    // assume a small stack below the current frame.
+                    int marker = 0;
+                    low = (uintptr_t)&marker - 512 * 1024;
+                }
+
+                return low;
+            }
+
+            struct Unit
+            {
+                Function *fn;
+                Label entry;
+                std::set<std::string> locals;
+                std::set<std::string> callees;
+            };
+
+            /// @brief functions compiled together into one code buffer.
+            struct Group
+            {
+                Context *scope;
+                std::deque<Unit> units;
+                std::vector<NativeFunction *> externals;
+                std::map<std::string, unsigned long> dependencies;
+
+                Unit &add(Function *fn)
+                {
+                    units.push_back(Unit{fn, Label(), {}, {}});
+                    return units.back();
+                }
+
+                /// @brief resolve a called name to a unit in this group or already compiled code.
+                std::pair<Unit *, NativeFunction *> resolve(Unit &from, const std::string &name)
+                {
+                    auto obj = scope->get(name);
+                    auto fn = cast<Function>(obj);
+                    if (fn == nullptr)
+                        throw Unsupported{from.fn};
+
+                    dependencies[name] = fn->getId();
+
+                    if (auto code = fn->getNative(); code != nullptr)
+                    {
+                        externals.push_back(code);
+                        return std::make_pair(nullptr, code);
+                    }
+
+                    if (fn->isNativeRejected())
+                        throw Unsupported{from.fn};
+
+                    for (auto &&unit : units)
+                        if (unit.fn == fn)
+                            return std::make_pair(&unit, nullptr);
+
+                    return std::make_pair(&add(fn), nullptr);
+                }
+            };
+
+            class Generator
+            {
+            private:
+                Assembler &a;
+                State *state;
+                Group &group;
+                Unit &unit;
+                Label bail;
+                Label exit;
+                std::vector<std::map<std::string, int32_t>> scopes;
+                std::vector<int32_t> temps;
+                int32_t slots = 0;
+
+                [[noreturn]] void unsupported() { throw Unsupported{unit.fn}; }
+
+                int32_t allocate()
+                {
+                    slots++;
+                    return -8 * slots;
+                }
+                int32_t acquire()
+                {
+                    if (temps.empty())
+                        return allocate();
+                    auto disp = temps.back();
+                    temps.pop_back();
+                    return disp;
+                }
+                void release(int32_t disp) { temps.push_back(disp); }
+
+                int32_t declare(const std::string &name)
+                {
+                    auto &scope = scopes.back();
+                    if (scope.find(name) != scope.end())
+                        unsupported();
+
+                    unit.locals.insert(name);
+                    auto disp = allocate();
+                    scope[name] = disp;
+                    return disp;
+                }
+                int32_t lookup(const std::string &name)
+                {
+                    for (auto it = scopes.rbegin(); it != scopes.rend(); it++)
+                    {
+                        if (auto found = it->find(name); found != it->end())
+                            return found->second;
+                    }
+                    unsupported();
+                }
+
+                static bool isSimple(ast::Node *node)
+                {
+                    return node->getKind() == ast::consts::NUMBERIC_LITERAL || node->getKind() == ast::consts::IDENTIFIER;
+                }
+                void loadConstant(uint8_t xmm, double value)
+                {
+                    uint64_t bits;
+                    std::memcpy(&bits, &value, sizeof(bits));
+                    a.movImm64(RAX, bits);
+                    a.movqFromGp(xmm, RAX);
+                }
+                void loadSimple(uint8_t xmm, ast::Node *node)
+                {
+                    if (auto num = ast::cast<ast::NumericLiteral>(node); num != nullptr)
+                    {
+                        if (std::fabs(num->getValue()) >= EXACT_LIMIT)
+                            unsupported();
+                        loadConstant(xmm, num->getValue());
+                        return;
+                    }
+                    if (auto ident = ast::cast<ast::Identifier>(node); ident != nullptr)
+                    {
+                        a.movsdLoad(xmm, lookup(ident->getValue()));
+                        return;
+                    }
+                    unsupported();
+                }
+
+                /// @brief evaluate lhs into xmm0 and rhs into xmm1.
+                void genOperands(ast::BinaryExpression *bin)
+                {
+                    if (isSimple(bin->getRhs()))
+                    {
+                        genNumber(bin->getLhs());
+                        loadSimple(1, bin->getRhs());
+                        return;
+                    }
+
+                    genNumber(bin->getLhs());
+                    auto lhs = acquire();
+                    a.movsdStore(lhs, 0);
+                    genNumber(bin->getRhs());
+                    a.movsd(1, 0);
+                    a.movsdLoad(0, lhs);
+                    release(lhs);
+                }
+
+                /// @brief load the arguments of a call into xmm0 and up.
+                /// @return the unit or compiled code that is called.
+                std::pair<Unit *, NativeFunction *> genArguments(ast::CallExpression *call)
+                {
+                    auto name = ast::cast<ast::Identifier>(call->getExpression());
+                    if (name == nullptr)
+                        unsupported();
+
+                    unit.callees.insert(name->getValue());
+                    auto target = group.resolve(unit, name->getValue());
+                    auto &args = call->getArguments();
+
+                    std::size_t arity = target.first != nullptr ? target.first->fn->getParams().size() : target.second->arity;
+                    if (args.size() != arity || args.size() > MAX_ARGS)
+                        unsupported();
+
+                    std::vector<int32_t> values;
+                    for (auto &&arg : args)
+                    {
+                        genNumber(arg);
+                        auto disp = acquire();
+                        a.movsdStore(disp, 0);
+                        values.push_back(disp);
+                    }
+                    for (std::size_t i = 0; i < values.size(); i++)
+                        a.movsdLoad((uint8_t)i, values[i]);
+                    for (auto it = values.rbegin(); it != values.rend(); it++)
+                        release(*it);
+                    return target;
+                }
+
+                void genCall(ast::CallExpression *call)
+                {
+                    auto target = genArguments(call);
+                    if (target.first != nullptr)
+                    {
+                        a.call(target.first->entry);
+                        return;
+                    }
+
+                    a.movImm64(RAX, reinterpret_cast<uint64_t>(target.second->entry));
+                    a.call(RAX);
+                }
+
+                /// @brief `return f(...)` to a function of this group drops the frame and jumps, so the stack does not grow.
+                void genTailCall(ast::CallExpression *call)
+                {
+                    auto target = genArguments(call);
+                    if (target.first == nullptr)
+                    {
+                        a.movImm64(RAX, reinterpret_cast<uint64_t>(target.second->entry));
+                        a.call(RAX);
+                        a.jmp(exit);
+                        return;
+                    }
+
+                    a.movRegReg(RSP, RBP);
+                    a.pop(RBP);
+                    a.jmp(target.first->entry);
+                }
+
+                /// @brief bail out when xmm0 may no longer equal the interpreter's result, the interpreter keeps
+                /// integers exact up to 64 bits while doubles round from 2^53 on.
+                void genExact()
+                {
+                    loadConstant(2, EXACT_LIMIT);
+                    a.ucomisd(0, 2);
+                    a.jcc(COND_AE, bail);
+                    a.jcc(COND_P, bail);
+                    loadConstant(2, -EXACT_LIMIT);
+                    a.ucomisd(2, 0);
+                    a.jcc(COND_AE, bail);
+                }
+
+                /// @brief xmm0 / xmm1 into xmm0.
+                void genDivide()
+                {
+                    // the interpreter throws on a zero divisor, let it.
+                    Label ok;
+                    a.xorpd(2, 2);
+                    a.ucomisd(1, 2);
+                    a.jcc(COND_NE, ok);
+                    a.jcc(COND_P, ok);
+                    a.jmp(bail);
+                    a.bind(ok);
+                    a.divsd(0, 1);
+                }
+
+                /// @brief `x += e` and friends on a local number.
+                void genCompound(ast::BinaryExpression *bin)
+                {
+                    auto ident = ast::cast<ast::Identifier>(bin->getLhs());
+                    if (ident == nullptr)
+                        unsupported();
+
+                    auto disp = lookup(ident->getValue());
+                    genNumber(bin->getRhs());
+                    a.movsd(1, 0);
+                    a.movsdLoad(0, disp);
+                    switch (bin->getOp())
+                    {
+                    case ast::consts::SET_PLUS:
+                        a.addsd(0, 1);
+                        break;
+                    case ast::consts::SET_MINUS:
+                        a.subsd(0, 1);
+                        break;
+                    case ast::consts::SET_MULT:
+                        a.mulsd(0, 1);
+                        break;
+                    default:
+                        genDivide();
+                        break;
+                    }
+                    genExact();
+                    a.movsdStore(disp, 0);
+                }
+
+                /// @brief generate code that leaves a number in xmm0.
+                void genNumber(ast::Node *node)
+                {
+                    switch (node->getKind())
+                    {
+                    case ast::consts::NUMBERIC_LITERAL:
+                    case ast::consts::IDENTIFIER:
+                        loadSimple(0, node);
+                        return;
+                    case ast::consts::CALL_EXPRESSION:
+                        genCall(static_cast<ast::CallExpression *>(node));
+                        return;
+                    case ast::consts::BINARY_EXPRESSION:
+                    {
+                        auto bin = static_cast<ast::BinaryExpression *>(node);
+                        switch (bin->getOp())
+                        {
+                        case ast::consts::PLUS:
+                            genOperands(bin);
+                            a.addsd(0, 1);
+                            genExact();
+                            return;
+                        case ast::consts::MINUS:
+                            genOperands(bin);
+                            a.subsd(0, 1);
+                            genExact();
+                            return;
+                        case ast::consts::MULT:
+                            genOperands(bin);
+                            a.mulsd(0, 1);
+                            genExact();
+                            return;
+                        case ast::consts::DIV:
+                            genOperands(bin);
+                            genDivide();
+                            genExact();
+                            return;
+                        default:
+                            unsupported();
+                        }
+                    }
+                    default:
+                        unsupported();
+                    }
+                }
+
+                /// @brief generate code that leaves 0 or 1 in eax.
+                void genCondition(ast::Node *node)
+                {
+                    if (node->getKind() == ast::consts::BINARY_EXPRESSION)
+                    {
+                        auto bin = static_cast<ast::BinaryExpression *>(node);
+                        switch (bin->getOp())
+                        {
+                        case ast::consts::LESS_THEN:
+                            genOperands(bin);
+                            a.ucomisd(1, 0);
+                            a.setcc(COND_A, RAX);
+                            a.movzxByte(RAX, RAX);
+                            return;
+                        case ast::consts::GREATER_THEN:
+                            genOperands(bin);
+                            a.ucomisd(0, 1);
+                            a.setcc(COND_A, RAX);
+                            a.movzxByte(RAX, RAX);
+                            return;
+                        case ast::consts::LESS_THEN_OR_EQUAL:
+                            // !(lhs > rhs), so unordered operands compare true like the interpreter.
+                            genOperands(bin);
+                            a.ucomisd(0, 1);
+                            a.setcc(COND_BE, RAX);
+                            a.movzxByte(RAX, RAX);
+                            return;
+                        case ast::consts::GREATER_THEN_OR_EQUAL:
+                            genOperands(bin);
+                            a.ucomisd(1, 0);
+                            a.setcc(COND_BE, RAX);
+                            a.movzxByte(RAX, RAX);
+                            return;
+                        case ast::consts::EQUAL_EQUAL:
+                            // unordered operands are never equal.
+                            genOperands(bin);
+                            a.ucomisd(0, 1);
+                            a.setcc(COND_E, RAX);
+                            a.setcc(COND_NP, RCX);
+                            a.andByte(RAX, RCX);
+                            a.movzxByte(RAX, RAX);
+                            return;
+                        case ast::consts::NOT_EQUAL:
+                            genOperands(bin);
+                            a.ucomisd(0, 1);
+                            a.setcc(COND_NE, RAX);
+                            a.setcc(COND_P, RCX);
+                            a.orByte(RAX, RCX);
+                            a.movzxByte(RAX, RAX);
+                            return;
+                        case ast::consts::AND:
+                        case ast::consts::OR:
+                        {
+                            // the rhs only runs when the lhs does not decide the result, which is left in rax.
+                            Label end;
+                            genCondition(bin->getLhs());
+                            a.testInt32(RAX);
+                            a.jcc(bin->getOp() == ast::consts::AND ? COND_E : COND_NE, end);
+                            genCondition(bin->getRhs());
+                            a.bind(end);
+                            return;
+                        }
+                        default:
+                            break;
+                        }
+                    }
+
+                    genNumber(node);
+                    a.xorpd(1, 1);
+                    a.ucomisd(0, 1);
+                    a.setcc(COND_NE, RAX);
+                    a.setcc(COND_P, RCX);
+                    a.orByte(RAX, RCX);
+                    a.movzxByte(RAX, RAX);
+                }
+
+                void genBlock(std::vector<ast::Node *> &statements)
+                {
+                    scopes.emplace_back();
+                    genStatements(statements);
+                    scopes.pop_back();
+                }
+
+                void genStatements(std::vector<ast::Node *> &statements)
+                {
+                    for (auto &&statement : statements)
+                        genStatement(statement);
+                }
+
+                void genIf(ast::IfStatement *value)
+                {
+                    Label otherwise;
+                    Label end;
+                    genCondition(value->getExpression());
+                    a.testInt32(RAX);
+                    a.jcc(COND_E, otherwise);
+                    genBlock(value->getThen()->getStatements());
+                    a.jmp(end);
+                    a.bind(otherwise);
+
+                    if (auto elseBlock = value->getElse(); elseBlock != nullptr)
+                    {
+                        if (elseBlock->getKind() == ast::consts::IF_STATEMENT)
+                            genIf(static_cast<ast::IfStatement *>(elseBlock));
+                        else if (elseBlock->getKind() == ast::consts::BLOCK_EXPRESSION)
+                            genBlock(static_cast<ast::Block *>(elseBlock)->getStatements());
+                        else
+                            unsupported();
+                    }
+
+                    a.bind(end);
+                }
+
+                /// @brief jump to the label of the case equal to xmm0, searching the sorted cases in [low, high).
+                void genCases(std::vector<std::pair<double, Label *>> &cases, std::size_t low, std::size_t high, Label &otherwise)
+                {
+                    if (low == high)
+                    {
+                        a.jmp(otherwise);
+                        return;
+                    }
+
+                    std::size_t middle = low + (high - low) / 2;
+                    Label above;
+                    loadConstant(1, cases[middle].first);
+                    a.ucomisd(0, 1);
+                    a.jcc(COND_E, *cases[middle].second);
+                    a.jcc(COND_A, above);
+                    genCases(cases, low, middle, otherwise);
+                    a.bind(above);
+                    genCases(cases, middle + 1, high, otherwise);
+                }
+
+                /// @brief number cases are found by a binary search on their values, strings never match a number.
+                void genMatch(ast::MatchStatement *value)
+                {
+                    auto &values = value->getValues();
+                    std::vector<Label> labels(values.size());
+                    std::vector<std::pair<double, Label *>> cases;
+                    for (std::size_t i = 0; i < values.size(); i++)
+                    {
+                        if (auto num = ast::cast<ast::NumericLiteral>(values[i]); num != nullptr)
+                            cases.emplace_back(num->getValue(), &labels[i]);
+                    }
+                    std::sort(cases.begin(), cases.end(), [](auto &lhs, auto &rhs)
+                              { return lhs.first < rhs.first; });
+
+                    Label otherwise;
+                    Label end;
+                    genNumber(value->getExpression());
+                    // nan is unordered with every case.
+                    a.ucomisd(0, 0);
+                    a.jcc(COND_P, otherwise);
+                    genCases(cases, 0, cases.size(), otherwise);
+
+                    for (std::size_t i = 0; i < values.size(); i++)
+                    {
+                        a.bind(labels[i]);
+                        genBlock(value->getBodies()[i]->getStatements());
+                        a.jmp(end);
+                    }
+
+                    a.bind(otherwise);
+                    if (value->getElse() != nullptr)
+                        genBlock(value->getElse()->getStatements());
+                    a.bind(end);
+                }
+
+                /// @brief the counter stays in a stack slot and is copied into the loop variable every iteration,
+                /// only literal steps are supported so the direction is known here.
+                void genFor(ast::ForStatement *value)
+                {
+                    double step = 1;
+                    if (auto literal = value->getStep(); literal != nullptr)
+                    {
+                        if (literal->getKind() != ast::consts::NUMBERIC_LITERAL)
+                            unsupported();
+                        step = static_cast<ast::NumericLiteral *>(literal)->getValue();
+                    }
+                    // a zero step throws in the interpreter.
+                    if (step == 0)
+                        unsupported();
+
+                    auto counter = acquire();
+                    auto limit = acquire();
+                    genNumber(value->getFrom());
+                    a.movsdStore(counter, 0);
+                    genNumber(value->getTo());
+                    a.movsdStore(limit, 0);
+
+                    scopes.emplace_back();
+                    auto disp = declare(value->getName()->getValue());
+
+                    Label top;
+                    Label end;
+                    a.bind(top);
+                    a.movsdLoad(0, counter);
+                    a.movsdLoad(1, limit);
+                    // unordered bounds end the loop like a false comparison.
+                    if (step > 0)
+                        a.ucomisd(1, 0);
+                    else
+                        a.ucomisd(0, 1);
+                    a.jcc(COND_BE, end);
+                    a.movsdStore(disp, 0);
+                    genBlock(value->getBody()->getStatements());
+                    a.movsdLoad(0, counter);
+                    loadConstant(1, step);
+                    a.addsd(0, 1);
+                    genExact();
+                    a.movsdStore(counter, 0);
+                    a.jmp(top);
+                    a.bind(end);
+
+                    scopes.pop_back();
+                    release(limit);
+                    release(counter);
+                }
+
+                void genStatement(ast::Node *statement)
+                {
+                    switch (statement->getKind())
+                    {
+                    case ast::consts::VARIABLE_STATEMENT:
+                    {
+                        for (auto &&decl : static_cast<ast::VariableStatement *>(statement)->getDeclarations())
+                        {
+                            if (decl->getType() == nullptr || decl->getType()->getValue() != "number" || decl->getInitalizer() == nullptr)
+                                unsupported();
+
+                            genNumber(decl->getInitalizer());
+                            a.movsdStore(declare(decl->getName()->getValue()), 0);
+                        }
+                        return;
+                    }
+                    case ast::consts::EXPRESSION_STATEMENT:
+                    {
+                        auto expr = static_cast<ast::ExpressionStatement *>(statement)->getExpression();
+                        if (expr->getKind() == ast::consts::BINARY_EXPRESSION)
+                        {
+                            auto bin = static_cast<ast::BinaryExpression *>(expr);
+                            if (bin->getOp() == ast::consts::EQUAL)
+                            {
+                                auto ident = ast::cast<ast::Identifier>(bin->getLhs());
+                                if (ident == nullptr)
+                                    unsupported();
+
+                                auto disp = lookup(ident->getValue());
+                                genNumber(bin->getRhs());
+                                a.movsdStore(disp, 0);
+                                return;
+                            }
+
+                            switch (bin->getOp())
+                            {
+                            case ast::consts::SET_PLUS:
+                            case ast::consts::SET_MINUS:
+                            case ast::consts::SET_MULT:
+                            case ast::consts::SET_DIV:
+                                genCompound(bin);
+                                return;
+                            default:
+                                break;
+                            }
+                        }
+
+                        genNumber(expr);
+                        return;
+                    }
+                    case ast::consts::RETURN_STATEMENT:
+                    {
+                        auto expr = static_cast<ast::ReturnStatement *>(statement)->getExpression();
+                        if (expr->getKind() == ast::consts::CALL_EXPRESSION)
+                        {
+                            genTailCall(static_cast<ast::CallExpression *>(expr));
+                            return;
+                        }
+                        genNumber(expr);
+                        a.jmp(exit);
+                        return;
+                    }
+                    case ast::consts::IF_STATEMENT:
+                        genIf(static_cast<ast::IfStatement *>(statement));
+                        return;
+                    case ast::consts::MATCH_STATEMENT:
+                        genMatch(static_cast<ast::MatchStatement *>(statement));
+                        return;
+                    case ast::consts::FOR_STATEMENT:
+                        genFor(static_cast<ast::ForStatement *>(statement));
+                        return;
+                    case ast::consts::WHILE_EXRESSION:
+                    {
+                        auto loop = static_cast<ast::WhileExpression *>(statement);
+                        Label top;
+                        Label end;
+                        a.bind(top);
+                        genCondition(loop->getExpression());
+                        a.testInt32(RAX);
+                        a.jcc(COND_E, end);
+                        genBlock(loop->getBody()->getStatements());
+                        a.jmp(top);
+                        a.bind(end);
+                        return;
+                    }
+                    default:
+                        unsupported();
+                    }
+                }
+
+            public:
+                Generator(Assembler &a, State *state, Group &group, Unit &unit) : a(a), state(state), group(group), unit(unit) {}
+
+                void generate()
+                {
+                    auto &params = unit.fn->getParams();
+                    if (params.size() > MAX_ARGS)
+                        unsupported();
+
+                    a.bind(unit.entry);
+                    a.push(RBP);
+                    a.movRegReg(RBP, RSP);
+                    auto frame = a.subImm32(RSP, 0);
+                    a.movImm64(RAX, reinterpret_cast<uint64_t>(&state->stackLimit));
+                    a.cmpRspMem(RAX);
+                    a.jcc(COND_B, bail);
+
+                    // params and top level locals share the function context.
+                    scopes.emplace_back();
+                    for (std::size_t i = 0; i < params.size(); i++)
+                    {
+                        auto type = ast::cast<ast::Identifier>(params[i]->getType());
+                        if (type == nullptr || type->getValue() != "number")
+                            unsupported();
+
+                        a.movsdStore(declare(params[i]->getName()->getValue()), (uint8_t)i);
+                    }
+                    genStatements(unit.fn->getBody()->getStatements());
+
+                    // falling off the end returns null, which only the interpreter can represent.
+                    a.jmp(bail);
+
+                    a.bind(exit);
+                    a.movRegReg(RSP, RBP);
+                    a.pop(RBP);
+                    a.ret();
+
+                    a.bind(bail);
+                    a.movImm64(RDI, reinterpret_cast<uint64_t>(state));
+                    a.movImm64(RAX, reinterpret_cast<uint64_t>(&bailout));
+                    a.call(RAX);
+
+                    a.patch32(frame, (slots * 8 + 15) & ~15);
+                }
+            };
+        } // namespace
+
+        bool Compiler::isSupported()
+        {
+            return true;
+        }
+
+        Compiler::~Compiler()
+        {
+            for (auto &&page : pages)
+                munmap(page.first, page.second);
+        }
+
+        NativeFunction *Compiler::compile(Function *fn, Context *scope)
+        {
+            Assembler a;
+            Group group;
+            group.scope = scope;
+            group.add(fn);
+
+            try
+            {
+                // units are appended as calls to new functions are found.
+                for (std::size_t i = 0; i < group.units.size(); i++)
+                    Generator(a, &state, group, group.units[i]).generate();
+            }
+            catch (const Unsupported &e)
+            {
+                e.fn->rejectNative();
+                fn->rejectNative();
+                return nullptr;
+            }
+
+            std::set<std::string> locals;
+            std::set<std::string> callees;
+            for (auto &&unit : group.units)
+            {
+                locals.insert(unit.locals.begin(), unit.locals.end());
+                callees.insert(unit.callees.begin(), unit.callees.end());
+            }
+            for (auto &&external : group.externals)
+            {
+                locals.insert(external->locals.begin(), external->locals.end());
+                callees.insert(external->callees.begin(), external->callees.end());
+                for (auto &&dep : external->dependencies)
+                    group.dependencies.insert(dep);
+            }
+
+            // scopes are dynamic, so a local named like a called function would shadow it.
+            for (auto &&local : locals)
+            {
+                if (callees.find(local) != callees.end())
+                {
+                    fn->rejectNative();
+                    return nullptr;
+                }
+            }
+
+            auto &code = a.getCode();
+            std::size_t page = (std::size_t)sysconf(_SC_PAGESIZE);
+            std::size_t size = (code.size() + page - 1) / page * page;
+            void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory == MAP_FAILED)
+            {
+                fn->rejectNative();
+                return nullptr;
+            }
+            std::memcpy(memory, code.data(), code.size());
+            if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0)
+            {
+                munmap(memory, size);
+                fn->rejectNative();
+                return nullptr;
+            }
+            pages.push_back(std::make_pair(memory, size));
+
+            std::vector<std::pair<std::string, unsigned long>> dependencies(group.dependencies.begin(), group.dependencies.end());
+            for (auto &&unit : group.units)
+            {
+                functions.emplace_back();
+                auto &native = functions.back();
+                native.entry = static_cast<uint8_t *>(memory) + unit.entry.position;
+                native.arity = unit.fn->getParams().size();
+                native.dependencies = dependencies;
+                native.locals = locals;
+                native.callees = callees;
+                unit.fn->setNative(&native);
+            }
+
+            return fn->getNative();
+        }
+
+        bool Compiler::canEnter(NativeFunction *fn, Context *scope)
+        {
+            for (auto &&dep : fn->dependencies)
+            {
+                auto current = scope->get(dep.first);
+                auto fn = cast<Function>(current);
+                if (fn == nullptr || fn->getId() != dep.second)
+                    return false;
+            }
+            return true;
+        }
+
+        bool Compiler::invoke(NativeFunction *fn, const double *args, double &result)
+        {
+            std::jmp_buf jump;
+            std::jmp_buf *previous = state.jump;
+            state.jump = &jump;
+            state.stackLimit = stackLow() + STACK_HEADROOM;
+
+            if (setjmp(jump) != 0)
+            {
+                state.jump = previous;
+                return false;
+            }
+
+            void *entry = fn->entry;
+            switch (fn->arity)
+            {
+            case 0:
+                result = reinterpret_cast<double (*)()>(entry)();
+                break;
+            case 1:
+                result = reinterpret_cast<double (*)(double)>(entry)(args[0]);
+                break;
+            case 2:
+                result = reinterpret_cast<double (*)(double, double)>(entry)(args[0], args[1]);
+                break;
+            case 3:
+                result = reinterpret_cast<double (*)(double, double, double)>(entry)(args[0], args[1], args[2]);
+                break;
+            case 4:
+                result = reinterpret_cast<double (*)(double, double, double, double)>(entry)(args[0], args[1], args[2], args[3]);
+                break;
+            case 5:
+                result = reinterpret_cast<double (*)(double, double, double, double, double)>(entry)(args[0], args[1], args[2], args[3], args[4]);
+                break;
+            case 6:
+                result = reinterpret_cast<double (*)(double, double, double, double, double, double)>(entry)(args[0], args[1], args[2], args[3], args[4], args[5]);
+                break;
+            case 7:
+                result = reinterpret_cast<double (*)(double, double, double, double, double, double, double)>(entry)(args[0], args[1], args[2], args[3], args[4], args[5], args[6]);
+                break;
+            default:
+                result = reinterpret_cast<double (*)(double, double, double, double, double, double, double, double)>(entry)(args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7]);
+                break;
+            }
+
+            state.jump = previous;
+            return true;
+        }
+#else
+        bool Compiler::isSupported()
+        {
+            return false;
+        }
+
+        Compiler::~Compiler() {}
+
+        NativeFunction *Compiler::compile(Function *fn, Context *scope)
+        {
+            (void)scope;
+            fn->rejectNative();
+            return nullptr;
+        }
+
+        bool Compiler::canEnter(NativeFunction *fn, Context *scope)
+        {
+            (void)fn;
+            (void)scope;
+            return false;
+        }
+
+        bool Compiler::invoke(NativeFunction *fn, const double *args, double &result)
+        {
+            (void)fn;
+            (void)args;
+            (void)result;
+            return false;
+        }
+#endif
+    } // namespace native
+} // namespace jit
@@ -1,34 +1,46 @@
 #include <vip/jit/runtime.hpp>
 #include <stdexcept>
+#include <cstdint>
+#include <cmath>
 #include <vip/jit/components/InternalFunction.hpp>
 
 #include <vip/jit/components/Function.hpp>
 #include <vip/jit/components/String.hpp>
-#include <vip/jit/components/Number.hpp>
+#include <vip/jit/components/Record.hpp>
+#include <vip/jit/components/Shape.hpp>
+#include <vip/jit/components/Array.hpp>
 #include <vip/ast/BinaryExpression.hpp>
-#include <vip/jit/components/Null.hpp>
 #include <vip/ast/ReturnStatement.hpp>
 #include <vip/ast/WhileExpression.hpp>
 #include <vip/ast/CallExpression.hpp>
 #include <vip/ast/NumericLiteral.hpp>
 #include <vip/ast/StringLiteral.hpp>
+#include <vip/ast/ArrayLiteral.hpp>
 #include <vip/ast/Consts.hpp>
 #include <vip/jit/Consts.hpp>
+#include <vip/jit/Operators.hpp>
+#include <vip/jit/Intrinsics.hpp>
 
 namespace jit
 {
-    Runtime::Runtime()
+    namespace
+    {
+        /// @brief integers up to this size convert to a double and back without loss.
+        const int64_t MAX_EXACT = 1ll << 53;
+    }
+
+    Runtime::Runtime() : frame(nullptr), nativeThreshold(consts::NATIVE_CALL_THRESHOLD)
     {
         ctx = new Context("<root>", nullptr);
-        ctx->set("false", std::shared_ptr<Number>(new Number(false)));
-        ctx->set("true", std::shared_ptr<Number>(new Number(true)));
+        ctx->set("false", Value::boolean(false));
+        ctx->set("true", Value::boolean(true));
     }
     Runtime::~Runtime()
     {
         delete ctx;
     }
 
-    void Runtime::declare(std::string key, std::shared_ptr<Object> value)
+    void Runtime::declare(std::string key, Value value)
     {
         ctx->set(key, std::move(value));
     }
@@ -36,94 +48,141 @@ namespace jit
     {
         ctx->remove(key);
     }
-    std::shared_ptr<Object> Runtime::execute(ast::Program &program, bool returnLast)
+    Value Runtime::execute(ast::Program &program, bool returnLast)
     {
+        Memory::Use charge(memory);
+        Heap::Use use(heap);
         auto statements = program.getStatements();
 
         auto result = visitStatements(statements, ctx, returnLast);
         return result.first;
     }
 
-    std::pair<std::shared_ptr<Object>, bool> Runtime::visitStatement(ast::Node *statement, Context *context)
+    Snapshot Runtime::snapshot()
     {
-        switch (statement->getKind())
+        std::vector<std::pair<std::string, Value>> roots;
+        ctx->forEach([&](const std::string &name, const Value &value)
+                     { roots.emplace_back(name, value); });
+        for (std::size_t i = 0; i < contexts.size(); i++)
         {
-        case ast::consts::VARIABLE_STATEMENT:
-        { // Variale Statement
-            if (auto *v = dynamic_cast<ast::VariableStatement *>(statement); v != nullptr)
-            {
-                visitVariableStatement(v, context);
-                break;
-            }
-            throw std::runtime_error("Expected a variable statement.");
+            auto context = contexts.at(i);
+            auto scope = context->getName();
+            context->forEach([&](const std::string &name, const Value &value)
+                             { roots.emplace_back(scope + " " + name, value); });
         }
-        case ast::consts::IF_STATEMENT:
-        { // if statement
-            if (auto *v = dynamic_cast<ast::IfStatement *>(statement); v != nullptr)
+        strings.forEach([&](const Value &value)
+                        { roots.emplace_back("<literal>", value); });
+        return Snapshot::take(roots, &heap);
+    }
+
+    const std::array<Runtime::StatementVisitor, ast::consts::NODE_KIND_COUNT> Runtime::statementVisitors = []
+    {
+        std::array<StatementVisitor, ast::consts::NODE_KIND_COUNT> table{};
+        table.fill(&Runtime::visitIllegalStatement);
+        table[ast::consts::VARIABLE_STATEMENT] = &Runtime::visitVariableStatement;
+        table[ast::consts::IF_STATEMENT] = &Runtime::visitIfStatement;
+        table[ast::consts::MATCH_STATEMENT] = &Runtime::visitMatchStatement;
+        table[ast::consts::FUNCTION_EXPRESSION] = &Runtime::visitFunctionDeclartion;
+        table[ast::consts::EXPRESSION_STATEMENT] = &Runtime::visitExpressionStatement;
+        table[ast::consts::RETURN_STATEMENT] = &Runtime::visitReturnStatement;
+        table[ast::consts::WHILE_EXRESSION] = &Runtime::visitWhileExpression;
+        table[ast::consts::FOR_STATEMENT] = &Runtime::visitForStatement;
+        table[ast::consts::STRUCT_DECLARATION] = &Runtime::visitStructDeclaration;
+        return table;
+    }();
+
+    const std::array<Runtime::ExpressionVisitor, ast::consts::NODE_KIND_COUNT> Runtime::expressionVisitors = []
+    {
+        std::array<ExpressionVisitor, ast::consts::NODE_KIND_COUNT> table{};
+        table.fill(&Runtime::visitUnknownExpression);
+        table[ast::consts::BINARY_EXPRESSION] = &Runtime::visitBinaryExpression;
+        table[ast::consts::CALL_EXPRESSION] = &Runtime::visitCallExpression;
+        table[ast::consts::NUMBERIC_LITERAL] = &Runtime::visitNumericLiteral;
+        table[ast::consts::STRING_LITERAL] = &Runtime::visitStringLiteral;
+        table[ast::consts::IDENTIFIER] = &Runtime::visitIdentifier;
+        table[ast::consts::MEMBER_EXPRESSION] = &Runtime::visitMemberExpression;
+        table[ast::consts::INDEX_EXPRESSION] = &Runtime::visitIndexExpression;
+        table[ast::consts::ARRAY_LITERAL] = &Runtime::visitArrayLiteral;
+        return table;
+    }();
+
+    std::pair<Value, bool> Runtime::visitStatement(ast::Node *statement, Context *context)
+    {
+        auto kind = statement->getKind();
+        if (kind >= ast::consts::NODE_KIND_COUNT)
+            return visitIllegalStatement(statement, context);
+
+        return (this->*statementVisitors[kind])(statement, context);
+    }
+
+    std::pair<Value, bool> Runtime::visitExpressionStatement(ast::Node *value, Context *context)
+    {
+        auto statement = static_cast<ast::ExpressionStatement *>(value);
+        return std::make_pair(visitExpression(statement->getExpression(), context), false);
+    }
+
+    std::pair<Value, bool> Runtime::visitReturnStatement(ast::Node *value, Context *context)
+    {
+        auto statement = static_cast<ast::ReturnStatement *>(value);
+        auto expr = statement->getExpression();
+
+        // the frame of the function ends with this return, so a call to another function can replace it.
+        if (context->canReturn() && expr->getKind() == ast::consts::CALL_EXPRESSION)
+        {
+            auto call = static_cast<ast::CallExpression *>(expr);
+            if (auto name = ast::cast<ast::Identifier>(call->getExpression()); name != nullptr)
             {
-                return visitIfStatement(v, context);
+                auto fn = resolve(name, context);
+                if (auto target = cast<Function>(fn); target != nullptr)
+                {
+                    tailCall.args = visitArguments(call, target->getParams().size(), context);
+                    tailCall.fn = std::move(fn);
+
+                    // the scopes between here and the function frame are given back on the way out, keep what they bound.
+                    std::vector<Context *> scopes;
+                    for (auto scope = context; scope != frame; scope = scope->getParentContext())
+                        scopes.push_back(scope);
+                    for (auto it = scopes.rbegin(); it != scopes.rend(); it++)
+                        frame->absorb(**it);
+
+                    return std::make_pair(Value(), true);
+                }
             }
-            throw std::runtime_error("Expected a if statement.");
         }
-        case ast::consts::FUNCTION_EXPRESSION:
-        { // Function declartion
-            if (auto *v = dynamic_cast<ast::FunctionDeclartion *>(statement); v != nullptr)
+
+        return std::make_pair(visitExpression(expr, context), true);
+    }
+
+    std::pair<Value, bool> Runtime::visitWhileExpression(ast::Node *value, Context *context)
+    {
+        auto w = static_cast<ast::WhileExpression *>(value);
+        while (true)
+        {
+            if (!visitExpression(w->getExpression(), context).truthy())
             {
-                visitFunctionDeclartion(v, context);
                 break;
             }
-            throw std::runtime_error("Expected a function declartion statement.");
+            Scope scope(contexts, "<while>", context, context->canReturn());
+            auto result = visitStatements(w->getBody()->getStatements(), scope.get());
+            if (result.second)
+                return result;
         }
-        case ast::consts::EXPRESSION_STATEMENT:
-        { // expression
-            if (auto *v = dynamic_cast<ast::ExpressionStatement *>(statement); v != nullptr)
-            {
-                return std::make_pair(visitExpression(v->getExpression(), context), false);
-            }
-            throw std::runtime_error("Expected a expression statement statement.");
-        }
-        case ast::consts::RETURN_STATEMENT:
-        { // return statement
-            if (auto *v = dynamic_cast<ast::ReturnStatement *>(statement); v != nullptr)
-            {
-                return std::make_pair(visitExpression(v->getExpression(), context), true);
-            }
-            throw std::runtime_error("Uncaught SyntaxError: Illegal statement");
-        }
-        case ast::consts::WHILE_EXRESSION:
-        {
-            if (auto *w = dynamic_cast<ast::WhileExpression *>(statement); w != nullptr)
-            {
-                while (true)
-                {
-                    auto while_ctx = new Context("<while>", context, context->canReturn());
-                    auto expr = visitExpression(w->getExpression(), context);
-                    if (auto r = std::dynamic_pointer_cast<Number>(expr); r == nullptr || (r != nullptr && !r->asBool()))
-                    {
-                        break;
-                    }
-                    auto result = visitStatements(w->getBody()->getStatements(), while_ctx);
-                    if (result.second)
-                        return result;
-                }
 
-                return std::make_pair(std::shared_ptr<Null>(new Null()), false);
-            }
-            throw std::runtime_error("Uncaught SyntaxError: Illegal statement");
-        }
-        default:
-            throw std::runtime_error("Uncaught SyntaxError: Illegal statement");
-        }
+        return std::make_pair(Value::null(), false);
+    }
 
-        return std::make_pair(std::shared_ptr<Null>(new Null()), false);
+    std::pair<Value, bool> Runtime::visitIllegalStatement(ast::Node *, Context *)
+    {
+        throw std::runtime_error("Uncaught SyntaxError: Illegal statement");
     }
-    std::pair<std::shared_ptr<Object>, bool> Runtime::visitStatements(std::vector<ast::Node *> &statements, Context *context, bool returnLast)
+
+    std::pair<Value, bool> Runtime::visitStatements(std::vector<ast::Node *> &statements, Context *context, bool returnLast)
     {
         int last = statements.size() - 1;
         int idx = 0;
         for (auto &&i : statements)
         {
-
+            heap.safepoint();
             auto result = visitStatement(i, context);
             if (result.second || (returnLast && (idx == last)))
             {
@@ -136,258 +195,358 @@ namespace jit
             idx++;
         }
 
-        return std::make_pair(std::shared_ptr<Null>(new Null()), false);
+        return std::make_pair(Value::null(), false);
+    }
+
+    Value Runtime::visitExpression(ast::Node *value, Context *context)
+    {
+        auto kind = value->getKind();
+        if (kind >= ast::consts::NODE_KIND_COUNT)
+            return visitUnknownExpression(value, context);
+
+        return (this->*expressionVisitors[kind])(value, context);
     }
-    std::shared_ptr<Object> Runtime::visitExpression(ast::Node *value, Context *context)
+
+    Value Runtime::visitBinaryExpression(ast::Node *value, Context *context)
     {
-        if (auto bin = dynamic_cast<ast::BinaryExpression *>(value); bin != nullptr)
+        auto bin = static_cast<ast::BinaryExpression *>(value);
+        if (auto member = ast::cast<ast::MemberExpression>(bin->getLhs()); member != nullptr && (bin->getOp() == ast::consts::EQUAL || operators::compound(bin->getOp()) != 0))
         {
-            if (bin->getOp() == ast::consts::EQUAL)
-            {
-                auto ident = dynamic_cast<ast::Identifier *>(bin->getLhs());
-                if (ident == nullptr)
-                    throw std::runtime_error("Can not assign to value.");
+            // the record is held until the field is written, whatever the rhs does to the variable.
+            Value object = visitExpression(member->getObject(), context);
+            Value rhs = visitExpression(bin->getRhs(), context);
+            if (rhs.isEmpty())
+                throw std::runtime_error("No value on rhs.");
+
+            auto &cache = member->getCache();
+            auto op = bin->getOp() == ast::consts::EQUAL ? operators::OP_UNKNOWN : operators::index(operators::compound(bin->getOp()));
+            return Record::write(object, member->getField(), cache.shape, cache.slot, op, rhs);
+        }
+        if (auto element = ast::cast<ast::IndexExpression>(bin->getLhs()); element != nullptr && (bin->getOp() == ast::consts::EQUAL || operators::compound(bin->getOp()) != 0))
+            return visitIndexAssignment(element, bin, context);
 
-                std::shared_ptr<Object> rhs = visitExpression(bin->getRhs(), context);
-                if (rhs == nullptr)
-                    throw std::runtime_error("No value on rhs.");
+        if (bin->getOp() == ast::consts::EQUAL)
+        {
+            auto ident = ast::cast<ast::Identifier>(bin->getLhs());
+            if (ident == nullptr)
+                throw std::runtime_error("Can not assign to value.");
 
-                return context->update(ident->getValue(), rhs);
-            }
+            Value rhs = visitExpression(bin->getRhs(), context);
+            if (rhs.isEmpty())
+                throw std::runtime_error("No value on rhs.");
+
+            return context->update(ident->getValue(), rhs);
+        }
 
-            std::shared_ptr<Object> lhs = visitExpression(bin->getLhs(), context);
-            std::shared_ptr<Object> rhs = visitExpression(bin->getRhs(), context);
+        if (auto base = operators::compound(bin->getOp()); base != 0)
+        {
+            auto ident = ast::cast<ast::Identifier>(bin->getLhs());
+            if (ident == nullptr)
+                throw std::runtime_error("Can not assign to value.");
+
+            Value rhs = visitExpression(bin->getRhs(), context);
+            if (rhs.isEmpty())
+                throw std::runtime_error("No value on rhs.");
+
+            // looked up after the rhs ran, so the rhs can not leave a stale slot behind.
+            bool global;
+            auto slot = context->lookup(ident->getValue(), global);
+            if (slot == nullptr || slot->isEmpty())
+                throw std::runtime_error("No variable exsists");
 
-            if (lhs == nullptr || rhs == nullptr)
-            {
-                throw std::runtime_error("Unable to operate on given types.");
-            }
+            return operators::assign(operators::index(base), *slot, rhs);
+        }
 
-            if (lhs->getKind() != rhs->getKind())
+        auto op = operators::index(bin->getOp());
+        Value lhs = visitExpression(bin->getLhs(), context);
+        if (operators::isLogical(bin->getOp()))
+        {
+            if (auto result = operators::shortCircuit(op, lhs); !result.isEmpty())
+                return result;
+        }
+
+        Value rhs = visitExpression(bin->getRhs(), context);
+        return operators::apply(op, lhs, rhs);
+    }
+
+    Value Runtime::visitCallExpression(ast::Node *value, Context *context)
+    {
+        auto call = static_cast<ast::CallExpression *>(value);
+        auto name = ast::cast<ast::Identifier>(call->getExpression());
+        if (name == nullptr)
+            throw std::runtime_error("Failed to execute function");
+
+        // while no binding has the name of an intrinsic, it is evaluated here without calling the builtin.
+        if (call->getIntrinsic() != ast::consts::INTRINSIC_NONE && call->getArguments().size() <= consts::HOST_INLINE_ARGUMENTS && unbound(call, name, context))
+        {
+            auto &args = call->getArguments();
+            Value values[consts::HOST_INLINE_ARGUMENTS];
+            for (std::size_t i = 0; i < args.size(); i++)
+                values[i] = visitExpression(args[i], context);
+
+            Value result;
+            if (intrinsics::apply(call->getIntrinsic(), values, args.size(), result))
+                return result;
+            return cast<InternalFunction>(*builtins.find(name->getValue()))->call(values, args.size());
+        }
+
+        auto fn = resolve(name, context);
+        if (fn.isEmpty())
+            throw std::runtime_error("No function with give name exists.");
+
+        switch (fn.getKind())
+        {
+        case consts::ID_FUNCTION:
+        {
+            auto values = visitArguments(call, cast<Function>(fn)->getParams().size(), context);
+            return invoke(std::move(fn), values, context);
+        }
+        case consts::ID_INTERNAL_FUNCTION:
+        {
+            auto &args = call->getArguments();
+            if (args.size() <= consts::HOST_INLINE_ARGUMENTS)
             {
-                throw std::runtime_error("Can not operate on two different types.");
+                Value values[consts::HOST_INLINE_ARGUMENTS];
+                for (std::size_t i = 0; i < args.size(); i++)
+                    values[i] = visitExpression(args[i], context);
+                return cast<InternalFunction>(fn)->call(values, args.size());
             }
 
-            switch (bin->getOp())
-            {
-            case ast::consts::AND:
-            {
-                if (auto ln = std::dynamic_pointer_cast<Number>(lhs); ln != nullptr)
-                {
-                    auto rn = std::dynamic_pointer_cast<Number>(rhs);
-                    if (rn == nullptr)
-                        throw std::runtime_error("rhs does is not a number");
+            std::vector<Value> values;
+            values.reserve(args.size());
+            for (auto &&arg : args)
+                values.push_back(visitExpression(arg, context));
+            return cast<InternalFunction>(fn)->call(values.data(), values.size());
+        }
+        case consts::ID_SHAPE:
+        {
+            std::vector<Value> args;
+            args.reserve(call->getArguments().size());
+            for (auto &&i : call->getArguments())
+                args.push_back(visitExpression(i, context));
 
-                    return std::shared_ptr<Number>(new Number(ln->asBool() && rn->asBool()));
-                }
-                throw std::runtime_error("Invalid operation.");
-            }
-            case ast::consts::OR:
-            {
-                if (auto ln = std::dynamic_pointer_cast<Number>(lhs); ln != nullptr)
-                {
-                    auto rn = std::dynamic_pointer_cast<Number>(rhs);
-                    if (rn == nullptr)
-                        throw std::runtime_error("rhs does is not a number");
+            return Record::make(fn, args.data(), args.size());
+        }
+        default:
+            throw std::runtime_error("Failed to execute function");
+        }
+    }
 
-                    return std::shared_ptr<Number>(new Number(ln->asBool() || rn->asBool()));
-                }
-                throw std::runtime_error("Invalid operation.");
-            }
-            case ast::consts::GREATER_THEN:
-            {
-                if (auto ln = std::dynamic_pointer_cast<Number>(lhs); ln != nullptr)
-                {
-                    auto rn = std::dynamic_pointer_cast<Number>(rhs);
-                    if (rn == nullptr)
-                        throw std::runtime_error("rhs does is not a number");
+    std::vector<Value> Runtime::visitArguments(ast::CallExpression *call, std::size_t arity, Context *context)
+    {
+        auto &args = call->getArguments();
+        if (args.size() != arity)
+        {
+            throw std::runtime_error("Given params does not function sig.");
+        }
 
-                    return std::shared_ptr<Number>(new Number(*ln > *rn));
-                }
-                throw std::runtime_error("Invalid operation.");
-            }
-            case ast::consts::GREATER_THEN_OR_EQUAL:
-            {
-                if (auto ln = std::dynamic_pointer_cast<Number>(lhs); ln != nullptr)
-                {
-                    auto rn = std::dynamic_pointer_cast<Number>(rhs);
-                    if (rn == nullptr)
-                        throw std::runtime_error("rhs does is not a number");
+        std::vector<Value> values;
+        values.reserve(args.size());
+        for (auto &&arg : args)
+        {
+            values.push_back(visitExpression(arg, context));
+        }
+        return values;
+    }
 
-                    return std::shared_ptr<Number>(new Number(*ln >= *rn));
-                }
-                throw std::runtime_error("Invalid operation.");
-            }
-            case ast::consts::LESS_THEN_OR_EQUAL:
-            {
-                if (auto ln = std::dynamic_pointer_cast<Number>(lhs); ln != nullptr)
-                {
-                    auto rn = std::dynamic_pointer_cast<Number>(rhs);
-                    if (rn == nullptr)
-                        throw std::runtime_error("rhs does is not a number");
+    Value Runtime::invoke(Value fn, std::vector<Value> &values, Context *context)
+    {
+        // bindings of the frames tail calls replaced, the next callee sees them like it would see its caller's.
+        Context replaced("<tail>", context);
+        Context *parent = context;
+        Context *outer = frame;
 
-                    return std::shared_ptr<Number>(new Number(*ln <= *rn));
-                }
-                throw std::runtime_error("Invalid operation.");
-            }
-            case ast::consts::LESS_THEN:
-            {
-                if (auto ln = std::dynamic_pointer_cast<Number>(lhs); ln != nullptr)
-                {
-                    auto rn = std::dynamic_pointer_cast<Number>(rhs);
-                    if (rn == nullptr)
-                        throw std::runtime_error("rhs does is not a number");
+        while (true)
+        {
+            auto &function = *cast<Function>(fn);
+            if (Value result; visitNative(function, values, parent, result))
+                return result;
 
-                    return std::shared_ptr<Number>(new Number(*ln < *rn));
-                }
-                throw std::runtime_error("Invalid operation.");
-            }
-            case ast::consts::MINUS:
-            {
-                if (auto ln = std::dynamic_pointer_cast<Number>(lhs); ln != nullptr)
-                {
-                    auto rn = std::dynamic_pointer_cast<Number>(rhs);
-                    if (rn == nullptr)
-                        throw std::runtime_error("rhs does is not a number");
+            Scope scope(contexts, "<function>", parent, true, &function.getName());
+            auto fn_ctx = scope.get();
+            auto &params = function.getParams();
 
-                    return std::shared_ptr<Number>(new Number(*ln - *rn));
-                }
-                throw std::runtime_error("Invalid operation.");
-            }
-            case ast::consts::DIV:
+            // set arguments.
+            for (std::size_t i = 0; i < values.size(); i++)
             {
-                if (auto ln = std::dynamic_pointer_cast<Number>(lhs); ln != nullptr)
-                {
-                    auto rn = std::dynamic_pointer_cast<Number>(rhs);
-                    if (rn == nullptr)
-                        throw std::runtime_error("rhs does is not a number");
+                auto param = params.at(i);
+                auto &var = values.at(i);
 
-                    return std::shared_ptr<Number>(new Number(*ln / *rn));
-                }
-                throw std::runtime_error("Invalid operation.");
-            }
-            case ast::consts::MULT:
-            {
-                if (auto ln = std::dynamic_pointer_cast<Number>(lhs); ln != nullptr)
-                {
-                    auto rn = std::dynamic_pointer_cast<Number>(rhs);
-                    if (rn == nullptr)
-                        throw std::runtime_error("rhs does is not a number");
+                auto typedata = ast::cast<ast::Identifier>(param->getType());
+                if (typedata == nullptr)
+                    throw std::runtime_error("Unable to detrmine type");
 
-                    return std::shared_ptr<Number>(new Number(*ln * *rn));
-                }
-                throw std::runtime_error("Invalid operation.");
+                // a param typed with the name of a struct takes the records of that struct.
+                if (!Shape::isOfType(var, typedata->getValue()))
+                    throw std::runtime_error("Invalid type");
+
+                fn_ctx->set(param->getName()->getValue(), var);
             }
-            case ast::consts::PLUS:
-            {
-                if (auto ln = std::dynamic_pointer_cast<Number>(lhs); ln != nullptr)
-                {
-                    auto rn = std::dynamic_pointer_cast<Number>(rhs);
-                    if (rn == nullptr)
-                        throw std::runtime_error("rhs does is not a number");
 
-                    return std::shared_ptr<Number>(new Number(*ln + *rn));
-                }
-                else if (auto ln = std::dynamic_pointer_cast<String>(lhs); ln != nullptr)
-                {
-                    auto rn = std::dynamic_pointer_cast<String>(rhs);
-                    if (rn == nullptr)
-                        throw std::runtime_error("rhs does is not a string");
+            frame = fn_ctx;
+            auto result = visitStatements(function.getBody()->getStatements(), fn_ctx);
+            frame = outer;
 
-                    return std::shared_ptr<String>(new String(*ln + *rn));
-                }
+            if (tailCall.fn.isEmpty())
+                return result.first;
 
-                throw std::runtime_error("Invalid operation.");
-            }
-            default:
-                throw std::runtime_error("Unknown operation");
-            }
+            replaced.absorb(*fn_ctx);
+            parent = &replaced;
+            fn = std::move(tailCall.fn);
+            values = std::move(tailCall.args);
+            tailCall.fn = Value();
         }
-        else if (auto call = dynamic_cast<ast::CallExpression *>(value); call != nullptr)
-        {
-            auto name = dynamic_cast<ast::Identifier *>(call->getExpression());
+    }
 
-            auto fn = context->get(name->getValue());
-            if (fn == nullptr)
-                throw std::runtime_error("No function with give name exists.");
+    Value Runtime::visitNumericLiteral(ast::Node *value, Context *)
+    {
+        auto literal = static_cast<ast::NumericLiteral *>(value);
+        if (literal->isInteger())
+            return Value::integer(literal->getInteger());
+        return Value(literal->getValue());
+    }
 
-            if (auto fnc = std::dynamic_pointer_cast<Function>(fn); fnc != nullptr)
-            {
-                auto fn_ctx = new Context("<function " + name->getValue() + ">", context, true);
+    Value Runtime::visitStringLiteral(ast::Node *value, Context *)
+    {
+        return strings.intern(static_cast<ast::StringLiteral *>(value)->getValue());
+    }
 
-                auto args = call->getArguments();
-                auto params = fnc->getParams();
+    Value Runtime::visitIdentifier(ast::Node *value, Context *context)
+    {
+        auto r = resolve(static_cast<ast::Identifier *>(value), context);
 
-                if (args.size() != params.size())
-                {
-                    throw std::runtime_error("Given params does not function sig.");
-                }
-                // set arguments.
-                for (std::size_t i = 0; i < args.size(); i++)
-                {
-                    auto param = params.at(i);
-                    auto arg = args.at(i);
-
-                    auto var = visitExpression(arg, context);
-
-                    auto typedata = dynamic_cast<ast::Identifier *>(param->getType());
-                    if (typedata == nullptr)
-                        throw std::runtime_error("Unable to detrmine type");
-
-                    if (typedata->getValue() == "string" && var->getKind() == consts::ID_STRING)
-                    {
-                        fn_ctx->set(param->getName()->getValue(), var);
-                    }
-                    else if (typedata->getValue() == "number" && var->getKind() == consts::ID_NUMBER)
-                    {
-                        fn_ctx->set(param->getName()->getValue(), var);
-                    }
-                    else
-                    {
-                        throw std::runtime_error("Invalid type");
-                    }
-                }
+        if (r.isEmpty())
+            throw std::runtime_error("No variable exsists");
 
-                // set params
-                auto result = visitStatements(fnc->getBody()->getStatements(), fn_ctx);
+        return r;
+    }
 
-                return result.first;
-            }
-            else if (auto ifn = std::dynamic_pointer_cast<InternalFunction>(fn); ifn != nullptr)
-            {
-                std::vector<std::shared_ptr<Object>> args;
+    Value Runtime::visitMemberExpression(ast::Node *value, Context *context)
+    {
+        auto member = static_cast<ast::MemberExpression *>(value);
+        auto object = visitExpression(member->getObject(), context);
 
-                for (auto &&i : call->getArguments())
-                {
-                    args.push_back(visitExpression(i, context));
-                }
+        auto &cache = member->getCache();
+        return Record::at(object, member->getField(), cache.shape, cache.slot);
+    }
 
-                return ifn->execute(args);
-            }
+    Value Runtime::visitIndexExpression(ast::Node *value, Context *context)
+    {
+        auto element = static_cast<ast::IndexExpression *>(value);
+        auto object = visitExpression(element->getObject(), context);
+        auto index = visitExpression(element->getIndex(), context);
+        return operators::element(object, index);
+    }
 
-            throw std::runtime_error("Failed to execute function");
-        }
-        else if (auto num = dynamic_cast<ast::NumericLiteral *>(value); num != nullptr)
+    Value Runtime::visitIndexAssignment(ast::IndexExpression *target, ast::BinaryExpression *bin, Context *context)
+    {
+        // the array or map is held until the element is written, whatever the rhs does to the variable.
+        Value object = visitExpression(target->getObject(), context);
+        Value index = visitExpression(target->getIndex(), context);
+        Value rhs = visitExpression(bin->getRhs(), context);
+        if (rhs.isEmpty())
+            throw std::runtime_error("No value on rhs.");
+
+        auto op = bin->getOp() == ast::consts::EQUAL ? operators::OP_UNKNOWN : operators::index(operators::compound(bin->getOp()));
+        return operators::setElement(object, index, op, rhs);
+    }
+
+    Value Runtime::visitArrayLiteral(ast::Node *value, Context *context)
+    {
+        auto &elements = static_cast<ast::ArrayLiteral *>(value)->getElements();
+        Value array(new Array(elements.size()));
+        auto data = static_cast<Array *>(array.getObject())->getData();
+        for (std::size_t i = 0; i < elements.size(); i++)
         {
-            return std::shared_ptr<Number>(new Number(num->getValue()));
+            auto element = visitExpression(elements[i], context);
+            if (element.isEmpty() || element.getKind() != consts::ID_NUMBER)
+                throw std::runtime_error("Invalid type");
+            data[i] = element.asNumber();
         }
-        else if (auto str = dynamic_cast<ast::StringLiteral *>(value); str != nullptr)
+        return array;
+    }
+
+    Value Runtime::visitUnknownExpression(ast::Node *, Context *)
+    {
+        throw std::runtime_error("Unknown expression.");
+    }
+
+    Value Runtime::resolve(ast::Identifier *name, Context *context)
+    {
+        auto &binding = name->getBinding();
+        if (binding.version == context->getVersion())
+            return *binding.slot;
+
+        bool global = false;
+        auto slot = context->lookup(name->getValue(), global);
+        if (slot == nullptr)
         {
-            return std::shared_ptr<String>(new String(str->getValue()));
+            // not cached, so a variable declared later with the same name takes over.
+            auto builtin = builtins.find(name->getValue());
+            return builtin != nullptr ? *builtin : Value();
         }
-        else if (auto idnt = dynamic_cast<ast::Identifier *>(value); idnt != nullptr)
+
+        // locals come and go with their context, only root slots are stable enough to keep.
+        if (global)
         {
-            auto r = context->get(idnt->getValue());
+            binding.version = context->getVersion();
+            binding.slot = slot;
+        }
+        return *slot;
+    }
 
-            if (r == nullptr)
-                throw std::runtime_error("No variable exsists");
+    bool Runtime::unbound(ast::CallExpression *call, ast::Identifier *name, Context *context)
+    {
+        auto &unboundAt = call->getUnboundAt();
+        if (unboundAt == context->getVersion())
+            return true;
+
+        // a name the program never declares can only be bound at the root, which changes the version.
+        bool global = false;
+        if (context->lookup(name->getValue(), global) != nullptr)
+            return false;
+        unboundAt = context->getVersion();
+        return true;
+    }
+
+    bool Runtime::visitNative(Function &fn, std::vector<Value> &args, Context *context, Value &result)
+    {
+        if (nativeThreshold == 0 || fn.isNativeRejected() || !native::Compiler::isSupported())
+            return false;
+
+        auto code = fn.getNative();
+        if (code == nullptr)
+        {
+            if (fn.hit() < nativeThreshold)
+                return false;
 
-            return r;
+            code = nativeCompiler.compile(&fn, context);
+            if (code == nullptr)
+                return false;
         }
-        else
+
+        // compiled code only takes doubles, booleans would lose their type and integers past 2^53 their value.
+        std::vector<double> values;
+        for (auto &&arg : args)
         {
-            throw std::runtime_error("Unknown expression.");
+            if (!arg.isNumber() || (arg.isInteger() && (arg.asInteger() > MAX_EXACT || arg.asInteger() < -MAX_EXACT)))
+                return false;
+            values.push_back(arg.asNumber());
         }
+
+        if (!nativeCompiler.canEnter(code, context))
+            return false;
+
+        double number;
+        if (!nativeCompiler.invoke(code, values.data(), number))
+            return false;
+
+        // whole results come back as integers, like the interpreter would have left them.
+        if (number == std::trunc(number) && number <= MAX_EXACT && number >= -MAX_EXACT && !(number == 0 && std::signbit(number)))
+            result = Value::integer((int64_t)number);
+        else
+            result = Value(number);
+        return true;
     }
 
     void Runtime::visitVariableDeclaration(ast::VariableDeclaration *value, Context *context)
@@ -401,11 +560,11 @@ namespace jit
         {
             if (type == "string")
             {
-                context->set(name, std::shared_ptr<String>());
+                context->set(name, Value());
             }
-            else if (type == "number")
+            else if (type == "number" || type == "number[]" || type == "map")
             {
-                context->set(name, std::shared_ptr<Number>());
+                context->set(name, Value());
             }
             else
             {
@@ -417,51 +576,138 @@ namespace jit
         context->set(name, visitExpression(init, context));
     }
 
-    void Runtime::visitVariableStatement(ast::VariableStatement *value, Context *context)
+    std::pair<Value, bool> Runtime::visitVariableStatement(ast::Node *statement, Context *context)
     {
-        for (auto &&i : value->getDeclarations())
+        for (auto &&i : static_cast<ast::VariableStatement *>(statement)->getDeclarations())
         {
             visitVariableDeclaration(i, context);
         }
+
+        return std::make_pair(Value::null(), false);
     }
 
-    std::pair<std::shared_ptr<Object>, bool> Runtime::visitIfStatement(ast::IfStatement *value, Context *context)
+    std::pair<Value, bool> Runtime::visitIfStatement(ast::Node *statement, Context *context)
     {
-        auto result = visitExpression(value->getExpression(), context);
-
-        if (auto exp = std::dynamic_pointer_cast<Number>(result); exp != nullptr)
+        auto value = static_cast<ast::IfStatement *>(statement);
+        if (visitExpression(value->getExpression(), context).truthy())
         {
-            if (exp->asBool())
-            {
-                auto if_ctx = new Context("<if>", context, context->canReturn());
-                return visitStatements(value->getThen()->getStatements(), if_ctx);
-            }
+            Scope scope(contexts, "<if>", context, context->canReturn());
+            return visitStatements(value->getThen()->getStatements(), scope.get());
         }
 
         auto elseBlock = value->getElse();
 
         if (elseBlock == nullptr)
         {
-            return std::make_pair(std::shared_ptr<Null>(new Null()), false);
+            return std::make_pair(Value::null(), false);
         }
 
-        if (auto block = dynamic_cast<ast::Block *>(elseBlock); block != nullptr)
+        if (auto block = ast::cast<ast::Block>(elseBlock); block != nullptr)
         {
-            auto if_ctx = new Context("<if>", context, context->canReturn());
-            return visitStatements(block->getStatements(), if_ctx);
+            Scope scope(contexts, "<if>", context, context->canReturn());
+            return visitStatements(block->getStatements(), scope.get());
         }
 
-        if (auto elseif = dynamic_cast<ast::IfStatement *>(elseBlock); elseif != nullptr)
+        if (auto elseif = ast::cast<ast::IfStatement>(elseBlock); elseif != nullptr)
         {
             return visitIfStatement(elseif, context);
         }
 
-        return std::make_pair(std::shared_ptr<Null>(new Null()), false);
+        return std::make_pair(Value::null(), false);
+    }
+
+    Value Runtime::visitRangeBound(ast::Node *value, Context *context)
+    {
+        auto bound = visitExpression(value, context);
+        if (bound.isEmpty() || bound.getKind() != consts::ID_NUMBER)
+            throw std::runtime_error("Range bounds must be numbers.");
+        return bound;
+    }
+
+    std::pair<Value, bool> Runtime::visitForStatement(ast::Node *value, Context *context)
+    {
+        auto loop = static_cast<ast::ForStatement *>(value);
+        auto from = visitRangeBound(loop->getFrom(), context);
+        auto to = visitRangeBound(loop->getTo(), context);
+        auto step = loop->getStep() != nullptr ? visitRangeBound(loop->getStep(), context) : Value::integer(1);
+        if (step.asNumber() == 0)
+            throw std::runtime_error("Step of a for loop can not be 0.");
+
+        // the counter lives in its own context, the body gets one that is emptied every iteration.
+        Scope counter(contexts, "<for>", context, context->canReturn());
+        counter.get()->set(loop->getName()->getValue(), Value());
+        bool global;
+        auto slot = counter.get()->lookup(loop->getName()->getValue(), global);
+
+        Scope body(contexts, "<for>", counter.get(), context->canReturn());
+        auto iterate = [&](Value i)
+        {
+            *slot = std::move(i);
+            auto result = visitStatements(loop->getBody()->getStatements(), body.get());
+            body.get()->clear();
+            return result;
+        };
+
+        // integer bounds give an exact integer counter, anything else counts in doubles.
+        if (from.isInteger() && to.isInteger() && step.isInteger())
+        {
+            int64_t last = to.asInteger();
+            int64_t by = step.asInteger();
+            for (int64_t i = from.asInteger(); by > 0 ? i < last : i > last; i += by)
+            {
+                if (auto result = iterate(Value::integer(i)); result.second)
+                    return result;
+                // the next counter would not fit, so it would be past the end anyway.
+                if (by > 0 ? i > INT64_MAX - by : i < INT64_MIN - by)
+                    break;
+            }
+            return std::make_pair(Value::null(), false);
+        }
+
+        double last = to.asNumber();
+        double by = step.asNumber();
+        for (double i = from.asNumber(); by > 0 ? i < last : i > last; i += by)
+        {
+            if (auto result = iterate(Value(i)); result.second)
+                return result;
+        }
+
+        return std::make_pair(Value::null(), false);
     }
 
-    void Runtime::visitFunctionDeclartion(ast::FunctionDeclartion *value, Context *context)
+    std::pair<Value, bool> Runtime::visitMatchStatement(ast::Node *statement, Context *context)
     {
-        auto fn = std::shared_ptr<Function>(new Function(value->getName(), value->getBodyBlock(), value->getParameters()));
+        auto value = static_cast<ast::MatchStatement *>(statement);
+        auto result = visitExpression(value->getExpression(), context);
+
+        int index = ast::CaseTable::NO_CASE;
+        if (!result.isEmpty() && result.getKind() == consts::ID_NUMBER)
+            index = value->getTable()->find(result.asNumber());
+        else if (auto text = cast<String>(result); text != nullptr)
+            index = value->getTable()->find(text->view(), text->hash());
+
+        ast::Block *body = index == ast::CaseTable::NO_CASE ? value->getElse() : value->getBodies()[index];
+        if (body == nullptr)
+            return std::make_pair(Value::null(), false);
+
+        Scope scope(contexts, "<match>", context, context->canReturn());
+        return visitStatements(body->getStatements(), scope.get());
+    }
+
+    std::pair<Value, bool> Runtime::visitStructDeclaration(ast::Node *statement, Context *context)
+    {
+        auto value = static_cast<ast::StructDeclaration *>(statement);
+        if (context->has(value->getName()))
+            throw std::runtime_error("A variable already exists with this name.");
+
+        context->set(value->getName(), Value(new Shape(*value)));
+        return std::make_pair(Value::null(), false);
+    }
+
+    std::pair<Value, bool> Runtime::visitFunctionDeclartion(ast::Node *statement, Context *context)
+    {
+        auto value = static_cast<ast::FunctionDeclartion *>(statement);
+        auto fn = Value(new Function(value->getName(), value->getBodyBlock(), value->getParameters()));
 
         value->setBody(nullptr);
         value->clearParams();
@@ -472,6 +718,8 @@ namespace jit
         }
 
         context->set(value->getName(), fn);
+
+        return std::make_pair(Value::null(), false);
     }
 
 } // namespace jit
@@ -5,14 +5,19 @@
 #include <ctype.h>
 #include <memory>
 #include <deque>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <utility>
 
 #include <vip/tokenizer/Token.hpp>
 #include <vip/jit/runtime.hpp>
 #include <vip/ast/Parser.hpp>
+#include "./compile/compiler.hpp"
 
 namespace vip
 {
-    static char ALLOWED_SYMBOLS[] = "{}()!;:+=,<>-*&|#";
+    static char ALLOWED_SYMBOLS[] = "{}()[]!;:+=,<>-*/&|#.%^";
 
     bool isDoubleOperator(char input, char next)
     {
@@ -48,6 +53,18 @@ namespace vip
                 return true;
             return false;
         }
+        case '*':
+        {
+            if (next == '=')
+                return true;
+            return false;
+        }
+        case '/':
+        {
+            if (next == '=')
+                return true;
+            return false;
+        }
         case '=':
         {
             if (next == '=')
@@ -56,13 +73,19 @@ namespace vip
         }
         case '>':
         {
-            if (next == '=')
+            if (next == '=' || next == '>')
                 return true;
             return false;
         }
         case '<':
         {
-            if (next == '>')
+            if (next == '=' || next == '<')
+                return true;
+            return false;
+        }
+        case '.':
+        {
+            if (next == '.')
                 return true;
             return false;
         }
@@ -99,7 +122,8 @@ namespace vip
             if (isalpha(current))
             {
                 std::string value = "";
-                while (isalpha(current) || isdigit(current) || current == '.')
+                // a '.' after a name is member access and a '..' a range, neither is part of the name.
+                while (isalpha(current) || isdigit(current))
                 {
                     value.push_back(current);
                     next(input, index, current);
@@ -132,7 +156,7 @@ namespace vip
                 bool seen_dot = false;
 
                 std::string value = "";
-                while (isdigit(current) || (current == '.' && !seen_dot))
+                while (isdigit(current) || (current == '.' && !seen_dot && input[index + 1] != '.'))
                 {
                     if (current == '.')
                     {
@@ -175,27 +199,138 @@ namespace vip
         return program;
     }
 
+    jit::Memory &JustInTime::memory()
+    {
+        if (engine == ENGINE_CLOSURE)
+            return closures.getMemory();
+        return rt.getMemory();
+    }
+
+    jit::Heap &JustInTime::heap()
+    {
+        if (engine == ENGINE_CLOSURE)
+            return closures.getHeap();
+        return rt.getHeap();
+    }
+
     std::shared_ptr<jit::Object> JustInTime::execute(std::string input)
     {
+        // the ast is charged too, it lives as long as the functions declared in it.
+        jit::Memory::Use use(memory());
         ast::Program program = tokenize(input);
-        return rt.execute(program, cliMode);
+        if (engine == ENGINE_CLOSURE)
+            return jit::box(closures.execute(program, cliMode));
+        return jit::box(rt.execute(program, cliMode));
+    }
+
+    void JustInTime::collectGarbage()
+    {
+        if (engine == ENGINE_CLOSURE)
+            closures.getHeap().collect(true);
+        else
+            rt.getHeap().collect(true);
+    }
+
+    jit::HeapStats JustInTime::getHeapStats()
+    {
+        if (engine == ENGINE_CLOSURE)
+            return closures.getHeap().getStats();
+        return rt.getHeap().getStats();
+    }
+
+    void JustInTime::setMemoryLimit(std::size_t bytes)
+    {
+        memory().setHardLimit(bytes);
+    }
+
+    void JustInTime::setSoftMemoryLimit(std::size_t bytes, std::function<void(std::size_t)> callback)
+    {
+        memory().setSoftLimit(bytes, std::move(callback));
+    }
+
+    void JustInTime::setAllocator(jit::Allocator allocator)
+    {
+        memory().setAllocator(std::move(allocator));
+    }
+
+    jit::MemoryStats JustInTime::getMemoryStats()
+    {
+        return memory().getStats();
+    }
+
+    jit::Snapshot JustInTime::snapshotHeap()
+    {
+        if (engine == ENGINE_CLOSURE)
+            return closures.snapshot();
+        return rt.snapshot();
+    }
+
+    void JustInTime::writeHeapSnapshot(std::string path)
+    {
+        std::ofstream stream(path);
+        if (!stream.is_open())
+            throw std::runtime_error("Failed to write " + path);
+        stream << snapshotHeap().toJson();
+    }
+
+    template <typename... Args>
+    void JustInTime::declare(const std::string &name, Args &&...args)
+    {
+        // allocated like execute allocates, so the function shows in the stats and counts against the limits.
+        jit::Memory::Use charge(memory());
+        jit::Heap::Use use(heap());
+        auto fn = jit::Value(new jit::InternalFunction(name, std::forward<Args>(args)...));
+
+        if (engine == ENGINE_CLOSURE)
+            closures.declare(name, fn);
+        else
+            rt.declare(name, fn);
     }
 
     void JustInTime::registerFn(std::string name, jit::CallbackFunction callback)
     {
-        auto fn = std::shared_ptr<jit::InternalFunction>(new jit::InternalFunction(name, callback));
+        declare(name, std::move(callback));
+    }
+
+    void JustInTime::registerFn(std::string name, jit::ValueFunction callback)
+    {
+        declare(name, std::move(callback));
+    }
 
-        rt.declare(name, fn);
+    void JustInTime::registerFn(std::string name, jit::Signature signature, jit::HostFunction callback)
+    {
+        declare(name, std::move(signature), std::move(callback));
     }
 
-    /*void vipCompile(std::string input)
+    void JustInTime::unregisterFn(std::string name)
+    {
+        if (engine == ENGINE_CLOSURE)
+            closures.drop(name);
+        else
+            rt.drop(name);
+    }
+
+    void AheadOfTime::build(std::string input, std::string outfile)
     {
         ast::Program program = tokenize(input);
+        std::string source = compile::astToC(program);
 
-        std::vector<std::string> files = compile::astToCil(program, "../../", "vip_build/");
-        compile::compileCil(files, std::vector<std::string>(), "../../Program.o");
+        std::filesystem::create_directories(buildDir);
+        auto dir = std::filesystem::path(buildDir);
+        std::vector<std::pair<std::filesystem::path, std::string>> files = {
+            {dir / "vip_runtime.h", compile::RUNTIME_HEADER},
+            {dir / "vip_runtime.c", compile::RUNTIME_SOURCE},
+            {dir / "program.c", source}};
 
-        // std::cout << program.toString() << std::endl;
-    }*/
+        for (auto &&file : files)
+        {
+            std::ofstream stream(file.first);
+            if (!stream.is_open())
+                throw std::runtime_error("Failed to write " + file.first.string());
+            stream << file.second;
+        }
+
+        compile::compileC({files[2].first.string(), files[1].first.string()}, {}, outfile);
+    }
 
 } // namespace vip
@@ -7,23 +7,59 @@
 #include <fstream>
 #include "./utils.hpp"
 
-std::shared_ptr<jit::Object> printLn(std::vector<std::shared_ptr<jit::Object>> args)
+jit::Value printLn(jit::Arguments args)
 {
     for (auto &&i : args)
     {
-        std::cout << *i;
+        std::cout << i;
     }
 
     std::cout << std::endl;
 
-    return nullptr;
+    return jit::Value();
+}
+
+bool readFile(const char *path, std::string &content)
+{
+    std::ifstream file(path);
+
+    if (!file.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        content += line;
+    }
+    file.close();
+
+    return true;
 }
 
 int main(int argc, char *argv[])
 {
+    if (argc >= 3 && std::string(argv[1]) == "build")
+    {
+        std::string content;
+        if (!readFile(argv[2], content))
+            return 1;
+
+        try
+        {
+            vip::AheadOfTime().build(content, argc >= 4 ? argv[3] : "a.out");
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+
+        return 0;
+    }
+
     auto jit = vip::JustInTime(argc == 1);
 
-    jit.registerFn("println", printLn);
+    jit.registerFn("println", {{}, true}, printLn);
 
     if (argc == 1)
     {
@@ -59,18 +95,9 @@ int main(int argc, char *argv[])
         return 0;
     }
 
-    std::ifstream file(argv[1]);
-
-    if (!file.is_open())
-        return 1;
-
     std::string content;
-    std::string line;
-    while (std::getline(file, line))
-    {
-        content += line;
-    }
-    file.close();
+    if (!readFile(argv[1], content))
+        return 1;
 
     try
     {
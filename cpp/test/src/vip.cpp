@@ -2,8 +2,21 @@
 #include <vip/vip.hpp>
 #include <vip/jit/Consts.hpp>
 #include <vip/jit/components/Number.hpp>
+#include <vip/jit/components/String.hpp>
+#include <vip/jit/Interner.hpp>
+#include <vip/jit/Kernels.hpp>
 
 #include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <sstream>
+#include <utility>
+#include <tuple>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <vector>
 
 TEST_CASE("Binary Operations")
 {
@@ -15,7 +28,7 @@ TEST_CASE("Binary Operations")
 
         REQUIRE(result->getKind() == jit::consts::ID_NUMBER);
 
-        auto item = std::dynamic_pointer_cast<jit::Number>(result);
+        auto item = jit::sharedCast<jit::Number>(result);
 
         REQUIRE(item != nullptr);
 
@@ -28,7 +41,7 @@ TEST_CASE("Binary Operations")
 
         REQUIRE(result->getKind() == jit::consts::ID_NUMBER);
 
-        auto item = std::dynamic_pointer_cast<jit::Number>(result);
+        auto item = jit::sharedCast<jit::Number>(result);
 
         REQUIRE(item != nullptr);
 
@@ -41,7 +54,7 @@ TEST_CASE("Binary Operations")
 
         REQUIRE(result->getKind() == jit::consts::ID_NUMBER);
 
-        auto item = std::dynamic_pointer_cast<jit::Number>(result);
+        auto item = jit::sharedCast<jit::Number>(result);
 
         REQUIRE(item != nullptr);
 
@@ -54,10 +67,1745 @@ TEST_CASE("Binary Operations")
 
         REQUIRE(result->getKind() == jit::consts::ID_NUMBER);
 
-        auto item = std::dynamic_pointer_cast<jit::Number>(result);
+        auto item = jit::sharedCast<jit::Number>(result);
 
         REQUIRE(item != nullptr);
 
-        REQUIRE(item->getValue() == 0);
+        REQUIRE(item->getValue() == 1);
+    }
+}
+
+TEST_CASE("Native functions")
+{
+    auto runtime = vip::JustInTime(true);
+
+    SUBCASE("hot recursive functions match the interpreter")
+    {
+        runtime.execute("fn fib(n: number) { if (n < 2) { return n; } return fib(n - 1) + fib(n - 2); }");
+
+        auto result = runtime.execute("fib(20);");
+
+        REQUIRE(result->getKind() == jit::consts::ID_NUMBER);
+
+        auto item = jit::sharedCast<jit::Number>(result);
+
+        REQUIRE(item != nullptr);
+
+        REQUIRE(item->getValue() == 6765);
+    }
+
+    SUBCASE("division by zero falls back to the interpreter")
+    {
+        runtime.execute("fn half(a: number, b: number) { return a / b; }");
+
+        for (int i = 0; i < 20; i++)
+        {
+            auto item = jit::sharedCast<jit::Number>(runtime.execute("half(4, 2);"));
+
+            REQUIRE(item != nullptr);
+
+            REQUIRE(item->getValue() == 2);
+        }
+
+        REQUIRE_THROWS(runtime.execute("half(1, 0);"));
+    }
+
+    SUBCASE("results past 2^53 stay exact")
+    {
+        runtime.execute("fn sq(a: number) { return a * a; } fn grow(a: number) { let b: number = a; b *= a; return b + 1; }");
+
+        for (unsigned int i = 0; i < jit::consts::NATIVE_CALL_THRESHOLD * 2; i++)
+        {
+            auto item = jit::sharedCast<jit::Number>(runtime.execute("sq(123456789) - 15241578750190520;"));
+            auto grown = jit::sharedCast<jit::Number>(runtime.execute("grow(123456789) - 15241578750190521;"));
+            auto small = jit::sharedCast<jit::Number>(runtime.execute("sq(3);"));
+
+            REQUIRE(item != nullptr);
+            REQUIRE(grown != nullptr);
+            REQUIRE(small != nullptr);
+
+            REQUIRE(item->getValue() == 1);
+            REQUIRE(grown->getValue() == 1);
+            REQUIRE(small->getValue() == 9);
+        }
+    }
+
+    SUBCASE("match statements")
+    {
+        runtime.execute("fn code(n: number) { match (n) { case 1 { return 10; } case 5 { return 50; } case 2.5 { return 25; } case 9 { return 90; } } return 0; }");
+
+        auto item = jit::sharedCast<jit::Number>(runtime.execute("let i: number = 0; let s: number = 0; while (i < 100) { s = s + code(i) + code(2.5); i = i + 1; } s;"));
+
+        REQUIRE(item != nullptr);
+
+        REQUIRE(item->getValue() == 2650);
+    }
+}
+
+TEST_CASE("Tail calls")
+{
+    const vip::Engine engines[] = {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE};
+
+    SUBCASE("deep tail recursion does not grow the stack")
+    {
+        for (auto engine : engines)
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            // the string param keeps the interpreter from handing the loop to the native tier.
+            runtime.execute("fn count(n: number, tag: string) { if (n < 1) { return tag; } return count(n - 1, tag + \"\"); }");
+            runtime.execute("fn even(n: number, tag: string) { if (n < 1) { return 1; } return odd(n - 1, tag); } fn odd(n: number, tag: string) { if (n < 1) { return 0; } return even(n - 1, tag); }");
+
+            auto tag = jit::sharedCast<jit::String>(runtime.execute("count(200000, \"done\");"));
+
+            REQUIRE(tag != nullptr);
+
+            REQUIRE(tag->getValue() == "done");
+
+            auto item = jit::sharedCast<jit::Number>(runtime.execute("even(200001, \"x\");"));
+
+            REQUIRE(item != nullptr);
+
+            REQUIRE(item->getValue() == 0);
+        }
+    }
+
+    SUBCASE("native tail recursion")
+    {
+        auto runtime = vip::JustInTime(true);
+        runtime.execute("fn sum(n: number, acc: number) { if (n < 1) { return acc; } return sum(n - 1, acc + n); }");
+
+        auto item = jit::sharedCast<jit::Number>(runtime.execute("sum(1000000, 0);"));
+
+        REQUIRE(item != nullptr);
+
+        REQUIRE(item->getValue() == 500000500000.0);
+    }
+
+    SUBCASE("callees still see the locals of the frame they replaced")
+    {
+        auto runtime = vip::JustInTime(true);
+        runtime.execute("let x: number = 1; fn read() { return x; } fn shadow(x: number) { let y: number = x; if (y > 0) { return read(); } return 0; }");
+
+        auto item = jit::sharedCast<jit::Number>(runtime.execute("shadow(2);"));
+
+        REQUIRE(item != nullptr);
+
+        REQUIRE(item->getValue() == 2);
+        REQUIRE_THROWS(runtime.execute("fn bad(n: number) { return read(n); } bad(1);"));
+    }
+}
+
+TEST_CASE("Context stack")
+{
+    SUBCASE("contexts are reused without their bindings")
+    {
+        jit::Context root("<root>", nullptr);
+        jit::ContextStack stack;
+        jit::Value text(new jit::String("held"));
+
+        jit::Context *first;
+        {
+            jit::Scope scope(stack, "<function>", &root, true);
+            first = scope.get();
+            first->set("x", text);
+            REQUIRE(text.getObject()->getRefs() == 2);
+        }
+        REQUIRE(stack.size() == 0);
+        REQUIRE(text.getObject()->getRefs() == 1);
+
+        jit::Scope again(stack, "<function>", &root, true);
+        REQUIRE(again.get() == first);
+        REQUIRE_FALSE(again.get()->has("x"));
+        REQUIRE(again.get()->get("x").isEmpty());
+    }
+
+    SUBCASE("a scope is given back when its code throws")
+    {
+        jit::Context root("<root>", nullptr);
+        jit::ContextStack stack;
+        try
+        {
+            jit::Scope outer(stack, "<function>", &root, true);
+            jit::Scope inner(stack, "<block>", outer.get());
+            inner.get()->set("x", jit::Value::integer(1));
+            throw std::runtime_error("boom");
+        }
+        catch (const std::runtime_error &)
+        {
+        }
+        REQUIRE(stack.size() == 0);
+    }
+
+    SUBCASE("calls do not see the locals of earlier calls")
+    {
+        auto runtime = vip::JustInTime(true);
+        runtime.execute("fn first() { let leaked: number = 7; if (1) { let inner: number = 8; } return 0; } fn peek() { return leaked; } fn deep() { return inner; }");
+
+        for (int i = 0; i < 3; i++)
+        {
+            runtime.execute("first();");
+            REQUIRE_THROWS(runtime.execute("peek();"));
+            REQUIRE_THROWS(runtime.execute("deep();"));
+        }
+    }
+
+    SUBCASE("an error unwinds every frame")
+    {
+        auto runtime = vip::JustInTime(true);
+        runtime.execute("fn down(n: number) { let k: number = n; if (n < 1) { return 1 / 0; } return 1 + down(n - 1); } fn peek() { return k; }");
+
+        REQUIRE_THROWS(runtime.execute("down(50);"));
+        REQUIRE_THROWS(runtime.execute("peek();"));
+
+        auto item = jit::sharedCast<jit::Number>(runtime.execute("fn up(n: number) { if (n < 1) { return 0; } return 1 + up(n - 1); } up(50);"));
+        REQUIRE(item != nullptr);
+        REQUIRE(item->getValue() == 50);
+    }
+
+    SUBCASE("tail calls run through reused frames")
+    {
+        auto runtime = vip::JustInTime(true);
+        runtime.execute("fn count(n: number, acc: number) { let k: number = n; if (n < 1) { return acc; } return count(n - 1, acc + k); }"
+                        "fn fail(n: number) { if (n < 1) { return 1 / 0; } return fail(n - 1); } fn peek() { return k; }");
+
+        for (int i = 0; i < 3; i++)
+        {
+            auto item = jit::sharedCast<jit::Number>(runtime.execute("count(1000, 0);"));
+            REQUIRE(item != nullptr);
+            REQUIRE(item->getValue() == 500500);
+            REQUIRE_THROWS(runtime.execute("peek();"));
+            REQUIRE_THROWS(runtime.execute("fail(100);"));
+        }
+    }
+}
+
+TEST_CASE("Inline caches")
+{
+    auto runtime = vip::JustInTime(true);
+
+    SUBCASE("locals still shadow cached globals")
+    {
+        runtime.execute("let x: number = 1; fn read() { return x; } fn shadow(x: number) { return read(); }");
+
+        for (int i = 0; i < 3; i++)
+        {
+            auto global = jit::sharedCast<jit::Number>(runtime.execute("read();"));
+            auto local = jit::sharedCast<jit::Number>(runtime.execute("shadow(2);"));
+
+            REQUIRE(global != nullptr);
+            REQUIRE(local != nullptr);
+
+            REQUIRE(global->getValue() == 1);
+            REQUIRE(local->getValue() == 2);
+        }
+
+        runtime.execute("x = 3;");
+
+        auto item = jit::sharedCast<jit::Number>(runtime.execute("read();"));
+
+        REQUIRE(item != nullptr);
+
+        REQUIRE(item->getValue() == 3);
+    }
+
+    SUBCASE("dropped functions are not called")
+    {
+        runtime.registerFn("answer", [](std::vector<std::shared_ptr<jit::Object>>) -> std::shared_ptr<jit::Object>
+                           { return std::shared_ptr<jit::Number>(new jit::Number(42.0)); });
+        runtime.execute("fn ask() { return answer(); }");
+
+        auto item = jit::sharedCast<jit::Number>(runtime.execute("ask();"));
+
+        REQUIRE(item != nullptr);
+
+        REQUIRE(item->getValue() == 42);
+
+        runtime.unregisterFn("answer");
+
+        REQUIRE_THROWS(runtime.execute("ask();"));
+    }
+}
+
+TEST_CASE("Closure engine")
+{
+    auto runtime = vip::JustInTime(true, vip::ENGINE_CLOSURE);
+
+    SUBCASE("binary operations match the interpreter")
+    {
+        auto interpreter = vip::JustInTime(true);
+        for (auto &&code : {"1 + 2 * 3 - 8 / 4;", "2 - 1 - 1;", "3 < 4 && 4 >= 4;", "1 > 2 || 2 <= 1;"})
+        {
+            auto expected = jit::sharedCast<jit::Number>(interpreter.execute(code));
+            auto item = jit::sharedCast<jit::Number>(runtime.execute(code));
+
+            REQUIRE(item != nullptr);
+
+            REQUIRE(item->getValue() == expected->getValue());
+            REQUIRE(item->isBoolean() == expected->isBoolean());
+        }
+    }
+
+    SUBCASE("recursive functions and loops")
+    {
+        runtime.execute("fn fib(n: number) { if (n < 2) { return n; } return fib(n - 1) + fib(n - 2); }");
+        runtime.execute("let total: number = 0; let i: number = 0; while (i < 5) { let step: number = fib(i); total = total + step; i = i + 1; }");
+
+        auto item = jit::sharedCast<jit::Number>(runtime.execute("total;"));
+
+        REQUIRE(item != nullptr);
+
+        REQUIRE(item->getValue() == 7);
+    }
+
+    SUBCASE("strings and type errors")
+    {
+        runtime.execute("fn greet(name: string) { return \"hello \" + name; }");
+
+        auto item = jit::sharedCast<jit::String>(runtime.execute("greet(\"vip\");"));
+
+        REQUIRE(item != nullptr);
+
+        REQUIRE(item->getValue() == "hello vip");
+
+        REQUIRE_THROWS(runtime.execute("greet(1);"));
+        REQUIRE_THROWS(runtime.execute("1 / 0;"));
+        REQUIRE_THROWS(runtime.execute("missing;"));
+    }
+
+    SUBCASE("callees see the locals of their callers like in the interpreter")
+    {
+        const char *setup = "let x: number = 1; fn read() { return x; } fn write() { x = x + 10; return x; }"
+                            "fn shadow() { let x: number = 42; return read(); } fn outer(x: number) { return through(); } fn through() { return read(); }"
+                            "fn bump() { let x: number = 5; write(); return x; } fn tail(x: number) { return read(); }";
+        auto interpreter = vip::JustInTime(true);
+        interpreter.execute(setup);
+        runtime.execute(setup);
+
+        for (auto &&code : {"shadow();", "outer(7);", "read();", "bump();", "x;", "tail(3);", "let r: number = 0; if (1) { let x: number = 9; r = read(); } r;"})
+        {
+            auto expected = jit::sharedCast<jit::Number>(interpreter.execute(code));
+            auto item = jit::sharedCast<jit::Number>(runtime.execute(code));
+
+            REQUIRE(expected != nullptr);
+            REQUIRE(item != nullptr);
+
+            REQUIRE(item->getValue() == expected->getValue());
+        }
+
+        auto item = jit::sharedCast<jit::Number>(runtime.execute("shadow() * 100 + bump();"));
+        REQUIRE(item != nullptr);
+        REQUIRE(item->getValue() == 4215);
+    }
+}
+
+TEST_CASE("Operators")
+{
+    const vip::Engine engines[] = {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE};
+
+    SUBCASE("comparisons on numbers and strings")
+    {
+        const std::pair<const char *, bool> cases[] = {
+            {"1 == 1;", true},
+            {"1 != 1;", false},
+            {"1 + 1 == 2;", true},
+            {"2 <= 1;", false},
+            {"\"abc\" == \"abc\";", true},
+            {"\"abc\" != \"abd\";", true},
+            {"\"abc\" < \"abd\";", true},
+            {"\"b\" > \"abc\";", true},
+            {"\"ab\" >= \"abc\";", false},
+            {"\"ab\" <= \"ab\";", true},
+            {"1 < 2 && 2 < 1;", false},
+            {"let x: number = 1 == 1; x;", true},
+        };
+        for (auto engine : engines)
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            for (auto &&entry : cases)
+            {
+                auto item = jit::sharedCast<jit::Number>(runtime.execute(entry.first));
+
+                REQUIRE(item != nullptr);
+
+                REQUIRE(item->isBoolean());
+                REQUIRE(item->asBool() == entry.second);
+            }
+
+            REQUIRE_THROWS(runtime.execute("1 == \"1\";"));
+            REQUIRE_THROWS(runtime.execute("\"a\" - \"b\";"));
+        }
+    }
+
+    SUBCASE("logical operators short circuit")
+    {
+        for (auto engine : engines)
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            auto item = jit::sharedCast<jit::Number>(runtime.execute("0 && missing();"));
+
+            REQUIRE(item != nullptr);
+
+            REQUIRE(!item->asBool());
+
+            item = jit::sharedCast<jit::Number>(runtime.execute("1 || missing();"));
+
+            REQUIRE(item != nullptr);
+
+            REQUIRE(item->asBool());
+
+            REQUIRE_THROWS(runtime.execute("1 && missing();"));
+            REQUIRE_THROWS(runtime.execute("\"a\" || 1;"));
+        }
+    }
+}
+
+TEST_CASE("Match")
+{
+    const vip::Engine engines[] = {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE};
+    const char *program =
+        "fn dense(x: number) { match (x) { case 0 { return 10; } case 1 { return 11; } case 2 { return 12; } case 3 { return 13; } else { return 99; } } }"
+        "fn sparse(x: number) { match (x) { case -5 { return 1; } case 1000 { return 2; } case 0.5 { return 3; } } return 0; }"
+        "fn named(s: string) { match (s) { case \"get\" { return 1; } case \"put\" { return 2; } else { return 0; } } }";
+
+    SUBCASE("dense, sparse and string cases")
+    {
+        const std::pair<const char *, double> cases[] = {
+            {"dense(0);", 10},
+            {"dense(3);", 13},
+            {"dense(4);", 99},
+            {"dense(1.5);", 99},
+            {"dense(7);", 99},
+            {"sparse(0 - 5);", 1},
+            {"sparse(1000);", 2},
+            {"sparse(0.5);", 3},
+            {"sparse(7);", 0},
+            {"named(\"put\");", 2},
+            {"named(\"pu\");", 0},
+        };
+        for (auto engine : engines)
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            runtime.execute(program);
+            for (auto &&entry : cases)
+            {
+                auto item = jit::sharedCast<jit::Number>(runtime.execute(entry.first));
+
+                REQUIRE(item != nullptr);
+
+                REQUIRE(item->getValue() == entry.second);
+            }
+        }
+    }
+
+    SUBCASE("cases run in their own scope")
+    {
+        for (auto engine : engines)
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            auto item = jit::sharedCast<jit::Number>(runtime.execute("let r: number = 0; let i: number = 0; while (i < 5) { match (i) { case 1 { let t: number = 10; r = r + t; } case 3 { r = r + 100; } } i = i + 1; } r;"));
+
+            REQUIRE(item != nullptr);
+
+            REQUIRE(item->getValue() == 110);
+        }
+    }
+
+    SUBCASE("duplicate cases do not parse")
+    {
+        auto runtime = vip::JustInTime(true);
+
+        REQUIRE_THROWS(runtime.execute("match (1) { case 1 { } case 1 { } }"));
+        REQUIRE_THROWS(runtime.execute("match (1) { case \"a\" { } case \"a\" { } }"));
+    }
+}
+
+TEST_CASE("For loops")
+{
+    const vip::Engine engines[] = {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE};
+
+    SUBCASE("counting up, down and by steps")
+    {
+        const std::pair<const char *, double> cases[] = {
+            {"let a: number = 0; for i in 0..10 { a = a + i; } a;", 45},
+            {"let b: number = 0; for i in 0..10 step 3 { b = b + i; } b;", 18},
+            {"let c: number = 0; for i in 5..0 step 0 - 1 { c = c * 10 + i; } c;", 54321},
+            {"let d: number = 0; for i in 3..3 { d = 1; } d;", 0},
+            {"let e: number = 0; for i in 0..3 { for j in 0..i { e = e + 1; } } e;", 3},
+        };
+        for (auto engine : engines)
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            for (auto &&entry : cases)
+            {
+                auto item = jit::sharedCast<jit::Number>(runtime.execute(entry.first));
+
+                REQUIRE(item != nullptr);
+
+                REQUIRE(item->getValue() == entry.second);
+            }
+        }
+    }
+
+    SUBCASE("bounds are evaluated once and kept values do not change")
+    {
+        for (auto engine : engines)
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            auto item = jit::sharedCast<jit::Number>(runtime.execute("let n: number = 3; let c: number = 0; for i in 0..n { n = 10; c = c + 1; } c;"));
+
+            REQUIRE(item != nullptr);
+
+            REQUIRE(item->getValue() == 3);
+
+            item = jit::sharedCast<jit::Number>(runtime.execute("let last: number = 0; for k in 0..4 { last = k; } last;"));
+
+            REQUIRE(item != nullptr);
+
+            REQUIRE(item->getValue() == 3);
+
+            REQUIRE_THROWS(runtime.execute("for x in 0..\"a\" { }"));
+            REQUIRE_THROWS(runtime.execute("for x in 0..3 step 0 { }"));
+        }
+    }
+
+    SUBCASE("returns from inside the loop")
+    {
+        for (auto engine : engines)
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            runtime.execute("fn root(n: number) { for i in 0..n { if (i * i > n) { return i; } } return 0; }");
+
+            // enough calls for the interpreter to compile root to native code.
+            auto item = jit::sharedCast<jit::Number>(runtime.execute("let s: number = 0; for i in 0..50 { s = s + root(50); } s;"));
+
+            REQUIRE(item != nullptr);
+
+            REQUIRE(item->getValue() == 400);
+        }
+    }
+}
+
+TEST_CASE("Compound assignment")
+{
+    const vip::Engine engines[] = {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE};
+
+    SUBCASE("numbers")
+    {
+        for (auto engine : engines)
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            auto item = jit::sharedCast<jit::Number>(runtime.execute("let a: number = 10; a += 5; a -= 3; a *= 2; a /= 4; a;"));
+
+            REQUIRE(item != nullptr);
+
+            REQUIRE(item->getValue() == 6);
+
+            REQUIRE_THROWS(runtime.execute("a /= 0;"));
+            REQUIRE_THROWS(runtime.execute("a += \"x\";"));
+            REQUIRE_THROWS(runtime.execute("missing += 1;"));
+        }
+    }
+
+    SUBCASE("strings are appended without touching other holders")
+    {
+        const std::pair<const char *, const char *> cases[] = {
+            {"let s: string = \"\"; for i in 0..5 { s += \"x\"; } s;", "xxxxx"},
+            {"let t: string = \"a\"; let u: string = t; t += \"b\"; u;", "a"},
+            {"t;", "ab"},
+            {"let v: string = \"q\"; v += v; v += v; v;", "qqqq"},
+        };
+        for (auto engine : engines)
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            for (auto &&entry : cases)
+            {
+                auto item = jit::sharedCast<jit::String>(runtime.execute(entry.first));
+
+                REQUIRE(item != nullptr);
+
+                REQUIRE(item->getValue() == entry.second);
+            }
+        }
+    }
+
+    SUBCASE("native functions")
+    {
+        auto runtime = vip::JustInTime(true);
+        runtime.execute("fn sum(n: number) { let s: number = 0; for i in 0..n { s += i; s *= 1; } return s; }");
+
+        auto item = jit::sharedCast<jit::Number>(runtime.execute("let total: number = 0; for k in 0..20 { total += sum(10); } total;"));
+
+        REQUIRE(item != nullptr);
+
+        REQUIRE(item->getValue() == 900);
+    }
+}
+
+TEST_CASE("Structs")
+{
+    const char *shapes = "struct Point { x: number, y: number } struct Line { from: Point, to: Point }";
+
+    SUBCASE("fields are read and written in place")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            runtime.execute(shapes);
+            auto item = jit::sharedCast<jit::Number>(runtime.execute(
+                "let p: Point = Point(3, 4); p.x = p.x + 1; p.y += 2; p.x * 10 + p.y;"));
+
+            REQUIRE(item != nullptr);
+            REQUIRE(item->getValue() == 46);
+
+            std::stringstream printed;
+            printed << *runtime.execute("Line(p, Point(0, 1));");
+            REQUIRE(printed.str() == "Line { from: [Point], to: [Point] }");
+        }
+    }
+
+    SUBCASE("records are passed to functions and nested")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            runtime.execute(shapes);
+            runtime.execute("fn length(l: Line) { let dx: number = l.to.x - l.from.x; let dy: number = l.to.y - l.from.y; return dx * dx + dy * dy; }");
+            auto item = jit::sharedCast<jit::Number>(runtime.execute("length(Line(Point(1, 1), Point(4, 5)));"));
+
+            REQUIRE(item != nullptr);
+            REQUIRE(item->getValue() == 25);
+            REQUIRE_THROWS(runtime.execute("length(Point(1, 1));"));
+        }
+    }
+
+    SUBCASE("a site follows the shape it sees")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            auto item = jit::sharedCast<jit::Number>(runtime.execute(
+                "struct A { x: number } struct B { y: number, x: number }"
+                "let v: A = A(0); let s: number = 0;"
+                "for i in 0..6 { if (i % 2 == 0) { v = A(i); } else { v = B(0, i); } s = s + v.x; } s;"));
+
+            REQUIRE(item != nullptr);
+            REQUIRE(item->getValue() == 15);
+        }
+    }
+
+    SUBCASE("bad records")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            runtime.execute(shapes);
+
+            REQUIRE_THROWS(runtime.execute("Point(1);"));
+            REQUIRE_THROWS(runtime.execute("Point(1, \"y\");"));
+            REQUIRE_THROWS(runtime.execute("Point(1, 2).z;"));
+            REQUIRE_THROWS(runtime.execute("let n: number = 1; n.x;"));
+            REQUIRE_THROWS(runtime.execute("struct Point { x: number }"));
+            REQUIRE_THROWS(runtime.execute("struct Pair { a: number, a: number }"));
+        }
+    }
+
+    SUBCASE("fields only take values of their type")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            runtime.execute(shapes);
+            runtime.execute("struct Named { name: string } let p: Point = Point(1, 2); let l: Line = Line(p, p); let n: Named = Named(\"a\");");
+
+            REQUIRE_THROWS(runtime.execute("p.x = \"str\";"));
+            REQUIRE_THROWS(runtime.execute("l.from = 3;"));
+            REQUIRE_THROWS(runtime.execute("l.to = l;"));
+            REQUIRE_THROWS(runtime.execute("p.y += \"str\";"));
+            REQUIRE_THROWS(runtime.execute("n.name += 1;"));
+            REQUIRE_THROWS(runtime.execute("fn put(v: string) { p.x = v; } put(\"s\");"));
+
+            runtime.execute("fn set(v: number) { p.x = v; } n.name += \"b\"; l.to = Point(5, 6); set(7);");
+            auto item = jit::sharedCast<jit::Number>(runtime.execute("p.x * 10 + p.y + l.to.x;"));
+            REQUIRE(item != nullptr);
+            REQUIRE(item->getValue() == 77);
+
+            auto name = jit::sharedCast<jit::String>(runtime.execute("n.name;"));
+            REQUIRE(name != nullptr);
+            REQUIRE(name->getValue() == "ab");
+        }
+    }
+
+    SUBCASE("records in cycles are collected")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            // fields can not be null, so the cycle runs through a map the record holds.
+            runtime.execute("struct Node { value: number, links: map } for i in 0..100 { let n: Node = Node(i, map()); n.links[\"next\"] = n; }");
+            runtime.collectGarbage();
+
+            REQUIRE(runtime.getHeapStats().young + runtime.getHeapStats().old < 100);
+        }
+    }
+
+    SUBCASE("cycles through records and maps print")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            runtime.execute("struct N { m: map } let m: map = map(); let n: N = N(m); m[1] = n;");
+
+            std::stringstream record;
+            record << *runtime.execute("n;");
+            REQUIRE(record.str() == "N { m: [map] }");
+
+            std::stringstream held;
+            held << *runtime.execute("m;");
+            REQUIRE(held.str() == "{ 1: [N] }");
+        }
+    }
+}
+
+TEST_CASE("Arrays")
+{
+    SUBCASE("elements are read and written by index")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            auto item = jit::sharedCast<jit::Number>(runtime.execute(
+                "let a: number[] = [1, 2, 3]; a[0] = 10; a[2] += 5; let b: number[] = array(4); b[3] = a[0] + a[1]; b[3] * 100 + a[2];"));
+
+            REQUIRE(item != nullptr);
+            REQUIRE(item->getValue() == 1208);
+
+            std::stringstream printed;
+            printed << *runtime.execute("a;");
+            REQUIRE(printed.str() == "[10, 2, 8]");
+        }
+    }
+
+    SUBCASE("bulk builtins")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            runtime.execute("let a: number[] = [4, 1, 3, 2, 5]; let b: number[] = array(5, 2);");
+
+            auto number = [&](const char *code)
+            {
+                auto item = jit::sharedCast<jit::Number>(runtime.execute(code));
+                REQUIRE(item != nullptr);
+                return item->getValue();
+            };
+
+            REQUIRE(number("len(a);") == 5);
+            REQUIRE(number("sum(a);") == 15);
+            REQUIRE(number("min(a);") == 1);
+            REQUIRE(number("max(a);") == 5);
+            REQUIRE(number("dot(a, b);") == 30);
+            REQUIRE(number("sort(a); a[0] * 10 + a[4];") == 15);
+            REQUIRE(number("scale(a, 2); add(a, b); a[4];") == 12);
+            REQUIRE(number("fill(b, 0.5); sum(b);") == 2.5);
+            REQUIRE(number("fn total(v: number[]) { return sum(v); } total([1, 2]);") == 3);
+        }
+    }
+
+    SUBCASE("declared functions replace builtins")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            auto item = jit::sharedCast<jit::Number>(runtime.execute("fn sum(n: number) { return n + 1; } sum(1);"));
+
+            REQUIRE(item != nullptr);
+            REQUIRE(item->getValue() == 2);
+        }
+    }
+
+    SUBCASE("bad arrays")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            runtime.execute("let a: number[] = [1, 2];");
+
+            REQUIRE_THROWS(runtime.execute("a[2];"));
+            REQUIRE_THROWS(runtime.execute("a[0.5];"));
+            REQUIRE_THROWS(runtime.execute("a[0] = \"x\";"));
+            REQUIRE_THROWS(runtime.execute("[1, \"x\"];"));
+            REQUIRE_THROWS(runtime.execute("let n: number = 1; n[0];"));
+            REQUIRE_THROWS(runtime.execute("dot(a, [1]);"));
+            REQUIRE_THROWS(runtime.execute("min(array(0));"));
+        }
+    }
+
+    SUBCASE("kernels agree with the scalar loops")
+    {
+        auto &best = jit::kernels::best();
+        auto &scalar = jit::kernels::scalar();
+
+        // whole numbers keep every sum exact, so the lanes can not round differently.
+        for (std::size_t length = 0; length < 38; length++)
+        {
+            std::vector<double> lhs(length + 1), rhs(length + 1);
+            for (std::size_t i = 0; i < length; i++)
+            {
+                lhs[i + 1] = (double)((i * 7) % 11) - 5;
+                rhs[i + 1] = (double)((i * 3) % 5);
+            }
+
+            // one past the start, so the loads are not aligned.
+            double *a = lhs.data() + 1, *b = rhs.data() + 1;
+            REQUIRE(best.sum(a, length) == scalar.sum(a, length));
+            REQUIRE(best.dot(a, b, length) == scalar.dot(a, b, length));
+            if (length > 0)
+            {
+                REQUIRE(best.min(a, length) == scalar.min(a, length));
+                REQUIRE(best.max(a, length) == scalar.max(a, length));
+            }
+
+            auto scaled = lhs, expected = lhs;
+            best.scale(scaled.data() + 1, length, 3);
+            scalar.scale(expected.data() + 1, length, 3);
+            best.add(scaled.data() + 1, b, length);
+            scalar.add(expected.data() + 1, b, length);
+            REQUIRE(scaled == expected);
+
+            best.fill(scaled.data() + 1, length, 2);
+            scalar.fill(expected.data() + 1, length, 2);
+            REQUIRE(scaled == expected);
+
+            // NaN at the start, in the vector part and in the tail.
+            for (std::size_t at = 0; at < length; at += 5)
+            {
+                auto holes = lhs;
+                holes[at + 1] = std::nan("");
+                double *c = holes.data() + 1;
+                REQUIRE(std::isnan(best.min(c, length)));
+                REQUIRE(std::isnan(best.max(c, length)));
+                REQUIRE(std::isnan(scalar.min(c, length)));
+                REQUIRE(std::isnan(scalar.max(c, length)));
+            }
+        }
+    }
+}
+
+TEST_CASE("Maps")
+{
+    SUBCASE("values are read and written by key")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            auto item = jit::sharedCast<jit::Number>(runtime.execute(
+                "let m: map = map(); m[\"a\"] = 1; m[2] = 20; m[\"a\"] += 4; m[2.0] = m[2] + 1; m[\"a\"] * 100 + m[2];"));
+
+            REQUIRE(item != nullptr);
+            REQUIRE(item->getValue() == 521);
+
+            auto size = jit::sharedCast<jit::Number>(runtime.execute("len(m);"));
+            REQUIRE(size != nullptr);
+            REQUIRE(size->getValue() == 2);
+        }
+    }
+
+    SUBCASE("keys are added, found and removed")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            // enough keys to grow the table several times, then every other one is removed.
+            auto item = jit::sharedCast<jit::Number>(runtime.execute(
+                "let m: map = map(4); for i in 0..1000 { m[i * 7] = i; }"
+                "for i in 0..500 { remove(m, i * 14); }"
+                "let s: number = 0; for i in 0..1000 { if (has(m, i * 7)) { s = s + m[i * 7]; } } s * 1000 + len(m);"));
+
+            REQUIRE(item != nullptr);
+            REQUIRE(item->getValue() == 250000 * 1000 + 500);
+            REQUIRE_THROWS(runtime.execute("m[0];"));
+        }
+    }
+
+    SUBCASE("string keys compare by text")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            auto item = jit::sharedCast<jit::Number>(runtime.execute(
+                "let m: map = map(); let k: string = \"ke\"; k += \"y\"; m[k] = 3; fn get(t: map) { return t[\"key\"]; } get(m);"));
+
+            REQUIRE(item != nullptr);
+            REQUIRE(item->getValue() == 3);
+        }
+    }
+
+    SUBCASE("bad keys")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            runtime.execute("let m: map = map(); let a: number[] = [1];");
+
+            REQUIRE_THROWS(runtime.execute("m[a] = 1;"));
+            REQUIRE_THROWS(runtime.execute("m[\"x\"] += 1;"));
+            REQUIRE_THROWS(runtime.execute("has(a, 1);"));
+        }
+    }
+
+    SUBCASE("maps in cycles are collected")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            runtime.execute("for i in 0..100 { let m: map = map(); m[\"self\"] = m; }");
+            runtime.collectGarbage();
+
+            REQUIRE(runtime.getHeapStats().young + runtime.getHeapStats().old < 100);
+        }
+    }
+}
+
+TEST_CASE("Integers")
+{
+    const vip::Engine engines[] = {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE};
+
+    SUBCASE("exact above 2^53 and promoted on overflow")
+    {
+        const std::pair<const char *, double> cases[] = {
+            {"let big: number = 9007199254740993; big - 9007199254740992;", 1},
+            {"let wide: number = 9223372036854775807; wide + 1 > wide;", 1},
+            {"let prod: number = 4294967296 * 4294967296; prod == 18446744073709551616.0;", 1},
+            {"7 / 2;", 3.5},
+            {"let ints: number = 0; for i in 0..100 { ints = ints + i * i; } ints;", 328350},
+        };
+        for (auto engine : engines)
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            for (auto &&entry : cases)
+            {
+                auto item = jit::sharedCast<jit::Number>(runtime.execute(entry.first));
+
+                REQUIRE(item != nullptr);
+
+                REQUIRE(item->getValue() == entry.second);
+            }
+        }
+        REQUIRE(jit::Value::integer(1ll << 60).asInteger() == 1ll << 60);
+        REQUIRE(jit::Value::integer(-5).asInteger() == -5);
+        REQUIRE(jit::Value::integer(-5).getKind() == jit::consts::ID_NUMBER);
+    }
+
+    SUBCASE("remainder and bitwise operators")
+    {
+        const std::pair<const char *, double> cases[] = {
+            {"17 % 5;", 2},
+            {"let neg: number = 0 - 17; neg % 5;", -2},
+            {"7.5 % 2;", 1.5},
+            {"12 & 10;", 8},
+            {"12 | 3;", 15},
+            {"12 ^ 10;", 6},
+            {"1 << 40 >> 38;", 4},
+            {"6 & 1 == 0;", 1},
+            {"1 + 2 << 1;", 6},
+            {"let h: number = 0; for i in 0..50 { h = h * 31 + i & 65535; } h % 1000;", 81},
+        };
+        for (auto engine : engines)
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            for (auto &&entry : cases)
+            {
+                auto item = jit::sharedCast<jit::Number>(runtime.execute(entry.first));
+
+                REQUIRE(item != nullptr);
+
+                REQUIRE(item->getValue() == entry.second);
+            }
+            REQUIRE_THROWS(runtime.execute("1.5 & 1;"));
+            REQUIRE_THROWS(runtime.execute("3 % 0;"));
+            REQUIRE_THROWS(runtime.execute("\"a\" | 1;"));
+        }
+    }
+}
+
+TEST_CASE("Values")
+{
+    SUBCASE("numbers and immediates are stored inline")
+    {
+        REQUIRE(jit::Value(2.5).isNumber());
+        REQUIRE(jit::Value(2.5).asNumber() == 2.5);
+        REQUIRE(jit::Value(0.0 / 0.0).isNumber());
+        REQUIRE(jit::Value::boolean(true).getKind() == jit::consts::ID_NUMBER);
+        REQUIRE(jit::Value::boolean(true).asNumber() == 1);
+        REQUIRE(!jit::Value::boolean(true).isNumber());
+        REQUIRE(jit::Value::null().getKind() == jit::consts::ID_NULL);
+        REQUIRE(jit::Value().isEmpty());
+        REQUIRE(sizeof(jit::Value) == 8);
+    }
+
+    SUBCASE("objects are freed with the last value")
+    {
+        auto value = jit::Value(new jit::String("text"));
+        auto copy = value;
+        REQUIRE(!value.isUnique());
+
+        copy = jit::Value(1.0);
+        REQUIRE(value.isUnique());
+        REQUIRE(jit::cast<jit::String>(value)->getValue() == "text");
+        REQUIRE(jit::cast<jit::String>(copy) == nullptr);
+    }
+
+    SUBCASE("value callbacks")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            runtime.registerFn("twice", [](jit::Arguments args) -> jit::Value
+                               { return jit::Value(args[0].asNumber() * 2); });
+
+            auto item = jit::sharedCast<jit::Number>(runtime.execute("let s: number = 0; for i in 0..10 { s += twice(i); } s;"));
+
+            REQUIRE(item != nullptr);
+
+            REQUIRE(item->getValue() == 90);
+
+            auto text = jit::sharedCast<jit::String>(runtime.execute("let t: string = \"a\"; t += \"b\"; t;"));
+
+            REQUIRE(text != nullptr);
+
+            REQUIRE(text->getValue() == "ab");
+        }
+    }
+}
+
+/// @brief an object holding one value, enough to build a cycle.
+class Cell : public jit::Object
+{
+public:
+    static int alive;
+    jit::Value value;
+
+    Cell() : jit::Object(jit::consts::ID_COUNT, true) { alive++; }
+    ~Cell() { alive--; }
+    void trace(jit::Tracer &tracer) override { tracer.visit(value); }
+};
+int Cell::alive = 0;
+
+Cell &cell(const jit::Value &value)
+{
+    return *static_cast<Cell *>(value.getObject());
+}
+
+TEST_CASE("Ropes")
+{
+    SUBCASE("concatenation is flattened on first read")
+    {
+        auto head = jit::Value(new jit::String(std::string(100, 'a')));
+        auto tail = jit::Value(new jit::String(std::string(100, 'b')));
+        auto joined = jit::String::concat(head, tail);
+        auto &rope = *jit::cast<jit::String>(joined);
+
+        REQUIRE(rope.size() == 200);
+        REQUIRE(rope.view().substr(98, 4) == "aabb");
+        REQUIRE(rope == jit::String(std::string(100, 'a') + std::string(100, 'b')));
+
+        // short text is copied right away.
+        auto small = jit::String::concat(jit::Value(new jit::String("ab")), jit::Value(new jit::String("cd")));
+        REQUIRE(jit::cast<jit::String>(small)->getValue() == "abcd");
+    }
+
+    SUBCASE("slices view the text they are of")
+    {
+        auto base = jit::Value(new jit::String("hello, world"));
+        auto slice = jit::Value(new jit::String(base, 7, 5));
+        auto inner = jit::String(slice, 1, 3);
+
+        REQUIRE(jit::cast<jit::String>(slice)->view() == "world");
+        REQUIRE(jit::cast<jit::String>(slice)->view().data() == jit::cast<jit::String>(base)->getValue().data() + 7);
+        REQUIRE(inner.getValue() == "orl");
+    }
+
+    SUBCASE("deep ropes do not recurse")
+    {
+        auto rope = jit::Value(new jit::String(std::string(200, 'x')));
+        for (int i = 0; i < 100000; i++)
+            rope = jit::String::concat(rope, jit::Value(new jit::String("y")));
+
+        REQUIRE(jit::cast<jit::String>(rope)->size() == 100200);
+        REQUIRE(jit::cast<jit::String>(rope)->getValue().back() == 'y');
+
+        auto unread = jit::Value(new jit::String(std::string(200, 'x')));
+        for (int i = 0; i < 100000; i++)
+            unread = jit::String::concat(jit::Value(new jit::String("y")), unread);
+        unread = jit::Value();
+    }
+
+    SUBCASE("reports built from fragments")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            auto item = jit::sharedCast<jit::Number>(runtime.execute(
+                "let report: string = \"\"; let other: string = \"\";"
+                "for i in 0..2000 { report = report + \"line of the report \"; other = other + \"line of the \" + \"report \"; }"
+                "report == other && report != other + \"!\" && report < other + \"!\";"));
+
+            REQUIRE(item != nullptr);
+
+            REQUIRE(item->getValue() == 1);
+        }
+    }
+}
+
+TEST_CASE("Interned strings")
+{
+    SUBCASE("one string per text")
+    {
+        jit::Interner strings, others;
+        auto &first = strings.intern("key");
+        auto &second = strings.intern(std::string("ke") + "y");
+        auto &other = strings.intern("value");
+
+        REQUIRE(first.getObject() == second.getObject());
+        REQUIRE(strings.size() == 2);
+        REQUIRE(jit::cast<jit::String>(first)->isInterned());
+        REQUIRE(jit::cast<jit::String>(first)->hash() == std::hash<std::string_view>{}("key"));
+        REQUIRE_FALSE(*jit::cast<jit::String>(first) == *jit::cast<jit::String>(other));
+
+        // strings of another interner or none at all still compare by their text.
+        REQUIRE(*jit::cast<jit::String>(first) == *jit::cast<jit::String>(others.intern("key")));
+        REQUIRE(*jit::cast<jit::String>(first) == jit::String("key"));
+    }
+
+    SUBCASE("literals are shared")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            auto first = runtime.execute("let a: string = \"key\"; a;");
+            auto second = runtime.execute("\"key\";");
+            auto matched = jit::sharedCast<jit::Number>(runtime.execute(
+                "let b: string = a + \"s\"; let c: number = 0; match (b) { case \"key\" { c = 1; } case \"keys\" { c = 2; } } c;"));
+
+            REQUIRE(first.get() == second.get());
+            REQUIRE(matched != nullptr);
+            REQUIRE(matched->getValue() == 2);
+        }
+    }
+}
+
+TEST_CASE("Regions")
+{
+    SUBCASE("released memory is handed out again")
+    {
+        jit::Region region(64);
+        auto mark = region.mark();
+        auto first = region.allocate(24, 8);
+        auto aligned = region.allocate(16, 16);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(aligned) % 16 == 0);
+
+        // bigger than a chunk, so it gets one of its own.
+        auto big = static_cast<char *>(region.allocate(1000, 8));
+        big[999] = 1;
+
+        region.release(mark);
+        REQUIRE(region.allocate(24, 8) == first);
+
+        region.reset();
+        REQUIRE(region.allocate(24, 8) == first);
+    }
+
+    SUBCASE("containers on a region")
+    {
+        jit::Region region;
+        {
+            jit::Region::Scope scope(region);
+            std::vector<jit::Value, jit::RegionAllocator<jit::Value>> values{jit::RegionAllocator<jit::Value>(&region)};
+            for (int i = 0; i < 100; i++)
+                values.push_back(jit::Value(new jit::String(std::to_string(i))));
+            REQUIRE(jit::cast<jit::String>(values[99])->getValue() == "99");
+        }
+
+        // no region falls back to new and delete.
+        std::vector<int, jit::RegionAllocator<int>> plain;
+        plain.push_back(1);
+        REQUIRE(plain.front() == 1);
+    }
+
+    SUBCASE("frames come from regions and stay correct")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            auto item = jit::sharedCast<jit::String>(runtime.execute(
+                "fn pick(n: number, a: string, b: string) { if (n < 1) { return a; } let t: string = a; return pick(n - 1, b, t); }"
+                "fn deep(n: number, s: string) { if (n < 1) { return s; } let local: string = s; return deep(n - 1, local) + \"\"; }"
+                "deep(200, pick(1001, \"a\", \"b\"));"));
+
+            REQUIRE(item != nullptr);
+
+            REQUIRE(item->getValue() == "b");
+        }
+    }
+}
+
+TEST_CASE("Garbage collector")
+{
+    SUBCASE("cycles are freed once nothing outside holds them")
+    {
+        jit::Heap heap;
+        {
+            jit::Heap::Use use(heap);
+            auto a = jit::Value(new Cell());
+            auto b = jit::Value(new Cell());
+            cell(a).value = b;
+            cell(b).value = a;
+        }
+        REQUIRE(Cell::alive == 2);
+
+        heap.collect(false);
+
+        REQUIRE(Cell::alive == 0);
+        REQUIRE(heap.getStats().collected == 2);
+        REQUIRE(heap.getStats().young == 0);
+    }
+
+    SUBCASE("values on the stack keep what they reach alive")
+    {
+        jit::Heap heap(3);
+        jit::Heap::Use use(heap);
+        auto root = jit::Value(new Cell());
+        cell(root).value = jit::Value(new Cell());
+        cell(cell(root).value).value = jit::Value(new Cell());
+        auto loop = jit::Value(new Cell());
+        cell(loop).value = loop;
+
+        heap.safepoint();
+
+        REQUIRE(Cell::alive == 4);
+        REQUIRE(heap.getStats().minorCollections == 1);
+        REQUIRE(heap.getStats().promoted == 4);
+        REQUIRE(heap.getStats().old == 4);
+
+        // old objects are only looked at by a major collection.
+        loop = jit::Value();
+        heap.collect(false);
+        REQUIRE(Cell::alive == 4);
+        heap.collect(true);
+        REQUIRE(Cell::alive == 3);
+        REQUIRE(heap.getStats().majorCollections == 1);
+    }
+
+    SUBCASE("runtimes collect and report pauses")
+    {
+        std::shared_ptr<jit::Object> kept;
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            kept = runtime.execute("let keep: string = \"\"; for i in 0..3000 { let piece: string = \"x\"; keep = piece + keep; } keep;");
+            runtime.collectGarbage();
+
+            auto stats = runtime.getHeapStats();
+            REQUIRE(stats.allocated > 3000);
+            REQUIRE(stats.majorCollections >= 1);
+            REQUIRE(stats.maxPause >= 0);
+            REQUIRE(stats.young + stats.old <= stats.allocated);
+        }
+
+        // a value handed out by a runtime outlives it.
+        auto text = jit::sharedCast<jit::String>(kept);
+        REQUIRE(text != nullptr);
+        REQUIRE(text->getValue().size() == 3000);
+    }
+}
+
+#if defined(__linux__) || defined(__APPLE__)
+TEST_CASE("Memory")
+{
+    SUBCASE("usage is tracked and drops as values are freed")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            runtime.execute("let a: number[] = array(100000, 1);");
+            auto used = runtime.getMemoryStats();
+            REQUIRE(used.current >= 800000);
+            REQUIRE(used.peak >= used.current);
+
+            runtime.execute("a = array(1, 0);");
+            auto freed = runtime.getMemoryStats();
+            REQUIRE(freed.current + 790000 <= used.current);
+            REQUIRE(freed.peak == used.peak);
+
+            runtime.registerFn("twice", [](double x)
+                               { return x * 2; });
+            auto registered = runtime.getMemoryStats();
+            REQUIRE(registered.current > freed.current);
+
+            runtime.unregisterFn("twice");
+            REQUIRE(runtime.getMemoryStats().current < registered.current);
+        }
+    }
+
+    SUBCASE("the hard limit ends the script and leaves the runtime usable")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            runtime.execute("let keep: number = 1;");
+            runtime.setMemoryLimit(runtime.getMemoryStats().current + (1 << 20));
+
+            for (auto code : {"let big: number[] = array(1000000, 0);", "let s: string = \"\"; for i in 0..10000000 { s += \"x\"; }"})
+            {
+                bool refused = false;
+                try
+                {
+                    runtime.execute(code);
+                }
+                catch (const std::bad_alloc &)
+                {
+                    refused = true;
+                }
+                REQUIRE(refused);
+            }
+
+            auto stats = runtime.getMemoryStats();
+            REQUIRE(stats.refused == 2);
+            REQUIRE(stats.current <= stats.hardLimit);
+
+            auto item = jit::sharedCast<jit::Number>(runtime.execute("keep + 2;"));
+            REQUIRE(item != nullptr);
+            REQUIRE(item->getValue() == 3);
+        }
+    }
+
+    SUBCASE("an allocator of the embedder is used for everything charged")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            std::size_t live = 0;
+            unsigned long calls = 0;
+            {
+                auto runtime = vip::JustInTime(true, engine);
+                jit::Allocator allocator;
+                allocator.allocate = [&](std::size_t bytes, std::size_t align)
+                {
+                    live += bytes;
+                    calls++;
+                    return ::operator new(bytes, std::align_val_t(align));
+                };
+                allocator.deallocate = [&](void *pointer, std::size_t bytes, std::size_t align)
+                {
+                    live -= bytes;
+                    ::operator delete(pointer, std::align_val_t(align));
+                };
+                runtime.setAllocator(allocator);
+
+                auto item = jit::sharedCast<jit::Number>(runtime.execute("let a: number[] = array(1000, 1); let m: map = map(); m[\"k\"] = a; a[999] + 1;"));
+                REQUIRE(item != nullptr);
+                REQUIRE(item->getValue() == 2);
+                REQUIRE(calls > 0);
+                REQUIRE(live == runtime.getMemoryStats().current);
+
+                REQUIRE_THROWS(runtime.setAllocator(jit::Allocator()));
+            }
+            REQUIRE(live == 0);
+        }
+    }
+
+    SUBCASE("the soft limit is reported once")
+    {
+        for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+        {
+            auto runtime = vip::JustInTime(true, engine);
+            std::size_t reports = 0;
+            std::size_t reached = 0;
+            auto limit = runtime.getMemoryStats().current + 100000;
+            runtime.setSoftMemoryLimit(limit, [&](std::size_t bytes)
+                                       { reports++; reached = bytes; });
+
+            runtime.execute("let s: string = \"\"; for i in 0..200000 { s += \"x\"; }");
+            REQUIRE(reports == 1);
+            REQUIRE(reached >= limit);
+        }
+    }
+}
+
+TEST_CASE("Heap snapshots")
+{
+    for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+    {
+        auto runtime = vip::JustInTime(true, engine);
+        runtime.execute("let big: number[] = array(1000, 0); let m: map = map(); m[\"k\"] = \"hello\" + \"!\";"
+                        "fn f(a: number) { return a + 1; }");
+        auto before = runtime.snapshotHeap();
+
+        REQUIRE(before.getKind(jit::consts::ID_ARRAY).count == 1);
+        REQUIRE(before.getKind(jit::consts::ID_ARRAY).bytes >= 8000);
+        REQUIRE(before.getKind(jit::consts::ID_MAP).count == 1);
+        REQUIRE(before.getUnreached() == 0);
+        REQUIRE(before.getLargest().front().kind == jit::consts::ID_ARRAY);
+        REQUIRE(before.getLargest().front().path == "big");
+
+        // a string made at runtime is only held by the map.
+        auto &strings = before.getStrings();
+        auto hello = std::find_if(strings.begin(), strings.end(), [](auto &entry)
+                                  { return entry.preview == "hello!"; });
+        REQUIRE(hello != strings.end());
+        REQUIRE(hello->path == "m > string");
+
+        REQUIRE(before.getFunctions().size() == 1);
+        REQUIRE(before.getFunctions().front().name == "f");
+        // the closure engine lowers the body and lets go of the ast.
+        REQUIRE((before.getFunctions().front().astNodes > 0) == (engine == vip::ENGINE_INTERPRETER));
+
+        runtime.execute("let more: number[] = array(10, 0);");
+        auto after = runtime.snapshotHeap();
+        REQUIRE(after.getKind(jit::consts::ID_ARRAY).count == 2);
+        REQUIRE(jit::Snapshot::diff(before, after).find("\"array\":{\"count\":1,") != std::string::npos);
+        REQUIRE(after.toJson().find("\"path\":\"big\"") != std::string::npos);
+    }
+}
+
+TEST_CASE("Host functions")
+{
+    for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+    {
+        auto runtime = vip::JustInTime(true, engine);
+
+        // the closure keeps the host state, no global is needed.
+        double total = 0;
+        runtime.registerFn("track", {{jit::consts::ID_NUMBER}}, [&total](jit::Arguments args)
+                           {
+                               total += args[0].asNumber();
+                               return jit::Value(total); });
+        runtime.registerFn("count", {{jit::consts::ID_STRING}, true}, [](jit::Arguments args)
+                           { return jit::Value::integer((int64_t)args.size()); });
+
+        auto item = jit::sharedCast<jit::Number>(runtime.execute("for i in 0..10 { track(i); } track(0.5) + count(\"a\", 1, 2);"));
+        REQUIRE(item != nullptr);
+        REQUIRE(item->getValue() == 48.5);
+        REQUIRE(total == 45.5);
+
+        REQUIRE_THROWS(runtime.execute("track();"));
+        REQUIRE_THROWS(runtime.execute("track(1, 2);"));
+        REQUIRE_THROWS(runtime.execute("track(\"x\");"));
+        REQUIRE_THROWS(runtime.execute("count();"));
+        REQUIRE(total == 45.5);
+
+        REQUIRE_THROWS(runtime.registerFn("bad", {{jit::consts::ID_INTEGER}}, [](jit::Arguments)
+                                          { return jit::Value(); }));
+    }
+}
+
+jit::Value twiceOf(double value)
+{
+    return jit::Value(value * 2);
+}
+
+TEST_CASE("Bound host functions")
+{
+    for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+    {
+        auto runtime = vip::JustInTime(true, engine);
+        int calls = 0;
+        runtime.registerFn("mul", [](double lhs, double rhs)
+                           { return lhs * rhs; });
+        runtime.registerFn("shout", [](std::string_view text)
+                           { return std::string(text) + "!"; });
+        runtime.registerFn("size", [](const jit::Array &values)
+                           { return values.size(); });
+        runtime.registerFn("bump", [&calls](int by)
+                           { calls += by; });
+        runtime.registerFn("twice", twiceOf);
+
+        auto number = jit::sharedCast<jit::Number>(runtime.execute("bump(2); bump(3); mul(1.5, 4) + size(array(7)) + twice(2);"));
+        REQUIRE(number != nullptr);
+        REQUIRE(number->getValue() == 17);
+        REQUIRE(calls == 5);
+
+        auto text = jit::sharedCast<jit::String>(runtime.execute("shout(\"hey\");"));
+        REQUIRE(text != nullptr);
+        REQUIRE(text->getValue() == "hey!");
+
+        REQUIRE_THROWS(runtime.execute("mul(\"x\", 1);"));
+        REQUIRE_THROWS(runtime.execute("size(1);"));
+        REQUIRE_THROWS(runtime.execute("shout();"));
+
+        runtime.registerFn("small", [](int32_t value)
+                           { return value; });
+        runtime.registerFn("wide", [](int64_t value)
+                           { return value - 1; });
+        runtime.registerFn("huge", []()
+                           { return ~uint64_t(0); });
+
+        auto exact = jit::sharedCast<jit::Number>(runtime.execute("small(0 - 7) + small(4.0) + wide(9007199254740993) - 9007199254740991;"));
+        REQUIRE(exact != nullptr);
+        REQUIRE(exact->getValue() == -2);
+
+        auto large = jit::sharedCast<jit::Number>(runtime.execute("huge();"));
+        REQUIRE(large != nullptr);
+        REQUIRE(large->getValue() == 18446744073709551616.0);
+
+        REQUIRE_THROWS(runtime.execute("small(1.5);"));
+        REQUIRE_THROWS(runtime.execute("small(3000000000);"));
+        REQUIRE_THROWS(runtime.execute("small(0 - 3000000000);"));
+        REQUIRE_THROWS(runtime.execute("wide(9223372036854775807 * 2);"));
+    }
+}
+
+TEST_CASE("Intrinsics")
+{
+    for (auto engine : {vip::ENGINE_INTERPRETER, vip::ENGINE_CLOSURE})
+    {
+        auto runtime = vip::JustInTime(true, engine);
+        runtime.execute("let s: string = \"hello\"; let a: number[] = [3, 1, 2];");
+
+        auto number = [&](const char *code)
+        {
+            auto item = jit::sharedCast<jit::Number>(runtime.execute(code));
+            REQUIRE(item != nullptr);
+            return item->getValue();
+        };
+        auto text = [&](const char *code)
+        {
+            auto item = jit::sharedCast<jit::String>(runtime.execute(code));
+            REQUIRE(item != nullptr);
+            return item->getValue();
+        };
+
+        REQUIRE(number("sqrt(16) + abs(0 - 2) + floor(2.5);") == 8);
+        REQUIRE(number("min(4, 2, 3) * 10 + max(4, 2, 3);") == 24);
+        REQUIRE(number("min(a) + max(a);") == 4);
+        REQUIRE(number("len(s) + len(a);") == 8);
+        REQUIRE(text("substr(s, 1, 3) + substr(s, 3) + charAt(s, 0);") == "ellloh");
+        REQUIRE(number("let t: number = 0; for i in 0..10 { t = t + floor(sqrt(i)); } t;") == 16);
+
+        // NaN wins wherever it is, for numbers and for arrays.
+        runtime.execute("let n: number = sqrt(0 - 1); let holes: number[] = [n, 1, 2, 3, 4, 5]; let tail: number[] = [1, 2, 3, 4, 5, n];");
+        for (auto &&code : {"min(n, 1);", "min(1, n);", "max(n, 1);", "max(1, n);", "min(2, 1, n);", "max(holes);", "min(holes);", "max(tail);", "min(tail);"})
+            REQUIRE(std::isnan(number(code)));
+
+        REQUIRE_THROWS(runtime.execute("substr(s, 6);"));
+        REQUIRE_THROWS(runtime.execute("substr(s, 2, 4);"));
+        REQUIRE_THROWS(runtime.execute("charAt(s, 5);"));
+        REQUIRE_THROWS(runtime.execute("sqrt(s);"));
+        REQUIRE_THROWS(runtime.execute("min(1, s);"));
+
+        // a function of the same name takes over from the intrinsic, in the program and in later ones.
+        REQUIRE(number("fn abs(n: number) { return n + 100; } abs(1);") == 101);
+        REQUIRE(number("abs(2);") == 102);
+        runtime.registerFn("sqrt", [](double value)
+                           { return value; });
+        REQUIRE(number("sqrt(9);") == 9);
+    }
+}
+
+TEST_CASE("Ahead of time")
+{
+    SUBCASE("compiled programs match the interpreter")
+    {
+        auto aot = vip::AheadOfTime("vip_test_build");
+        aot.build("fn fib(n: number) { if (n < 2) { return n; } return fib(n - 1) + fib(n - 2); } let s: string = \"fib\"; println(s, fib(20), 2 / 2);", "vip_test_build/fib");
+
+        FILE *pipe = popen("./vip_test_build/fib", "r");
+        REQUIRE(pipe != nullptr);
+
+        std::string output;
+        char buffer[64];
+        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
+            output += buffer;
+
+        REQUIRE(pclose(pipe) == 0);
+        REQUIRE(output == "fib67651\n");
+    }
+
+    SUBCASE("numbers print like the interpreter")
+    {
+        auto aot = vip::AheadOfTime("vip_test_build");
+        aot.build("println(1000000, \" \", 123456789, \" \", 0 - 4096, \" \", 7 / 2, \" \", 4294967296 * 1024, \" \", 0.1);", "vip_test_build/print");
+
+        FILE *pipe = popen("./vip_test_build/print", "r");
+        REQUIRE(pipe != nullptr);
+
+        std::string output;
+        char buffer[64];
+        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
+            output += buffer;
+
+        REQUIRE(pclose(pipe) == 0);
+        REQUIRE(output == "1000000 123456789 -4096 3.5 4398046511104 0.1\n");
+    }
+
+    SUBCASE("integers past 2^53 are not rounded")
+    {
+        const char *fns = "fn sq(a: number) { return a * a; } fn shift(a: number, b: number) { return a << b; }";
+        // what the program prints, and how the interpreter is asked for the same value.
+        const std::tuple<const char *, const char *, const char *> exact[] = {
+            {"9007199254740991", "9007199254740991", "9007199254740991"},
+            {"sq(94906265)", "9007199136250225", "9007199136250225"},
+            {"shift(1, 52) + shift(1, 52) - 1", "9007199254740991", "9007199254740991"},
+            {"0 - sq(94906265)", "-9007199136250225", "0 - 9007199136250225"},
+        };
+
+        std::string program = fns;
+        std::string expected;
+        auto interpreter = vip::JustInTime(true);
+        interpreter.execute(fns);
+        for (auto &&[code, printed, value] : exact)
+        {
+            program += std::string(" println(") + code + ");";
+            expected += std::string(printed) + "\n";
+
+            auto same = jit::sharedCast<jit::Number>(interpreter.execute(std::string(code) + " == " + value + ";"));
+            REQUIRE(same != nullptr);
+            REQUIRE(same->getValue() == 1);
+        }
+
+        auto aot = vip::AheadOfTime("vip_test_build");
+        aot.build(program, "vip_test_build/exact");
+
+        FILE *pipe = popen("./vip_test_build/exact", "r");
+        REQUIRE(pipe != nullptr);
+
+        std::string output;
+        char buffer[64];
+        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
+            output += buffer;
+
+        REQUIRE(pclose(pipe) == 0);
+        REQUIRE(output == expected);
+
+        // the interpreter prints these exactly, compiled programs refuse them instead of rounding.
+        REQUIRE_THROWS(aot.build("println(9007199254740993);", "vip_test_build/inexact"));
+        for (auto &&code : {"println(1 << 63);", "println(sq(123456789));", "let x: number = 94906267; x *= x; println(x);", "println(shift(3, 52));"})
+        {
+            aot.build(std::string(fns) + " " + code, "vip_test_build/inexact");
+            REQUIRE(std::system("./vip_test_build/inexact > /dev/null 2>&1") != 0);
+        }
+    }
+
+    SUBCASE("division by zero fails at runtime")
+    {
+        auto aot = vip::AheadOfTime("vip_test_build");
+        aot.build("fn half(a: number, b: number) { return a / b; } half(1, 0);", "vip_test_build/half");
+
+        REQUIRE(std::system("./vip_test_build/half 2> /dev/null") != 0);
+    }
+
+    SUBCASE("comparisons and short circuit")
+    {
+        auto aot = vip::AheadOfTime("vip_test_build");
+        aot.build("fn boom() { return 1 / 0; } let a: string = \"abc\"; println(0 && boom(), 1 || boom(), a < \"abd\", a == \"abc\", 1 != 1);", "vip_test_build/ops");
+
+        FILE *pipe = popen("./vip_test_build/ops", "r");
+        REQUIRE(pipe != nullptr);
+
+        std::string output;
+        char buffer[64];
+        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
+            output += buffer;
+
+        REQUIRE(pclose(pipe) == 0);
+        REQUIRE(output == "falsetruetruetruefalse\n");
+    }
+    SUBCASE("match statements")
+    {
+        auto aot = vip::AheadOfTime("vip_test_build");
+        aot.build("fn dense(x: number) { match (x) { case 0 { return 10; } case 1 { return 11; } case 2 { return 12; } else { return 99; } } }"
+                  "fn named(s: string) { match (s) { case \"get\" { return 1; } case \"put\" { return 2; } case 0.5 { return 3; } } return 0; }"
+                  "println(dense(1), dense(2.5), dense(9), named(\"put\"), named(\"p\"));",
+                  "vip_test_build/match");
+
+        FILE *pipe = popen("./vip_test_build/match", "r");
+        REQUIRE(pipe != nullptr);
+
+        std::string output;
+        char buffer[64];
+        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
+            output += buffer;
+
+        REQUIRE(pclose(pipe) == 0);
+        REQUIRE(output == "11999920\n");
+    }
+    SUBCASE("for loops")
+    {
+        auto aot = vip::AheadOfTime("vip_test_build");
+        aot.build("fn total(n: number) { let s: number = 0; for i in 0..n { for j in i..0 step 0 - 1 { s = s + j; } } return s; }"
+                  "let t: string = \"\"; for k in 0..3 { t = t + \"x\"; } println(total(4), t);",
+                  "vip_test_build/for");
+
+        FILE *pipe = popen("./vip_test_build/for", "r");
+        REQUIRE(pipe != nullptr);
+
+        std::string output;
+        char buffer[64];
+        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
+            output += buffer;
+
+        REQUIRE(pclose(pipe) == 0);
+        REQUIRE(output == "10xxx\n");
+    }
+    SUBCASE("compound assignment")
+    {
+        auto aot = vip::AheadOfTime("vip_test_build");
+        aot.build("let s: string = \"\"; let n: number = 1; for i in 0..100 { s += \"ab\"; n *= 2; n /= 2; n += 1; }"
+                  "let t: string = s; s += \"!\"; println(n, t == s, s == t + \"!\");",
+                  "vip_test_build/compound");
+
+        FILE *pipe = popen("./vip_test_build/compound", "r");
+        REQUIRE(pipe != nullptr);
+
+        std::string output;
+        char buffer[64];
+        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
+            output += buffer;
+
+        REQUIRE(pclose(pipe) == 0);
+        REQUIRE(output == "101falsetrue\n");
+    }
+    SUBCASE("remainder and bitwise operators")
+    {
+        auto aot = vip::AheadOfTime("vip_test_build");
+        aot.build("fn mix(a: number, b: number) { return a ^ b << 2 | a % b & 1; } println(mix(12, 5), 7.5 % 2);",
+                  "vip_test_build/bits");
+
+        FILE *pipe = popen("./vip_test_build/bits", "r");
+        REQUIRE(pipe != nullptr);
+
+        std::string output;
+        char buffer[64];
+        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
+            output += buffer;
+
+        REQUIRE(pclose(pipe) == 0);
+        REQUIRE(output == "241.5\n");
+    }
+    SUBCASE("locals of a caller are not compiled")
+    {
+        // the interpreter lets read see the x of its caller, compiled c would read the top level x.
+        const char *code = "let x: number = 1; fn read() { return x; } fn shadow() { let x: number = 42; return read(); }";
+        auto runtime = vip::JustInTime(true);
+        auto item = jit::sharedCast<jit::Number>(runtime.execute(std::string(code) + " shadow();"));
+        REQUIRE(item != nullptr);
+        REQUIRE(item->getValue() == 42);
+
+        auto aot = vip::AheadOfTime("vip_test_build");
+        REQUIRE_THROWS(aot.build(std::string(code) + " println(shadow());", "vip_test_build/shadow"));
+        REQUIRE_THROWS(aot.build("let x: number = 1; fn read() { return x; } fn outer(x: number) { return read(); } println(outer(42));", "vip_test_build/shadow"));
+
+        // without a caller that binds x both read the top level x.
+        aot.build("let x: number = 1; fn read() { return x; } fn other() { let y: number = 42; return read(); } println(other());", "vip_test_build/lexical");
+        FILE *pipe = popen("./vip_test_build/lexical", "r");
+        REQUIRE(pipe != nullptr);
+
+        std::string output;
+        char buffer[64];
+        while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
+            output += buffer;
+
+        REQUIRE(pclose(pipe) == 0);
+        REQUIRE(output == "1\n");
     }
 }
+#endif